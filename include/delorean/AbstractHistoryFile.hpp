@@ -62,6 +62,26 @@ protected:
     {
         enum {
             MAGIC_ALIGNED_NODE_SERDES = 0x21b4a980,
+            MAGIC_COMPACT_NODE_SERDES = 0x21b4a981,
+            MAGIC_COMPRESSED_NODE_SERDES = 0x21b4a982,
+            MAGIC_COLUMNAR_NODE_SERDES = 0x21b4a983,
+            MAGIC_ALIGNED_RELATIVE_NODE_SERDES = 0x21b4a984,
+            MAGIC_ALIGNED_WIDE_NODE_SERDES = 0x21b4a985,
+            MAGIC_ALIGNED_WIDE_RELATIVE_NODE_SERDES = 0x21b4a986,
+
+            /* Added to the magic number of a history file with extension
+             * nodes (always located by the node index), so that readers
+             * unaware of them reject it.
+             */
+            MAGIC_EXTENSION_NODES_MASK = 0x00010000,
+
+            /* Added to the magic number of a history file with a string
+             * dictionary, so that readers unaware of it reject it
+             * instead of reading dictionary IDs as variable data
+             * offsets.
+             */
+            MAGIC_STRING_DICTIONARY_MASK = 0x00020000,
+
             SIZE = 4096,
             MAJOR = 1,
             MINOR = 0
@@ -74,6 +94,54 @@ protected:
         uint32_t maxChildren;
         uint32_t nodeCount;
         node_seq_t rootNodeSeqNumber;
+
+        /* Offset of the node index (array of NodeIndexEntry, one per
+         * node, in sequence number order), or 0 if nodes are stored in
+         * fixed-size slots following the header.
+         */
+        uint64_t nodeIndexOffset = 0;
+
+        /* Offset and size of the string dictionary (NUL-terminated
+         * strings in ID order), or 0 if string intervals are not
+         * dictionary-encoded.
+         */
+        uint64_t stringDictionaryOffset = 0;
+        uint64_t stringDictionarySize = 0;
+
+        /* Offset of the node checksums (array of CRC-32C of the stored
+         * bytes of each node, in sequence number order), or 0 if nodes
+         * have no checksum.
+         */
+        uint64_t nodeChecksumsOffset = 0;
+
+        /* Offset of the node directory (array of NodeDirectoryEntry, one
+         * per node, in sequence number order), or 0 if there's none.
+         */
+        uint64_t nodeDirectoryOffset = 0;
+    };
+
+    /* Location of a node within the file when nodes are stored back to
+     * back with their serialized size. `extendedSize` is the total size
+     * of an extended node, or 0 for a node of the file's node size.
+     */
+    struct NodeIndexEntry
+    {
+        uint64_t offset;
+        uint32_t size;
+        uint32_t extendedSize = 0;
+    };
+
+    /* Summary of a node, to locate nodes without reading them. The level
+     * of the root node is 0.
+     */
+    struct NodeDirectoryEntry
+    {
+        int64_t begin;
+        int64_t end;
+        uint32_t parentSeqNumber;
+        uint32_t intervalCount;
+        uint32_t level;
+        uint32_t reserved = 0;
     };
 
 protected:
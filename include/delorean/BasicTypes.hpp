@@ -32,13 +32,13 @@ namespace delo
 typedef std::int64_t        timestamp_t;
 
 /// Interval key
-typedef std::uint32_t       interval_key_t;
+typedef std::uint64_t       interval_key_t;
 
 /// Interval type
 typedef std::uint8_t        interval_type_t;
 
-/// Interval fixed 32-bit value
-typedef std::uint32_t       interval_value_t;
+/// Interval fixed 64-bit value
+typedef std::uint64_t       interval_value_t;
 
 /// Node sequence number
 typedef std::uint32_t       node_seq_t;
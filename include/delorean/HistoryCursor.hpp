@@ -0,0 +1,170 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _HISTORYCURSOR_HPP
+#define _HISTORYCURSOR_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <delorean/HistoryFileSource.hpp>
+#include <delorean/node/Node.hpp>
+#include <delorean/interval/IntervalJar.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+// needed for cross-references
+class NodePrefetcher;
+
+/**
+ * Cursor within an history file source.
+ *
+ * A cursor is positioned at a given timestamp and keeps the current
+ * state of the history at this timestamp, that is, all intervals
+ * intersecting it, as well as the branch of nodes (from the root to a
+ * leaf) containing it.
+ *
+ * Moving a cursor only updates what changed between its previous
+ * and its new timestamp: within a node that still contains the new
+ * timestamp, only the intervals which ended or began in between are
+ * considered, and only nodes whose time ranges are crossed are read
+ * from the source. This makes scrubbing the time axis (moving the
+ * cursor forward or backward by small amounts) much cheaper than
+ * finding all intervals at each timestamp.
+ *
+ * The source must stay opened as long as the cursor is used.
+ *
+ * @see HistoryFileSource
+ * @author Philippe Proulx
+ */
+class HistoryCursor
+{
+public:
+    /**
+     * Builds a cursor within the history file source \p source. The
+     * cursor is initially not positioned; use moveTo() to position it.
+     *
+     * @param source History file source
+     */
+    HistoryCursor(HistoryFileSource& source);
+
+    /**
+     * Sets the node prefetcher used by this cursor, or \a nullptr to
+     * stop prefetching (default).
+     *
+     * With a prefetcher, each time this cursor reaches a new leaf,
+     * the branch of the next leaf in the direction of the move is
+     * prefetched: when scrubbing, it's usually cached by the time the
+     * cursor gets there. The prefetcher must outlive its use by this
+     * cursor.
+     *
+     * @param prefetcher Node prefetcher or \a nullptr
+     */
+    void setPrefetcher(NodePrefetcher* prefetcher)
+    {
+        _prefetcher = prefetcher;
+    }
+
+    /**
+     * Moves this cursor to timestamp \p ts, updating the current state.
+     *
+     * @param ts Timestamp to move to
+     * @throws ex::TimestampOutOfRange \p ts is out of the history range
+     */
+    void moveTo(timestamp_t ts);
+
+    /**
+     * Returns whether this cursor is positioned or not.
+     *
+     * @returns True if this cursor is positioned
+     */
+    bool isPositioned() const
+    {
+        return _isPositioned;
+    }
+
+    /**
+     * Returns the current timestamp of this cursor. This is only valid
+     * if this cursor is positioned.
+     *
+     * @returns Current timestamp
+     */
+    timestamp_t getTs() const
+    {
+        return _ts;
+    }
+
+    /**
+     * Returns the current state, that is, all intervals intersecting the
+     * current timestamp of this cursor.
+     *
+     * @returns Jar of intervals intersecting the current timestamp
+     */
+    const IntervalJar& getIntervals() const
+    {
+        return _intervals;
+    }
+
+private:
+    struct Level
+    {
+        // node of this level containing the current timestamp
+        Node::SP node;
+
+        // indexes of the node's intervals sorted by begin timestamp
+        std::vector<std::size_t> byBegin;
+    };
+
+private:
+    void enterNode(Node::SP node);
+    void leaveLevelsFrom(std::size_t index);
+    void moveWithinLevel(const Level& level, timestamp_t ts);
+    void addInterval(const AbstractInterval::SP& interval);
+    void removeInterval(const AbstractInterval::SP& interval);
+    void prefetchNextLeaf(bool forward);
+
+    static bool nodeContains(const Node& node, timestamp_t ts)
+    {
+        return ts >= node.getBegin() && ts < node.getEnd();
+    }
+
+private:
+    // source
+    HistoryFileSource& _source;
+
+    // current branch, from the root node to the deepest node
+    std::vector<Level> _levels;
+
+    // current state
+    IntervalJar _intervals;
+
+    // current timestamp
+    timestamp_t _ts;
+
+    // true if positioned
+    bool _isPositioned;
+
+    // node prefetcher (optional) and last prefetched timestamp
+    NodePrefetcher* _prefetcher;
+    timestamp_t _prefetchedTs;
+};
+
+}
+
+#endif // _HISTORYCURSOR_HPP
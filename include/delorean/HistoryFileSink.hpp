@@ -28,6 +28,7 @@
 #include <delorean/node/Node.hpp>
 #include <delorean/node/NodeSerDesType.hpp>
 #include <delorean/interval/AbstractInterval.hpp>
+#include <delorean/interval/StringDictionary.hpp>
 #include <delorean/BasicTypes.hpp>
 
 namespace delo
@@ -81,6 +82,80 @@ public:
               timestamp_t begin = 0,
               NodeSerDesType serdesType = NodeSerDesType::ALIGNED);
 
+    /**
+     * Enables or disables dictionary encoding of string intervals for
+     * the next history files to be opened.
+     *
+     * When enabled, the value of each added StringInterval is added to
+     * a string dictionary written to the history file on close, and the
+     * interval is stored with the string's ID as its fixed value instead
+     * of the string itself. A history file source resolves IDs back to
+     * strings shared by all its string intervals. Such a history file
+     * has a distinct magic number: readers unaware of string
+     * dictionaries reject it.
+     *
+     * @param enabled True to enable dictionary encoding
+     */
+    void setStringDictionaryEnabled(bool enabled)
+    {
+        _stringDictionaryEnabled = enabled;
+    }
+
+    /**
+     * Enables or disables extension nodes for the next history files to
+     * be opened.
+     *
+     * When enabled, an interval too large for an empty node (typically
+     * a large string) extends this node by as many node-sized extension
+     * pages as needed instead of failing, so that the node size may stay
+     * small and tuned for query I/O. Nodes are then stored back to back
+     * with their size, located by a node index written on close (like
+     * compressed nodes), so that an extended node is read at once.
+     * Such a history file has a distinct magic number: readers unaware
+     * of extension nodes reject it.
+     *
+     * When disabled, adding such an interval throws ex::NodeFull.
+     *
+     * @param enabled True to enable extension nodes
+     */
+    void setNodeExtensionEnabled(bool enabled)
+    {
+        _nodeExtensionEnabled = enabled;
+    }
+
+    /**
+     * Enables or disables node checksums for the next history files to
+     * be opened.
+     *
+     * When enabled, the CRC-32C of the stored bytes of each node is
+     * computed when the node is written, and all checksums are written
+     * to the history file on close. A history file source then verifies
+     * each node it reads from the file, throwing ex::CorruptedNode on a
+     * mismatch instead of decoding garbage.
+     *
+     * @param enabled True to enable node checksums
+     */
+    void setNodeChecksumsEnabled(bool enabled)
+    {
+        _nodeChecksumsEnabled = enabled;
+    }
+
+    /**
+     * Enables or disables the node directory for the next history files
+     * to be opened (enabled by default).
+     *
+     * When enabled, the time range, level, interval count and parent of
+     * each node are written after the nodes on close (32 bytes per
+     * node), so that a history file source may locate nodes without
+     * reading them (see HistoryFileSource::findNodesInRange()).
+     *
+     * @param enabled True to enable the node directory
+     */
+    void setNodeDirectoryEnabled(bool enabled)
+    {
+        _nodeDirectoryEnabled = enabled;
+    }
+
     /**
      * @see IHistoryFileSink::close(timestamp_t)
      */
@@ -99,7 +174,12 @@ public:
 
 private:
     void writeHeader();
+    void writeNodeIndex();
+    void writeStringDictionary();
+    void writeNodeChecksums();
+    void writeNodeDirectory();
     void tryAddIntervalToNode(AbstractInterval::SP intr, std::size_t index);
+    void extendNode(Node& node, const AbstractInterval& intr);
     void addSiblingNode(std::size_t index);
     void drawBranchFromIndex(std::size_t parentIndex,
                              std::size_t height);
@@ -113,6 +193,24 @@ private:
     std::unique_ptr<std::uint8_t[]> _nodeBuf;
     std::vector<Node::SP> _latestBranch;
     int _magic;
+    bool _nodeExtensionEnabled;
+    bool _extendNodes;
+    bool _packNodes;
+    std::vector<NodeIndexEntry> _nodeIndex;
+    std::uint64_t _nodeDataEnd;
+    std::uint64_t _nodeIndexOffset;
+    bool _stringDictionaryEnabled;
+    StringDictionary::SP _stringDictionary;
+    std::uint64_t _stringDictionaryOffset;
+    std::uint64_t _stringDictionarySize;
+    bool _nodeChecksumsEnabled;
+    bool _checksumNodes;
+    std::vector<std::uint32_t> _nodeChecksums;
+    std::uint64_t _nodeChecksumsOffset;
+    bool _nodeDirectoryEnabled;
+    bool _writeNodeDirectory;
+    std::vector<NodeDirectoryEntry> _nodeDirectory;
+    std::uint64_t _nodeDirectoryOffset;
 };
 
 }
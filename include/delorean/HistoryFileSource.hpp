@@ -19,23 +19,44 @@
 #define _HISTORYFILESOURCE_HPP
 
 #include <vector>
+#include <utility>
 #include <fstream>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <boost/filesystem/path.hpp>
 #include <boost/filesystem/fstream.hpp>
 
 #include <delorean/AbstractHistoryFile.hpp>
 #include <delorean/IHistorySource.hpp>
 #include <delorean/node/AbstractNodeCache.hpp>
+#include <delorean/node/NodeCacheType.hpp>
 #include <delorean/interval/IntervalJar.hpp>
+#include <delorean/interval/FlatIntervalJar.hpp>
 #include <delorean/interval/AbstractInterval.hpp>
+#include <delorean/interval/StringDictionary.hpp>
 #include <delorean/BasicTypes.hpp>
 
 namespace delo
 {
 
+// needed for cross-references
+class HistoryCursor;
+class HistoryReplayIterator;
+class NodePrefetcher;
+
 /**
  * History file opened for input. Use an HistoryFileSource object to read and
  * find intervals within a history file.
  *
+ * If the history file has node checksums, each node read from the file
+ * is verified before being decoded; queries throw ex::CorruptedNode when
+ * a node does not match its checksum. Cached and pinned nodes are not
+ * verified again.
+ *
  * @see HistoryFileSink
  * @author Philippe Proulx
  */
@@ -43,6 +64,47 @@ class HistoryFileSource :
     public AbstractHistoryFile,
     public IHistorySource
 {
+    friend class HistoryCursor;
+    friend class HistoryReplayIterator;
+    friend class NodePrefetcher;
+
+public:
+    /**
+     * Scan callback: called with the index of the calling worker and a
+     * scanned interval.
+     *
+     * @see scan()
+     */
+    typedef std::function<void (std::size_t,
+                                const AbstractInterval::SP&)> ScanCb;
+
+    /**
+     * Summary of a node, as found in the node directory.
+     *
+     * @see getNodeInfo()
+     */
+    struct NodeInfo
+    {
+        /// Sequence number
+        node_seq_t seqNumber;
+
+        /// Parent sequence number (Node::ROOT_PARENT_SEQ_NUMBER() for
+        /// the root node)
+        node_seq_t parentSeqNumber;
+
+        /// Begin timestamp
+        timestamp_t begin;
+
+        /// End timestamp
+        timestamp_t end;
+
+        /// Level (0 for the root node)
+        std::size_t level;
+
+        /// Number of intervals
+        std::size_t intervalCount;
+    };
+
 public:
     /**
      * Builds a history file source. The file is initially closed and needs
@@ -59,39 +121,648 @@ public:
     /**
      * Opens the history file for reading.
      *
+     * \p nodeCache may be a view of a SharedNodeCache to share a single
+     * cache between many history file sources (see
+     * SharedNodeCache::createView(const boost::filesystem::path&)).
+     *
      * @param path      Path to history file to read
      * @param nodeCache Specific node cache to use or \a nullptr for no cache
      */
     void open(const boost::filesystem::path& path,
               std::shared_ptr<AbstractNodeCache> nodeCache = nullptr);
 
+    /**
+     * Opens the history file for reading, using a new node cache of
+     * type \p nodeCacheType and of size \p nodeCacheSize.
+     *
+     * Scan-resistant caches (NodeCacheType::TWO_QUEUE and
+     * NodeCacheType::ARC) are recommended when range queries or scans
+     * run alongside interactive queries on the same source. The size of
+     * a NodeCacheType::DIRECT_MAPPED cache must be a power of two.
+     *
+     * \p byteBudget limits the memory size of cached nodes; only
+     * NodeCacheType::LRU and NodeCacheType::TWO_QUEUE caches support it.
+     *
+     * @param path          Path to history file to read
+     * @param nodeCacheType Type of node cache to use
+     * @param nodeCacheSize Size of node cache (node count)
+     * @param byteBudget    Maximum memory size of cached nodes (bytes),
+     *                      or 0 for no limit
+     * @throws std::invalid_argument Unknown node cache type, invalid
+     *                               size, or byte budget not supported
+     *                               by the node cache type
+     */
+    void open(const boost::filesystem::path& path,
+              NodeCacheType nodeCacheType, std::size_t nodeCacheSize,
+              std::size_t byteBudget = 0);
+
     /**
      * Closes the history file.
      */
     void close();
 
+    /**
+     * Sets the number of upper tree levels to pin, starting with the
+     * root level, when opening the history file. Pinned nodes are read
+     * and decoded once at open time and stay resident, outside of the
+     * node cache: queries only go through the node cache (and possibly
+     * the disk) for the levels below.
+     *
+     * Nodes are pinned level by level until \p levelCount levels are
+     * pinned or until the memory size of pinned nodes would exceed
+     * \p byteBudget, if not 0. Finding a pinned node needs no lock
+     * (pinned nodes never change while the file is opened).
+     *
+     * This only takes effect on the next open().
+     *
+     * @param levelCount Number of upper levels to pin (0 to disable)
+     * @param byteBudget Maximum memory size of pinned nodes (bytes), or
+     *                   0 for no limit
+     */
+    void setPinnedLevels(std::size_t levelCount, std::size_t byteBudget = 0)
+    {
+        _pinnedLevelCount = levelCount;
+        _pinnedByteBudget = byteBudget;
+    }
+
+    /**
+     * Returns the number of currently pinned nodes.
+     *
+     * @returns Number of pinned nodes
+     */
+    std::size_t getPinnedNodeCount() const
+    {
+        return _pinnedNodes.size();
+    }
+
+    /**
+     * Returns the memory size of currently pinned nodes.
+     *
+     * @returns Memory size of pinned nodes (bytes)
+     */
+    std::size_t getPinnedMemorySize() const
+    {
+        return _pinnedMemorySize;
+    }
+
+    /**
+     * Sets the warm-up of the node cache to start when opening the
+     * history file: the nodes of the \p levelCount upper tree levels,
+     * starting with the root level, are loaded into the node cache in
+     * the background.
+     *
+     * open() returns immediately; queries may run while the cache is
+     * being warmed up, which is done by \p workerCount worker threads,
+     * level by level, each one reading a part of a level with its own
+     * input stream in ascending sequence number order (consecutive
+     * nodes are read at once). The warm-up stops when the node cache
+     * is full (its size in nodes). Pinned nodes (see setPinnedLevels())
+     * are not put into the node cache. Read errors silently stop the
+     * warm-up.
+     *
+     * This only takes effect on the next open().
+     *
+     * @param levelCount  Number of upper levels to load (0 to disable)
+     * @param workerCount Number of worker threads
+     */
+    void setWarmUpLevels(std::size_t levelCount, std::size_t workerCount = 1)
+    {
+        _warmUpLevelCount = levelCount;
+        _warmUpBegin = 0;
+        _warmUpEnd = 0;
+        _warmUpWorkerCount = workerCount;
+    }
+
+    /**
+     * Sets the warm-up of the node cache to start when opening the
+     * history file, like setWarmUpLevels(), but loading the nodes of
+     * all levels intersecting the time range [\p begin, \p end)
+     * instead, upper levels first.
+     *
+     * This only takes effect on the next open().
+     *
+     * @param begin       Range begin timestamp
+     * @param end         Range end timestamp (excluded; \p begin to
+     *                    disable)
+     * @param workerCount Number of worker threads
+     */
+    void setWarmUpRange(timestamp_t begin, timestamp_t end,
+                        std::size_t workerCount = 1)
+    {
+        _warmUpLevelCount = end > begin ? static_cast<std::size_t>(-1) : 0;
+        _warmUpBegin = begin;
+        _warmUpEnd = end;
+        _warmUpWorkerCount = workerCount;
+    }
+
+    /**
+     * Returns the string dictionary of the opened history file, used to
+     * compare or group the values of string intervals by their ID (fixed
+     * value) instead of by string.
+     *
+     * @returns String dictionary, or \a nullptr if string intervals are
+     *          not dictionary-encoded in this history file
+     * @see HistoryFileSink::setStringDictionaryEnabled()
+     */
+    const StringDictionary* getStringDictionary() const
+    {
+        return _stringDictionary.get();
+    }
+
+    /**
+     * Returns whether or not the opened history file has a node
+     * directory, written by the sink when closing the file, which
+     * holds the time range, level, interval count and parent of each
+     * node. The node directory is read when opening the file and makes
+     * it possible to locate nodes without reading them.
+     *
+     * @returns True if the history file has a node directory
+     */
+    bool hasNodeDirectory() const
+    {
+        return !_nodeDirectory.empty();
+    }
+
+    /**
+     * Returns the number of tree levels, according to the node
+     * directory (leaf nodes are at the last level).
+     *
+     * @returns Number of levels, or 0 if there's no node directory
+     */
+    std::size_t getLevelCount() const
+    {
+        return _levelSeqs.size();
+    }
+
+    /**
+     * Gets the summary of the node with sequence number \p seqNumber
+     * from the node directory, without reading the node.
+     *
+     * @param seqNumber Sequence number of node
+     * @param info      Node summary to fill
+     * @returns         True if \p info was filled, or false if there's
+     *                  no node directory or no such node
+     */
+    bool getNodeInfo(node_seq_t seqNumber, NodeInfo& info) const;
+
+    /**
+     * Finds the nodes of level \p level intersecting the time range
+     * [\p begin, \p end), using the node directory only, with a single
+     * binary search. Their sequence numbers are appended to \p seqs in
+     * ascending time order.
+     *
+     * This may be used to plan range scans or prefetching (see
+     * NodePrefetcher::prefetchNode()) without reading tree nodes.
+     *
+     * @param begin Range begin timestamp
+     * @param end   Range end timestamp (excluded)
+     * @param level Level (0 for the root node)
+     * @param seqs  Vector to which to append sequence numbers
+     */
+    void findNodesInRange(timestamp_t begin, timestamp_t end,
+                          std::size_t level,
+                          std::vector<node_seq_t>& seqs) const;
+
+    /**
+     * Finds the leaf nodes intersecting the time range [\p begin,
+     * \p end) like findNodesInRange().
+     *
+     * @param begin Range begin timestamp
+     * @param end   Range end timestamp (excluded)
+     * @param seqs  Vector to which to append sequence numbers
+     */
+    void findLeavesInRange(timestamp_t begin, timestamp_t end,
+                           std::vector<node_seq_t>& seqs) const
+    {
+        if (!_levelSeqs.empty()) {
+            this->findNodesInRange(begin, end, _levelSeqs.size() - 1, seqs);
+        }
+    }
+
+    /**
+     * Returns whether or not the node cache is currently being warmed
+     * up.
+     *
+     * @returns True if the warm-up is still running
+     */
+    bool isWarmingUp() const
+    {
+        return _warmingUp;
+    }
+
+    /**
+     * Waits for the node cache warm-up, if any, to be done.
+     */
+    void waitForWarmUp();
+
+    /**
+     * Sets the access log sidecar file of this history file source.
+     *
+     * If \p record is true, the number of accesses to each node (node
+     * cache lookups, pinned nodes excluded) is recorded while the file
+     * is opened, and saved to \p path when closing it (see
+     * saveAccessLog()). Counts of an existing log of the same history
+     * (same node count, root node and file size) are kept, halved, so
+     * that the log follows a repetitive workload from day to day.
+     *
+     * If \p preload is true, the hottest nodes of the log at \p path,
+     * if it exists and matches the history, are loaded into the node
+     * cache in the background when opening the file, in sequence
+     * number order and up to the node cache size, after the warm-up
+     * set with setWarmUpLevels() or setWarmUpRange(), if any, and
+     * using the same number of worker threads.
+     *
+     * The log stores, after a small header, the sequence number delta
+     * and the access count of each accessed node as unsigned LEB128
+     * numbers. This only takes effect on the next open().
+     *
+     * @param path    Path to access log (empty to disable)
+     * @param record  True to record accesses
+     * @param preload True to preload hot nodes when opening
+     */
+    void setAccessLog(const boost::filesystem::path& path,
+                      bool record = true, bool preload = true)
+    {
+        _accessLogPath = path;
+        _accessLogRecording = record;
+        _accessLogPreload = preload;
+    }
+
+    /**
+     * Saves the recorded accesses to the access log now. This is done
+     * automatically when closing the file, ignoring errors.
+     *
+     * Saving again replaces what this source saved before: the log
+     * holds the halved counts of the log as it was when opening the
+     * file, plus all the accesses recorded since then.
+     *
+     * @see setAccessLog()
+     * @throws ex::IO No access log is being recorded or cannot write it
+     */
+    void saveAccessLog();
+
     /**
      * @see IHistorySource::findAll(timestamp_t, IntervalJar&)
      */
     bool findAll(timestamp_t ts, IntervalJar& intervals);
 
+    /**
+     * @see IHistorySource::findAll(timestamp_t, FlatIntervalJar&)
+     */
+    bool findAll(timestamp_t ts, FlatIntervalJar& intervals);
+
     /**
      * @see IHistorySource::findOne(timestamp_t, interval_key_t)
      */
     AbstractInterval::SP findOne(timestamp_t ts, interval_key_t key);
 
+    /**
+     * Finds all intervals in the history intersecting \p ts and calls
+     * \p visitor for each one of them.
+     *
+     * \p visitor is called as <code>bool visitor(const
+     * AbstractInterval&)</code> and must return \a true to continue
+     * or \a false to stop finding intervals. The visited interval
+     * reference is only guaranteed to be valid during the call; no
+     * interval shared pointer is copied and nothing is allocated per
+     * found interval.
+     *
+     * Intervals are visited from the root node down to the leaf
+     * containing \p ts and, within a node, in ascending order of end
+     * time.
+     *
+     * @param ts      Timestamp
+     * @param visitor Visitor to call for each found interval
+     * @returns       True if at least one interval was found
+     */
+    template<typename VisitorT>
+    bool findAll(timestamp_t ts, VisitorT visitor);
+
+    /**
+     * Finds a single interval in the history intersecting \p ts and
+     * matching key \p key, and calls \p visitor with it if found.
+     *
+     * \p visitor is called as <code>bool visitor(const
+     * AbstractInterval&)</code>; its return value is ignored.
+     *
+     * @param ts      Timestamp
+     * @param key     Key
+     * @param visitor Visitor to call with the found interval
+     * @returns       True if an interval was found
+     */
+    template<typename VisitorT>
+    bool findOne(timestamp_t ts, interval_key_t key, VisitorT visitor);
+
+    /**
+     * Finds all intervals in the history intersecting the time range
+     * [\p begin, \p end) and calls \p visitor for each one of them.
+     * \p begin must be within the history range and \p end must be
+     * greater than \p begin and less than or equal to the history end.
+     *
+     * \p visitor is called exactly like in findAll(timestamp_t,
+     * VisitorT). Intervals are visited depth-first, parents before
+     * children and, within a node, in ascending order of end time.
+     * Many intervals having the same key may be visited.
+     *
+     * @param begin   Range begin timestamp
+     * @param end     Range end timestamp (excluded)
+     * @param visitor Visitor to call for each found interval
+     * @returns       True if at least one interval was found
+     */
+    template<typename VisitorT>
+    bool findAllInRange(timestamp_t begin, timestamp_t end,
+                        VisitorT visitor);
+
+    /**
+     * Scans the whole history, calling \p cb once for each interval it
+     * contains.
+     *
+     * Nodes are read in on-disk order (sequence number order), in
+     * chunks of about \p chunkSize bytes (at least one node), using a
+     * dedicated input stream. Chunks are decoded by \p workerCount
+     * worker threads which call \p cb with their index (0 to
+     * \p workerCount - 1) and the intervals of the nodes they decode.
+     * This is much faster than querying the history when all of its
+     * intervals are needed.
+     *
+     * Ordering guarantees:
+     *
+     *   * Each worker decodes whole chunks in on-disk order (ascending
+     *     sequence number order, except for compressed or extended
+     *     nodes which are stored in commit order), and calls \p cb for
+     *     the intervals of a node in ascending order of end time.
+     *   * Calls from different workers are not ordered in any way and
+     *     happen concurrently: \p cb must be thread-safe, typically by
+     *     only touching per-worker state selected with the worker index.
+     *   * With a single worker, all intervals are thus delivered in
+     *     on-disk order.
+     *
+     * If \p cb throws, the scan stops as soon as possible and the first
+     * exception is rethrown by this method once all workers are done.
+     * The history file source may not be queried by \p cb.
+     *
+     * If the history file has node checksums (see
+     * HistoryFileSink::setNodeChecksumsEnabled()), each node is
+     * verified before being decoded.
+     *
+     * @param cb          Callback to call for each interval
+     * @param workerCount Number of worker threads decoding nodes
+     * @param chunkSize   Approximate size of a read chunk (bytes)
+     * @throws ex::IO     History file is closed or cannot be read
+     * @throws ex::CorruptedNode A node does not match its checksum
+     */
+    void scan(const ScanCb& cb, std::size_t workerCount = 1,
+              std::size_t chunkSize = 1 << 20);
+
+protected:
+    typedef std::pair<node_seq_t, Node::SP> PinnedNode;
+    typedef std::function<void (std::size_t, const Node&)> WarmUpNodeCb;
+
+    struct AccessLogHeader
+    {
+        enum {
+            MAGIC = 0x4c41444c,
+            MAJOR = 2,
+            MINOR = 0
+        };
+
+        std::uint32_t magic;
+        std::uint16_t major = MAJOR;
+        std::uint16_t minor = MINOR;
+        std::uint32_t nodeCount;
+        std::uint32_t entryCount;
+
+        // identity of the history, with nodeCount
+        std::uint32_t rootNodeSeqNumber;
+        std::uint32_t reserved = 0;
+        std::uint64_t fileSize;
+    };
+
 protected:
     void readHeader();
+    void readNodeIndex(std::uint64_t offset);
+    void readStringDictionary(std::uint64_t offset, std::uint64_t size);
+    void readNodeChecksums(std::uint64_t offset);
+    void readNodeDirectory(std::uint64_t offset);
+    NodeIndexEntry getNodeLocation(node_seq_t seqNumber) const;
+    std::size_t getExtendedNodeSize(const NodeIndexEntry& location) const;
+    void getNodeSeqsInFileOrder(std::vector<node_seq_t>& seqs) const;
+    void verifyNode(node_seq_t seqNumber, const std::uint8_t* buf,
+                    std::size_t size) const;
+    void pinUpperLevels();
+    void runWarmUp(std::size_t levelCount, timestamp_t begin, timestamp_t end,
+                   std::size_t workerCount, bool preload);
+    std::size_t warmUp(std::size_t levelCount, timestamp_t begin,
+                       timestamp_t end, std::size_t workerCount);
+    void warmUpNodes(const std::vector<node_seq_t>& seqs,
+                     std::size_t workerCount, const WarmUpNodeCb& nodeCb);
+    void preloadFromAccessLog(std::size_t maxNodeCount,
+                              std::size_t workerCount);
+    bool readAccessLog(std::vector<std::uint32_t>& counts);
+    void stopWarmUp();
+    Node::SP findPinnedNode(node_seq_t seqNumber) const;
+    Node::SP readNode(std::istream& input, std::vector<std::uint8_t>& buf,
+                      node_seq_t seqNumber);
+    Node::SP getNodeIfCached(node_seq_t seqNumber);
+    void putNodeIntoCache(node_seq_t seqNumber, Node::SP node);
+    void validateQuery(timestamp_t ts) const;
+    void validateRangeQuery(timestamp_t begin, timestamp_t end) const;
     Node::SP getNode(node_seq_t seqNumber);
-    Node::SP getNodeFromCache(node_seq_t seqNumber);
+    Node::SP loadNode(node_seq_t seqNumber);
+    Node::SP getNodeFromCache(node_seq_t seqNumber,
+                              std::size_t level = AbstractNodeCache::NO_LEVEL);
     Node::SP getRootNode();
+    Node::SP getChildNodeAtTs(const Node& node, timestamp_t ts,
+                              std::size_t level = AbstractNodeCache::NO_LEVEL);
+
+    template<typename NodeVisitorT>
+    void visitBranchAtTs(timestamp_t ts, NodeVisitorT nodeVisitor);
+
+    template<typename VisitorT>
+    bool visitSubtreeInRange(const Node::SP& node, std::size_t level,
+                             timestamp_t begin, timestamp_t end,
+                             VisitorT& visitor);
 
 private:
     boost::filesystem::ifstream _inputStream;
     std::unique_ptr<uint8_t[]> _nodeBuf;
     std::shared_ptr<AbstractNodeCache> _nodeCache;
+
+    // node locations, if not stored in fixed-size slots
+    std::vector<NodeIndexEntry> _nodeIndex;
+
+    // string dictionary, if string intervals are dictionary-encoded
+    StringDictionary::SP _stringDictionary;
+
+    // checksum of each node, if nodes have checksums
+    std::vector<std::uint32_t> _nodeChecksums;
+
+    // node directory, if any, and node sequence numbers of each level
+    // in ascending time order
+    std::vector<NodeDirectoryEntry> _nodeDirectory;
+    std::vector<std::vector<node_seq_t>> _levelSeqs;
+
+    // pinned upper levels parameters
+    std::size_t _pinnedLevelCount;
+    std::size_t _pinnedByteBudget;
+
+    // pinned nodes, sorted by sequence number, and their memory size
+    std::vector<PinnedNode> _pinnedNodes;
+    std::size_t _pinnedMemorySize;
+
+    // warm-up parameters (no range when end <= begin)
+    std::size_t _warmUpLevelCount;
+    timestamp_t _warmUpBegin;
+    timestamp_t _warmUpEnd;
+    std::size_t _warmUpWorkerCount;
+
+    // warm-up thread and its state
+    std::thread _warmUpThread;
+    std::atomic<bool> _warmingUp;
+    std::atomic<bool> _warmUpStopped;
+
+    // protects the node cache while it's being warmed up
+    std::mutex _nodeCacheMutex;
+
+    // access log parameters
+    boost::filesystem::path _accessLogPath;
+    bool _accessLogRecording;
+    bool _accessLogPreload;
+
+    // size of the opened history file
+    std::uint64_t _fileSize;
+
+    // access count of each node, if recording (protected by
+    // _nodeCacheMutex), and halved counts of the access log when opening
+    std::vector<std::uint32_t> _accessCounts;
+    std::vector<std::uint32_t> _accessLogBaseCounts;
 };
 
+template<typename NodeVisitorT>
+void HistoryFileSource::visitBranchAtTs(timestamp_t ts,
+                                        NodeVisitorT nodeVisitor)
+{
+    // current node: root node
+    auto currentNode = this->getRootNode();
+    std::size_t level = 0;
+
+    // climb tree until the visitor is satisfied or there's no child
+    while (currentNode) {
+        if (!nodeVisitor(*currentNode)) {
+            break;
+        }
+
+        level++;
+        currentNode = this->getChildNodeAtTs(*currentNode, ts, level);
+    }
+}
+
+template<typename VisitorT>
+bool HistoryFileSource::visitSubtreeInRange(const Node::SP& node,
+                                            std::size_t level,
+                                            timestamp_t begin,
+                                            timestamp_t end,
+                                            VisitorT& visitor)
+{
+    if (!node->visitRange(begin, end, visitor)) {
+        return false;
+    }
+
+    const auto& children = node->getChildren();
+
+    for (auto it = children.begin(); it != children.end(); ++it) {
+        // a child ends where its next sibling begins (or with its parent)
+        auto childEnd = node->getEnd();
+        if (it + 1 != children.end()) {
+            childEnd = (it + 1)->getBegin();
+        }
+
+        if (childEnd <= begin) {
+            continue;
+        }
+        if (it->getBegin() >= end) {
+            break;
+        }
+
+        auto child = this->getNodeFromCache(it->getSeqNumber(), level + 1);
+        if (!child) {
+            // weird, but possible
+            continue;
+        }
+
+        if (!this->visitSubtreeInRange(child, level + 1, begin, end,
+                                       visitor)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template<typename VisitorT>
+bool HistoryFileSource::findAll(timestamp_t ts, VisitorT visitor)
+{
+    this->validateQuery(ts);
+
+    auto found = false;
+    auto foundVisitor = [&found, &visitor] (const AbstractInterval& interval) {
+        found = true;
+
+        return static_cast<bool>(visitor(interval));
+    };
+
+    this->visitBranchAtTs(ts, [ts, &foundVisitor] (const Node& node) {
+        return node.visitAll(ts, foundVisitor);
+    });
+
+    return found;
+}
+
+template<typename VisitorT>
+bool HistoryFileSource::findOne(timestamp_t ts, interval_key_t key,
+                                VisitorT visitor)
+{
+    this->validateQuery(ts);
+
+    auto found = false;
+    auto keyVisitor = [key, &found, &visitor] (const AbstractInterval& interval) {
+        if (interval.getKey() != key) {
+            return true;
+        }
+
+        // two intervals having the same key cannot overlap: stop here
+        found = true;
+        visitor(interval);
+
+        return false;
+    };
+
+    this->visitBranchAtTs(ts, [ts, &keyVisitor] (const Node& node) {
+        return node.visitAll(ts, keyVisitor);
+    });
+
+    return found;
+}
+
+template<typename VisitorT>
+bool HistoryFileSource::findAllInRange(timestamp_t begin, timestamp_t end,
+                                       VisitorT visitor)
+{
+    this->validateRangeQuery(begin, end);
+
+    auto found = false;
+    auto foundVisitor = [&found, &visitor] (const AbstractInterval& interval) {
+        found = true;
+
+        return static_cast<bool>(visitor(interval));
+    };
+
+    this->visitSubtreeInRange(this->getRootNode(), 0, begin, end,
+                              foundVisitor);
+
+    return found;
+}
+
 }
 
 #endif // _HISTORYFILESOURCE_HPP
@@ -0,0 +1,130 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _HISTORYREPLAYITERATOR_HPP
+#define _HISTORYREPLAYITERATOR_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <delorean/HistoryFileSource.hpp>
+#include <delorean/node/Node.hpp>
+#include <delorean/interval/AbstractInterval.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+/**
+ * Replay iterator over an history file source.
+ *
+ * A replay iterator produces, one at a time, all intervals of which the
+ * end timestamp is within a given time window [\a begin, \a end), in
+ * ascending order of end timestamp. This is the order in which state
+ * changes happen, which makes it suitable for replaying a history or
+ * computing differences between two points in time.
+ *
+ * All nodes at a given level of the tree have disjoint time ranges and
+ * their intervals are sorted by end timestamp, so the intervals of a
+ * whole level, node after node, form an end-ordered stream. The
+ * iterator keeps one such stream per level and merges them. Only the
+ * current node of each level (and its ancestors) is kept in memory, so
+ * memory usage is bounded by the tree height, whatever the size of the
+ * window.
+ *
+ * Intervals having the same end timestamp are produced from the root
+ * level down to the leaf level. The source must stay opened as long as
+ * the iterator is used.
+ *
+ * @see HistoryFileSource
+ * @author Philippe Proulx
+ */
+class HistoryReplayIterator
+{
+public:
+    /**
+     * Builds a replay iterator producing the intervals of \p source
+     * ending within [\p begin, \p end).
+     *
+     * @param source History file source
+     * @param begin  Window begin timestamp
+     * @param end    Window end timestamp (excluded)
+     * @throws ex::TimestampOutOfRange \p begin is out of the history
+     *                                 range or \p end is not greater
+     *                                 than \p begin
+     */
+    HistoryReplayIterator(HistoryFileSource& source, timestamp_t begin,
+                          timestamp_t end);
+
+    /**
+     * Returns the next interval, or \a nullptr if there's no more
+     * interval ending within the window.
+     *
+     * @returns Next interval or \a nullptr if done
+     */
+    AbstractInterval::SP next();
+
+private:
+    struct Frame
+    {
+        // node
+        Node::SP node;
+
+        // index of the next child to visit
+        std::size_t nextChild;
+    };
+
+    struct LevelStream
+    {
+        // depth-first path from the root to the current node
+        std::vector<Frame> path;
+
+        // current node of this level (`nullptr` if exhausted)
+        Node::SP node;
+
+        // index of the current interval within the current node
+        std::size_t intervalIndex;
+    };
+
+private:
+    void nextNode(LevelStream& stream, std::size_t depth);
+    std::size_t getFirstChildIndex(const Node& node) const;
+
+    static timestamp_t getChildEnd(const Node& node, std::size_t index)
+    {
+        if (index + 1 < node.getChildrenCount()) {
+            return node.getChildBeginAtIndex(index + 1);
+        }
+
+        return node.getEnd();
+    }
+
+private:
+    // source
+    HistoryFileSource& _source;
+
+    // window
+    timestamp_t _begin;
+    timestamp_t _end;
+
+    // one stream per level, from the root level
+    std::vector<LevelStream> _levels;
+};
+
+}
+
+#endif // _HISTORYREPLAYITERATOR_HPP
@@ -22,6 +22,7 @@
 
 #include <delorean/AbstractHistory.hpp>
 #include <delorean/interval/IntervalJar.hpp>
+#include <delorean/interval/FlatIntervalJar.hpp>
 #include <delorean/interval/AbstractInterval.hpp>
 #include <delorean/BasicTypes.hpp>
 
@@ -49,6 +50,20 @@ public:
      */
     virtual bool findAll(timestamp_t ts, IntervalJar& intervals) = 0;
 
+    /**
+     * Finds all intervals in the history intersecting \p ts and adds them
+     * to the flat jar \p intervals, which is kept sorted by key.
+     *
+     * Clearing and reusing the same flat jar for many queries avoids
+     * allocating anything once the jar is large enough.
+     *
+     * @param ts        Timestamp
+     * @param intervals Flat jar of intervals in which to add matching
+     *                  intervals
+     * @returns         True if at least one interval was found
+     */
+    virtual bool findAll(timestamp_t ts, FlatIntervalJar& intervals) = 0;
+
     /**
      * Finds a single interval in the history intersecting \p ts and matching
      * key \p key.
@@ -0,0 +1,168 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _NODEPREFETCHER_HPP
+#define _NODEPREFETCHER_HPP
+
+#include <cstddef>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <boost/filesystem/fstream.hpp>
+
+#include <delorean/HistoryFileSource.hpp>
+#include <delorean/node/Node.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+/**
+ * Asynchronous node prefetcher of an history file source.
+ *
+ * A query is a chain of dependent node reads: a child can only be read
+ * once its parent is known. When the timestamps of upcoming queries are
+ * known ahead of time (batched timestamps, scrubbing cursor), a node
+ * prefetcher may read the nodes they will need in the background and
+ * put them into the source's node cache, hiding the cold path latency
+ * behind the computation of the current query.
+ *
+ * Prefetch requests are served in order by worker threads, each one
+ * reading nodes with its own input stream. Nodes already cached or
+ * pinned are not read again. Prefetching is only a hint: requests out
+ * of the history range and read errors are silently ignored.
+ *
+ * The source must stay opened as long as the prefetcher exists.
+ *
+ * @see HistoryFileSource
+ * @see HistoryCursor::setPrefetcher()
+ * @author Philippe Proulx
+ */
+class NodePrefetcher
+{
+public:
+    /**
+     * Builds a node prefetcher for the history file source \p source.
+     *
+     * @param source      History file source (opened)
+     * @param workerCount Number of worker threads
+     */
+    NodePrefetcher(HistoryFileSource& source, std::size_t workerCount = 1);
+
+    /**
+     * Cancels the pending requests and waits for the workers.
+     */
+    ~NodePrefetcher();
+
+    /**
+     * Requests the node with sequence number \p seqNumber to be
+     * prefetched.
+     *
+     * @param seqNumber Sequence number of node to prefetch
+     */
+    void prefetchNode(node_seq_t seqNumber);
+
+    /**
+     * Requests the branch of nodes containing \p ts, from the root node
+     * to a leaf, to be prefetched.
+     *
+     * @param ts Timestamp
+     */
+    void prefetchBranch(timestamp_t ts);
+
+    /**
+     * Requests the branches of nodes containing the timestamps \p tss
+     * to be prefetched, in this order.
+     *
+     * @param tss Timestamps
+     */
+    void prefetchBranches(const std::vector<timestamp_t>& tss);
+
+    /**
+     * Drops the pending requests (requests being served are completed).
+     */
+    void cancel();
+
+    /**
+     * Waits for all the pending requests to be served.
+     */
+    void wait();
+
+    /**
+     * Returns the number of nodes read by this prefetcher so far.
+     *
+     * @returns Number of read nodes
+     */
+    std::size_t getReadNodeCount() const
+    {
+        return _readNodeCount;
+    }
+
+private:
+    struct Request
+    {
+        // branch request (timestamp) or single node request
+        bool isBranch;
+        timestamp_t ts;
+        node_seq_t seqNumber;
+    };
+
+    struct Worker
+    {
+        // dedicated input stream
+        boost::filesystem::ifstream input;
+
+        // node read buffer
+        std::vector<std::uint8_t> buf;
+
+        // last prefetched branch, from the root node
+        std::vector<Node::SP> branch;
+    };
+
+private:
+    void addRequest(const Request& request);
+    void work();
+    void serve(Worker& worker, const Request& request);
+    Node::SP loadNode(Worker& worker, node_seq_t seqNumber);
+
+private:
+    // source
+    HistoryFileSource& _source;
+
+    // pending requests
+    std::deque<Request> _requests;
+
+    // number of requests being served
+    std::size_t _busyCount;
+
+    // true to stop the workers
+    bool _stopped;
+
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    std::vector<std::thread> _workers;
+
+    // number of nodes read
+    std::atomic<std::size_t> _readNodeCount;
+};
+
+}
+
+#endif // _NODEPREFETCHER_HPP
@@ -0,0 +1,50 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _CORRUPTEDNODE_HPP
+#define _CORRUPTEDNODE_HPP
+
+#include <delorean/ex/IO.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+namespace ex
+{
+
+class CorruptedNode :
+    public IO
+{
+public:
+    CorruptedNode(node_seq_t seqNumber) :
+        IO {"history file node checksum mismatch"},
+        _seqNumber {seqNumber}
+    {
+    }
+
+    node_seq_t getSeqNumber() const {
+        return _seqNumber;
+    }
+
+private:
+    node_seq_t _seqNumber;
+};
+
+}
+}
+
+#endif // _CORRUPTEDNODE_HPP
@@ -103,21 +103,36 @@ public:
     void deserializeVariableData(const std::uint8_t* varAtPtr);
 
     /**
-     * Sets the fixed 32-bit value of this interval. Please note it's useless
+     * Sets the fixed 64-bit value of this interval. Please note it's useless
      * to call this method if the interval has to contain any variable data.
      *
-     * @param fixedValue Fixed 32-bit value to set
+     * Node ser/des store small values (sign-extended from 32 bits)
+     * more compactly.
+     *
+     * @param fixedValue Fixed 64-bit value to set
      */
     void setFixedValue(interval_value_t fixedValue);
 
     /**
-     * Returns the fixed 32-bit value of this interval. Please note this
+     * Returns the fixed 64-bit value of this interval. Please note this
      * value is meaningless if the interval contains any variable data.
      *
-     * @returns Fixed 32-bit value of this interval
+     * @returns Fixed 64-bit value of this interval
      */
     interval_value_t getFixedValue() const;
 
+    /**
+     * Returns the approximate size of the memory used by this interval
+     * object in bytes, including any data it owns on the heap (but not
+     * the shared pointer control block).
+     *
+     * @returns Approximate memory size in bytes
+     */
+    std::size_t getMemorySize() const
+    {
+        return this->getMemorySizeImpl();
+    }
+
     /**
      * Returns whether timestamp \p ts intersects with this interval or not.
      *
@@ -180,6 +195,14 @@ public:
     }
 
 protected:
+    /**
+     * Virtual implementation of getMemorySize(). The default
+     * implementation returns the size of an abstract interval plus the
+     * size of the variable data; a child class should override it when
+     * it has more members or owns more memory.
+     */
+    virtual std::size_t getMemorySizeImpl() const;
+
     /**
      * Virtual implementation of getVariableDataSize(); must be implemented by
      * child class.
@@ -203,14 +226,14 @@ private:
     timestamp_t _begin;
     timestamp_t _end;
 
-    // type
-    interval_type_t _type;
-
     // key
     interval_key_t _key;
 
-    // 32-bit value
+    // 64-bit value
     interval_value_t _fixedValue;
+
+    // type (last to avoid padding)
+    interval_type_t _type;
 };
 
 }
@@ -0,0 +1,92 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _DICTIONARYSTRINGINTERVAL_HPP
+#define _DICTIONARYSTRINGINTERVAL_HPP
+
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+#include <delorean/interval/StringInterval.hpp>
+#include <delorean/interval/StringDictionary.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+/**
+ * Dictionary-encoded string interval. It has no variable data: its fixed
+ * value is the ID of its string within a string dictionary, and its
+ * value refers to the dictionary's string instead of being a copy.
+ * Comparing or grouping the values of intervals sharing a dictionary may
+ * then be done with getFixedValue().
+ *
+ * Setting the value of such an interval adds it to its dictionary.
+ *
+ * @author Philippe Proulx
+ */
+class DictionaryStringInterval :
+    public StringInterval
+{
+public:
+    typedef std::shared_ptr<DictionaryStringInterval> SP;
+    typedef std::unique_ptr<DictionaryStringInterval> UP;
+
+public:
+    /**
+     * Builds a dictionary-encoded string interval.
+     *
+     * @param begin      Begin timestamp
+     * @param end        End timestamp (excluded)
+     * @param key        Key
+     * @param dictionary String dictionary
+     */
+    DictionaryStringInterval(timestamp_t begin, timestamp_t end,
+                             interval_key_t key,
+                             StringDictionary::SP dictionary);
+
+    virtual ~DictionaryStringInterval()
+    {
+    }
+
+    /**
+     * Returns the string dictionary of this interval.
+     *
+     * @returns String dictionary
+     */
+    const StringDictionary* getDictionary() const
+    {
+        return _dictionary.get();
+    }
+
+protected:
+    void setValueImpl(const std::string& value);
+    const std::string& getValueImpl() const;
+    std::size_t getMemorySizeImpl() const;
+    std::size_t getVariableDataSizeImpl() const;
+    void serializeVariableDataImpl(std::uint8_t* varAtPtr) const;
+    void deserializeVariableDataImpl(const std::uint8_t* varAtPtr);
+
+private:
+    StringDictionary::SP _dictionary;
+    const std::string* _value;
+};
+
+}
+
+#endif // _DICTIONARYSTRINGINTERVAL_HPP
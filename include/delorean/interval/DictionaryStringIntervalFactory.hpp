@@ -0,0 +1,66 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _DICTIONARYSTRINGINTERVALFACTORY_HPP
+#define _DICTIONARYSTRINGINTERVALFACTORY_HPP
+
+#include <cstdint>
+
+#include <delorean/interval/AbstractInterval.hpp>
+#include <delorean/interval/IIntervalFactory.hpp>
+#include <delorean/interval/DictionaryStringInterval.hpp>
+#include <delorean/interval/StringDictionary.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+/**
+ * Factory of dictionary-encoded string intervals, all sharing the same
+ * string dictionary.
+ *
+ * @author Philippe Proulx
+ */
+class DictionaryStringIntervalFactory :
+    public IIntervalFactory
+{
+public:
+    /**
+     * Builds a dictionary-encoded string interval factory.
+     *
+     * @param dictionary String dictionary of created intervals
+     */
+    explicit DictionaryStringIntervalFactory(StringDictionary::SP dictionary) :
+        _dictionary {dictionary}
+    {
+    }
+
+    AbstractInterval::UP create(timestamp_t begin, timestamp_t end,
+                                interval_key_t key) const
+    {
+        return AbstractInterval::UP {
+            new DictionaryStringInterval {begin, end, key, _dictionary}
+        };
+    }
+
+private:
+    StringDictionary::SP _dictionary;
+};
+
+}
+
+#endif // _DICTIONARYSTRINGINTERVALFACTORY_HPP
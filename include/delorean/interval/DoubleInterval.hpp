@@ -0,0 +1,48 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _DOUBLEINTERVAL_HPP
+#define _DOUBLEINTERVAL_HPP
+
+#include <cstdint>
+
+#include <delorean/interval/Simple64BitValueInterval.hpp>
+#include <delorean/interval/StandardIntervalType.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+/**
+ * Interval containing a single 64-bit floating point value.
+ *
+ * @author Philippe Proulx
+ */
+class DoubleInterval :
+    public Simple64BitValueInterval<double, StandardIntervalType::FLOAT64>
+{
+public:
+    typedef std::shared_ptr<DoubleInterval> SP;
+    typedef std::unique_ptr<DoubleInterval> UP;
+
+public:
+    using Simple64BitValueInterval::Simple64BitValueInterval;
+};
+
+}
+
+#endif // _DOUBLEINTERVAL_HPP
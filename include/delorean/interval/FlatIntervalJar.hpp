@@ -0,0 +1,189 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _FLATINTERVALJAR_HPP
+#define _FLATINTERVALJAR_HPP
+
+#include <cstddef>
+#include <vector>
+#include <utility>
+
+#include <delorean/interval/AbstractInterval.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+/**
+ * Flat container for multiple intervals.
+ *
+ * This jar may be used instead of an IntervalJar when finding all
+ * intervals intersecting with a given timestamp. It's a vector of
+ * (interval key, interval) pairs sorted by key, so iterating it is
+ * similar to iterating an IntervalJar.
+ *
+ * Contrary to an IntervalJar, clearing a flat jar keeps its capacity,
+ * so that repeatedly clearing and filling the same flat jar with
+ * queries does not allocate anything once it's large enough.
+ *
+ * @author Philippe Proulx
+ */
+class FlatIntervalJar
+{
+public:
+    /// Entry: (interval key, interval) pair
+    typedef std::pair<interval_key_t, AbstractInterval::SP> Entry;
+
+    /// Constant iterator of entries
+    typedef std::vector<Entry>::const_iterator const_iterator;
+
+public:
+    /**
+     * Builds an empty flat interval jar.
+     */
+    FlatIntervalJar();
+
+    /**
+     * Reserves room for at least \p capacity intervals.
+     *
+     * @param capacity Number of intervals to reserve room for
+     */
+    void reserve(std::size_t capacity)
+    {
+        _entries.reserve(capacity);
+    }
+
+    /**
+     * Removes all the intervals of this jar, keeping its capacity.
+     */
+    void clear()
+    {
+        _entries.clear();
+    }
+
+    /**
+     * Returns the number of intervals in this jar.
+     *
+     * @returns Number of intervals
+     */
+    std::size_t size() const
+    {
+        return _entries.size();
+    }
+
+    /**
+     * Returns whether this jar is empty or not.
+     *
+     * @returns True if this jar is empty
+     */
+    bool empty() const
+    {
+        return _entries.empty();
+    }
+
+    /**
+     * Returns the number of intervals this jar may contain without
+     * allocating.
+     *
+     * @returns Capacity of this jar
+     */
+    std::size_t capacity() const
+    {
+        return _entries.capacity();
+    }
+
+    /**
+     * Returns a constant iterator to the first entry of this jar (the
+     * one with the lowest key).
+     *
+     * @returns Constant iterator to first entry
+     */
+    const_iterator begin() const
+    {
+        return _entries.begin();
+    }
+
+    /**
+     * Returns a constant iterator past the last entry of this jar.
+     *
+     * @returns Constant iterator past last entry
+     */
+    const_iterator end() const
+    {
+        return _entries.end();
+    }
+
+    /**
+     * Finds the entry having key \p key.
+     *
+     * @param key Key of entry to find
+     * @returns   Constant iterator to found entry or end() if not found
+     */
+    const_iterator find(interval_key_t key) const;
+
+    /**
+     * Returns the interval having key \p key.
+     *
+     * @param key Key of interval to get
+     * @returns   Interval having key \p key
+     * @throws std::out_of_range No interval has key \p key
+     */
+    const AbstractInterval::SP& at(interval_key_t key) const;
+
+    /**
+     * Inserts interval \p interval, keeping this jar sorted. Nothing is
+     * inserted if this jar already contains an interval having the same
+     * key.
+     *
+     * @param interval Interval to insert
+     * @returns        True if the interval was inserted
+     */
+    bool insert(const AbstractInterval::SP& interval);
+
+    /**
+     * Appends interval \p interval at the end of this jar without
+     * keeping it sorted. normalize() must be called once done
+     * appending intervals.
+     *
+     * @param interval Interval to append
+     */
+    void append(const AbstractInterval::SP& interval)
+    {
+        _entries.push_back(std::make_pair(interval->getKey(), interval));
+    }
+
+    /**
+     * Sorts the intervals appended with append() from index \p from and
+     * merges them with the already sorted ones. Appended intervals
+     * having a key already existing in the first \p from ones are
+     * dropped.
+     *
+     * This only allocates a temporary merge buffer when \p from is not
+     * 0, that is, when appending to a jar which wasn't cleared.
+     *
+     * @param from Index of the first appended interval
+     */
+    void normalize(std::size_t from);
+
+private:
+    // entries sorted by key
+    std::vector<Entry> _entries;
+};
+
+}
+
+#endif // _FLATINTERVALJAR_HPP
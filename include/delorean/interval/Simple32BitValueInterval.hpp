@@ -50,12 +50,14 @@ public:
 
     void setValue(const T value)
     {
-        this->setFixedValue(static_cast<interval_value_t>(value));
+        // sign-extend so that any 32-bit value is small
+        auto value32 = static_cast<std::int32_t>(static_cast<std::uint32_t>(value));
+        this->setFixedValue(static_cast<interval_value_t>(value32));
     }
 
     T getValue() const
     {
-        return static_cast<T>(this->getFixedValue());
+        return static_cast<T>(static_cast<std::uint32_t>(this->getFixedValue()));
     }
 
 protected:
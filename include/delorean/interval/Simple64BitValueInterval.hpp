@@ -32,7 +32,8 @@ namespace delo
 
 /**
  * Template class for creating an interval class with a simple 64-bit type
- * for its value.
+ * for its value. The value is stored inline, as the bits of the fixed
+ * value, so that such intervals have no variable data.
  *
  * @author Philippe Proulx
  */
@@ -50,21 +51,25 @@ public:
 
     void setValue(const T value)
     {
-        _value = static_cast<decltype(_value)>(value);
+        // bitwise copy: T may be a floating point type
+        interval_value_t fixedValue;
+        std::memcpy(&fixedValue, &value, sizeof(fixedValue));
+        this->setFixedValue(fixedValue);
     }
 
     T getValue() const
     {
-        return static_cast<T>(_value);
+        T value;
+        auto fixedValue = this->getFixedValue();
+        std::memcpy(&value, &fixedValue, sizeof(value));
+
+        return value;
     }
 
 protected:
     std::size_t getVariableDataSizeImpl() const;
     void serializeVariableDataImpl(std::uint8_t* varAtPtr) const;
     void deserializeVariableDataImpl(const std::uint8_t* varAtPtr);
-
-private:
-    std::uint64_t _value;
 };
 
 template<typename T, StandardIntervalType SIT>
@@ -78,24 +83,27 @@ Simple64BitValueInterval<T, SIT>::Simple64BitValueInterval(timestamp_t begin,
         SIT
     }
 {
+    static_assert(sizeof(T) == sizeof(interval_value_t),
+                  "Value type must be as large as a fixed value");
 }
 
 template<typename T, StandardIntervalType SIT>
 std::size_t Simple64BitValueInterval<T, SIT>::getVariableDataSizeImpl() const
 {
-    return sizeof(_value);
+    // value is inline, in the fixed value
+    return 0;
 }
 
 template<typename T, StandardIntervalType SIT>
 void Simple64BitValueInterval<T, SIT>::serializeVariableDataImpl(std::uint8_t* varAtPtr) const
 {
-    std::memcpy(varAtPtr, &_value, sizeof(_value));
+    // no variable data
 }
 
 template<typename T, StandardIntervalType SIT>
 void Simple64BitValueInterval<T, SIT>::deserializeVariableDataImpl(const std::uint8_t* varAtPtr)
 {
-    std::memcpy(&_value, varAtPtr, sizeof(_value));
+    // no variable data
 }
 
 }
@@ -37,6 +37,7 @@ enum class StandardIntervalType : interval_type_t
     NUL,
     INT64,
     UINT64,
+    FLOAT64,
     COUNT       // number of items above; always last
 };
 
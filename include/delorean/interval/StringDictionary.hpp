@@ -0,0 +1,115 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _STRINGDICTIONARY_HPP
+#define _STRINGDICTIONARY_HPP
+
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+/**
+ * Dictionary of strings, each one associated with a numeric ID.
+ *
+ * IDs are assigned in insertion order, starting at 0. References to
+ * strings of a dictionary remain valid as long as the dictionary
+ * exists, so that dictionary-encoded string intervals (see
+ * StringInterval) share them instead of owning copies.
+ *
+ * Adding strings is not thread-safe; looking up strings and IDs is.
+ *
+ * @author Philippe Proulx
+ */
+class StringDictionary
+{
+public:
+    /// Shared pointer to string dictionary
+    typedef std::shared_ptr<StringDictionary> SP;
+
+public:
+    /**
+     * Adds string \p str to this dictionary, if it's not already there.
+     *
+     * @param str String to add
+     * @returns   ID of \p str
+     */
+    interval_value_t addString(const std::string& str);
+
+    /**
+     * Finds the ID of string \p str.
+     *
+     * @param str String to look up
+     * @param id  Set to the ID of \p str if found
+     * @returns   True if \p str is in this dictionary
+     */
+    bool findId(const std::string& str, interval_value_t& id) const;
+
+    /**
+     * Returns the string of ID \p id.
+     *
+     * @param id                 String ID
+     * @returns                  String of ID \p id
+     * @throws ex::IndexOutOfRange No string has ID \p id
+     */
+    const std::string& getString(interval_value_t id) const;
+
+    /**
+     * Returns the number of strings in this dictionary.
+     *
+     * @returns Number of strings
+     */
+    std::size_t getSize() const
+    {
+        return _strings.size();
+    }
+
+    /**
+     * Appends this dictionary to \p buf: all strings, NUL-terminated,
+     * in ID order.
+     *
+     * @param buf Buffer to append to
+     */
+    void serialize(std::vector<std::uint8_t>& buf) const;
+
+    /**
+     * Adds the strings of a dictionary serialized with serialize(),
+     * \p size bytes at \p ptr.
+     *
+     * @param ptr  Address of serialized dictionary
+     * @param size Size of serialized dictionary
+     * @returns    False if the last string is not NUL-terminated
+     */
+    bool deserialize(const std::uint8_t* ptr, std::size_t size);
+
+private:
+    std::unordered_map<std::string, interval_value_t> _ids;
+
+    // points to keys of _ids, in ID order
+    std::vector<const std::string*> _strings;
+};
+
+}
+
+#endif // _STRINGDICTIONARY_HPP
@@ -33,6 +33,7 @@ namespace delo
  * Interval containing a string value. Variable data is serialized with a
  * terminating NUL character internally, so UTF-8 is allowed.
  *
+ * @see DictionaryStringInterval
  * @author Philippe Proulx
  */
 class StringInterval :
@@ -52,15 +53,29 @@ public:
 
     void setValue(const std::string& value)
     {
-        _value = value;
+        this->setValueImpl(value);
     }
 
     const std::string& getValue() const
     {
-        return _value;
+        return this->getValueImpl();
     }
 
 protected:
+    /**
+     * Builds a string interval with a custom type, for subclasses.
+     *
+     * @param begin Begin timestamp
+     * @param end   End timestamp (excluded)
+     * @param key   Key
+     * @param type  Type
+     */
+    StringInterval(timestamp_t begin, timestamp_t end,
+                   interval_key_t key, interval_type_t type);
+
+    virtual void setValueImpl(const std::string& value);
+    virtual const std::string& getValueImpl() const;
+    std::size_t getMemorySizeImpl() const;
     std::size_t getVariableDataSizeImpl() const;
     void serializeVariableDataImpl(std::uint8_t* varAtPtr) const;
     void deserializeVariableDataImpl(const std::uint8_t* varAtPtr);
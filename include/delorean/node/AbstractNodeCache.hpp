@@ -19,8 +19,12 @@
 #define _ABSTRACTNODECACHE_HPP
 
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
 
 #include <delorean/node/Node.hpp>
+#include <delorean/node/NodeCacheStats.hpp>
 #include <delorean/BasicTypes.hpp>
 
 namespace delo
@@ -29,6 +33,14 @@ namespace delo
 /**
  * Abstract node cache. Any node cache must inherit this.
  *
+ * Every node cache keeps statistics (see getStats()): hits, misses and
+ * bytes loaded from the owner are counted here (the owner reporting the
+ * bytes it reads with addBytesLoaded()), while evictions and occupancy
+ * are counted through nodeAdded() and nodeRemoved(), which concrete
+ * caches must call. Optionally, hits, misses and bytes loaded
+ * are also broken down by tree level when the level of requested nodes
+ * is known (see setLevelStatsEnabled()).
+ *
  * @author Philippe Proulx
  */
 class AbstractNodeCache
@@ -36,6 +48,9 @@ class AbstractNodeCache
 public:
     typedef std::function<Node::SP (node_seq_t)> GetNodeFromOwnerCb;
 
+    /// Unknown node level
+    static const std::size_t NO_LEVEL = static_cast<std::size_t>(-1);
+
 public:
     /**
      * Builds an abstract node cache. The \p getNodeFromOwnerCb callback
@@ -45,9 +60,15 @@ public:
      * The \p getNodeFromOwnerCb callback must return \a nullptr if
      * the requested node cannot be found.
      *
+     * If \p byteBudget is not 0, a concrete node cache supporting it
+     * must also keep the total memory size of its cached nodes (see
+     * Node::getMemorySize()) less than or equal to \p byteBudget.
+     *
      * @param size               Size of cache (node count)
+     * @param byteBudget         Maximum memory size of cached nodes
+     *                           (bytes), or 0 for no limit
      */
-    AbstractNodeCache(std::size_t size);
+    AbstractNodeCache(std::size_t size, std::size_t byteBudget = 0);
 
     virtual ~AbstractNodeCache();
 
@@ -67,11 +88,79 @@ public:
      * Returns a node with sequence number \p seqNumber from the cache.
      *
      * @param seqNumber Sequence number of node to get
+     * @param level     Level of the node in the tree (0 for the root),
+     *                  if known, for per-level statistics
      * @returns         Retrieved node or \a nullptr if not found
      */
-    Node::SP getNode(node_seq_t seqNumber)
+    Node::SP getNode(node_seq_t seqNumber, std::size_t level = NO_LEVEL)
+    {
+        auto misses = _stats.misses;
+        auto bytes = _stats.bytesLoaded;
+        auto decodedBytes = _stats.decodedBytesLoaded;
+        auto node = this->getNodeImpl(seqNumber);
+
+        if (_stats.misses == misses) {
+            _stats.hits++;
+        }
+
+        if (_levelStatsEnabled && level != NO_LEVEL) {
+            this->updateLevelStats(level, _stats.misses - misses,
+                                   _stats.bytesLoaded - bytes,
+                                   _stats.decodedBytesLoaded - decodedBytes);
+        }
+
+        return node;
+    }
+
+    /**
+     * Adds node \p node, of which the sequence number is \p seqNumber,
+     * to the cache without asking the owner for it, as if it had just
+     * been loaded. This is meant to warm up a cache with nodes read by
+     * other means. A node which is already cached is left as is. This
+     * is neither counted as a hit nor as a miss.
+     *
+     * A concrete node cache which doesn't support this keeps the cache
+     * unchanged.
+     *
+     * @param seqNumber Sequence number of node to add
+     * @param node      Node to add
+     * @returns         True if the node is cached after this call
+     */
+    bool putNode(node_seq_t seqNumber, Node::SP node)
+    {
+        return this->putNodeImpl(seqNumber, node);
+    }
+
+    /**
+     * Returns the cached node with sequence number \p seqNumber, if
+     * any, without asking the owner for it and without any side effect:
+     * this is neither counted as a hit nor as a miss, and the recency
+     * or frequency of the node is left unchanged. This is meant to probe
+     * the cache, for example when prefetching nodes.
+     *
+     * A concrete node cache which doesn't support this always returns
+     * \a nullptr.
+     *
+     * @param seqNumber Sequence number of node to get
+     * @returns         Cached node or \a nullptr if not cached
+     */
+    Node::SP peekNode(node_seq_t seqNumber) const
+    {
+        return this->peekNodeImpl(seqNumber);
+    }
+
+    /**
+     * Adds \p size bytes to the number of bytes loaded from the owner.
+     * The owner calls this when it reads \p size bytes to load a node,
+     * either from its callback (on a miss) or before putting the node
+     * into the cache (see putNode()).
+     *
+     * @param size Number of bytes read by the owner
+     */
+    void addBytesLoaded(std::uint64_t size)
     {
-        return this->getNodeImpl(seqNumber);
+        _stats.bytesLoaded += size;
+        this->addBytesLoadedImpl(size);
     }
 
     /**
@@ -103,6 +192,67 @@ public:
         return _size;
     }
 
+    /**
+     * Returns the byte budget of this cache.
+     *
+     * @returns Maximum memory size of cached nodes (bytes), or 0 if
+     *          there's no limit
+     */
+    std::size_t getByteBudget() const
+    {
+        return _byteBudget;
+    }
+
+    /**
+     * Returns the current total memory size of the nodes cached by
+     * this cache, as tracked by the concrete cache.
+     *
+     * @returns Memory size of cached nodes (bytes)
+     */
+    std::size_t getMemorySize() const
+    {
+        return _stats.memorySize;
+    }
+
+    /**
+     * Returns the current statistics of this cache.
+     *
+     * @returns Statistics
+     */
+    const NodeCacheStats& getStats() const
+    {
+        return _stats;
+    }
+
+    /**
+     * Returns the per-level statistics of this cache, indexed by tree
+     * level (0 for the root level). Only hits, misses, bytes loaded and
+     * decoded bytes are counted per level. This is empty unless per-level statistics
+     * are enabled.
+     *
+     * @returns Per-level statistics
+     */
+    const std::vector<NodeCacheStats>& getLevelStats() const
+    {
+        return _levelStats;
+    }
+
+    /**
+     * Enables or disables per-level statistics (disabled by default).
+     *
+     * @param enabled True to enable per-level statistics
+     */
+    void setLevelStatsEnabled(bool enabled)
+    {
+        _levelStatsEnabled = enabled;
+    }
+
+    /**
+     * Resets the counters of this cache's statistics (not the current
+     * occupancy).
+     */
+    void resetStats();
+
 protected:
     /**
      * A concrete node cache may call this to get a node with sequence
@@ -116,14 +266,104 @@ protected:
      */
     Node::SP getNodeFromOwner(node_seq_t seqNumber);
 
+    /**
+     * A concrete node cache must call this when adding a node of which
+     * the memory size (see Node::getMemorySize()) is \p memorySize to
+     * its cached nodes, to keep track of their total memory size.
+     *
+     * @param memorySize Memory size of the added node
+     */
+    void nodeAdded(std::size_t memorySize)
+    {
+        _stats.nodeCount++;
+        _stats.memorySize += memorySize;
+    }
+
+    /**
+     * A concrete node cache must call this when removing (evicting) a
+     * node of which the memory size is \p memorySize from its cached
+     * nodes.
+     *
+     * @param memorySize Memory size of the removed node, as passed to
+     *                   nodeAdded()
+     */
+    void nodeRemoved(std::size_t memorySize)
+    {
+        _stats.evictions++;
+        _stats.nodeCount--;
+        _stats.memorySize -= memorySize;
+    }
+
+    /**
+     * A concrete node cache may call this when a node is evicted because
+     * of a mapping conflict with the requested node.
+     */
+    void collisionOccurred()
+    {
+        _stats.collisions++;
+    }
+
+    /**
+     * Returns whether adding \p memorySize bytes to the cached nodes
+     * would exceed the byte budget of this cache.
+     *
+     * @param memorySize Memory size to add
+     * @returns          True if the byte budget would be exceeded
+     */
+    bool exceedsByteBudget(std::size_t memorySize) const
+    {
+        return _byteBudget != 0 &&
+               _stats.memorySize + memorySize > _byteBudget;
+    }
+
+    /**
+     * Returns whether a node of \p memorySize bytes is larger than the
+     * whole byte budget of this cache, that is, whether it cannot be
+     * cached even after evicting all the cached nodes.
+     *
+     * @param memorySize Memory size of the node
+     * @returns          True if the node is larger than the byte budget
+     */
+    bool exceedsWholeByteBudget(std::size_t memorySize) const
+    {
+        return _byteBudget != 0 && memorySize > _byteBudget;
+    }
+
+    /**
+     * A concrete node cache must call this when all its nodes are
+     * removed at once (invalidated).
+     */
+    void allNodesRemoved()
+    {
+        _stats.nodeCount = 0;
+        _stats.memorySize = 0;
+    }
+
     virtual Node::SP getNodeImpl(node_seq_t seqNumber) = 0;
     virtual bool nodeIsCachedImpl(node_seq_t seqNumber) const = 0;
     virtual void invalidateImpl() = 0;
+    virtual bool putNodeImpl(node_seq_t seqNumber, Node::SP node);
+    virtual Node::SP peekNodeImpl(node_seq_t seqNumber) const;
+    virtual void addBytesLoadedImpl(std::uint64_t size);
+
+private:
+    void updateLevelStats(std::size_t level, std::uint64_t misses,
+                          std::uint64_t bytes, std::uint64_t decodedBytes);
 
 private:
     // number of nodes that can be contained in this cache
     std::size_t _size;
 
+    // maximum memory size of cached nodes (0: no limit)
+    std::size_t _byteBudget;
+
+    // statistics
+    NodeCacheStats _stats;
+
+    // per-level statistics
+    std::vector<NodeCacheStats> _levelStats;
+    bool _levelStatsEnabled;
+
     // callback to get a node from the cache owner
     GetNodeFromOwnerCb _getNodeFromOwnerCb;
 };
@@ -114,6 +114,39 @@ public:
         return this->getIntervalSizeImpl(interval);
     }
 
+    /**
+     * Returns the total size of an interval, like
+     * getIntervalSize(const AbstractInterval&), once added to node
+     * \p node (after its current intervals). A concrete node ser/des
+     * encoding intervals relative to their node overrides this.
+     *
+     * @param node     Node to which the interval is to be added
+     * @param interval Interval
+     * @returns        Interval total size within \p node
+     */
+    std::size_t getIntervalSize(const Node& node,
+                                const AbstractInterval& interval) const
+    {
+        return this->getIntervalSizeInNodeImpl(node, interval);
+    }
+
+    /**
+     * Returns the number of meaningful bytes of a node of size \p size
+     * serialized at \p headPtr by serializeNode(), that is, the number of
+     * bytes to store so that deserializeNode() can read it back. This is
+     * \p size, unless a concrete node ser/des produces serialized nodes
+     * of variable size.
+     *
+     * @param headPtr Address of serialized node
+     * @param size    Node size
+     * @returns       Size of serialized node
+     */
+    std::size_t getSerializedSize(const std::uint8_t* headPtr,
+                                  std::size_t size) const
+    {
+        return this->getSerializedSizeImpl(headPtr, size);
+    }
+
     /**
      * Deserializes a node.
      *
@@ -163,6 +196,10 @@ protected:
     virtual std::size_t getHeaderSizeImpl(const Node& node) const = 0;
     virtual std::size_t getChildNodePointerSizeImpl(const ChildNodePointer& cnp) const = 0;
     virtual std::size_t getIntervalSizeImpl(const AbstractInterval& interval) const = 0;
+    virtual std::size_t getIntervalSizeInNodeImpl(const Node& node,
+                                                  const AbstractInterval& interval) const;
+    virtual std::size_t getSerializedSizeImpl(const std::uint8_t* headPtr,
+                                              std::size_t size) const;
     virtual std::unique_ptr<Node> deserializeNodeImpl(const std::uint8_t* headPtr,
                                                       std::size_t size,
                                                       std::size_t maxChildren) const = 0;
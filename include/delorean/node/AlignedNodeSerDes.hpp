@@ -34,13 +34,57 @@ namespace delo
  * Fields of the header, children pointers and intervals are aligned on a
  * multiple of their size.
  *
+ * An interval header has room for a 24-bit key and a 32-bit fixed
+ * value (sign-extended to 64 bits). An interval with a larger key or
+ * fixed value has its key field set to KEY_EXTENDED and its value field
+ * set to the offset of an extended part, within the variable data area,
+ * holding its 64-bit key and its 64-bit fixed value, followed by its own
+ * variable data, if any. Other intervals are not any larger. A node
+ * flag tells whether a node has extended intervals at all, so that a
+ * key of KEY_EXTENDED in a node written before extended parts existed
+ * is still read as is.
+ *
+ * 64-bit integer intervals of a node written before 64-bit fixed values
+ * existed (without the inline values node flag) have their value field
+ * set to the offset of 8 bytes of variable data holding their value:
+ * such a value is still read from there.
+ *
+ * With wide values, an interval header also has a 64-bit fixed value
+ * field and a separate 32-bit offset of its variable data, making it
+ * 8 bytes larger: 64-bit fixed values (64-bit integers, doubles) are
+ * always stored inline, and an extended part only holds a large key.
+ *
+ * With relative timestamps, the begin and end timestamps of the
+ * intervals of a node are stored as 32-bit offsets from the node's
+ * begin timestamp, making interval headers a third smaller, as long as
+ * the last interval of the node ends less than 2^32 after the node's
+ * begin (the intervals of a node never begin before it). Other nodes
+ * keep absolute timestamps: a node flag tells which encoding is used.
+ * Adding an interval too far from the node's begin thus costs the
+ * widening of the node's previous intervals (see
+ * getIntervalSize(const Node&, const AbstractInterval&)).
+ *
  * @author Philippe Proulx
  */
 class AlignedNodeSerDes :
     public AbstractNodeSerDes
 {
 public:
-    AlignedNodeSerDes();
+    /**
+     * Builds an aligned node ser/des.
+     *
+     * Nodes serialized with relative timestamps or not may be
+     * deserialized in both cases. Nodes serialized with wide values may
+     * only be deserialized with wide values, and vice versa.
+     *
+     * @param relativeTimestamps True to serialize nodes with relative
+     *                           timestamps when possible
+     * @param wideValues         True to use interval headers with a
+     *                           64-bit fixed value field
+     */
+    explicit AlignedNodeSerDes(bool relativeTimestamps = false,
+                               bool wideValues = false);
+
     virtual ~AlignedNodeSerDes();
 
 protected:
@@ -48,11 +92,73 @@ protected:
     std::size_t getHeaderSizeImpl(const Node& node) const;
     std::size_t getChildNodePointerSizeImpl(const ChildNodePointer& cnp) const;
     std::size_t getIntervalSizeImpl(const AbstractInterval& interval) const;
+    std::size_t getIntervalSizeInNodeImpl(const Node& node,
+                                          const AbstractInterval& interval) const;
     Node::UP deserializeNodeImpl(const std::uint8_t* headPtr,
                                  std::size_t size,
                                  std::size_t maxChildren) const;
 
 private:
+    enum : std::uint32_t {
+        // key field value of an interval with an extended key
+        KEY_EXTENDED = 0xffffff,
+    };
+
+    // fields common to all the interval header layouts
+    struct IntervalFields
+    {
+        timestamp_t begin;
+        timestamp_t end;
+        std::uint32_t typeKey;
+
+        // offset of the extended part or variable data from the node's end
+        std::uint32_t varOffset;
+
+        interval_value_t value;
+
+        interval_type_t getType() const
+        {
+            auto type = (typeKey >> 24) & 0xff;
+
+            return static_cast<interval_type_t>(type);
+        }
+
+        interval_key_t getKey() const
+        {
+            auto key = typeKey & KEY_EXTENDED;
+
+            return static_cast<interval_key_t>(key);
+        }
+
+        bool isExtended() const
+        {
+            return (typeKey & KEY_EXTENDED) == KEY_EXTENDED;
+        }
+    };
+
+    std::size_t getIntervalExtensionSize(const AbstractInterval& interval) const;
+    std::size_t getIntervalHeaderSize(bool isRelative) const;
+    void writeIntervalHeader(std::uint8_t* headPtr,
+                             const IntervalFields& fields,
+                             timestamp_t nodeBegin, bool isRelative) const;
+    void readIntervalHeader(const std::uint8_t* headPtr,
+                            IntervalFields& fields, timestamp_t nodeBegin,
+                            bool isRelative) const;
+
+    // true if `end` may be stored relative to `nodeBegin`
+    static bool fitsRelative(timestamp_t nodeBegin, timestamp_t end)
+    {
+        auto offset = static_cast<std::uint64_t>(end) -
+                      static_cast<std::uint64_t>(nodeBegin);
+
+        return end >= nodeBegin && offset <= UINT32_MAX;
+    }
+
+    bool hasRelativeTimestamps(const Node& node) const;
+
+    // true if `type` had 8 bytes of variable data before inline values
+    static bool isLegacyVariableValueType(interval_type_t type);
+
     struct NodeHeader
     {
         timestamp_t begin;
@@ -65,6 +171,9 @@ private:
         enum {
             FLAG_CLOSED_MASK = 1,
             FLAG_EXTENDED_MASK = 2,
+            FLAG_RELATIVE_MASK = 4,
+            FLAG_INTERVAL_EXTENSIONS_MASK = 8,
+            FLAG_INLINE_VALUES_MASK = 16,
         };
 
         std::size_t getChildrenCount() const
@@ -88,6 +197,28 @@ private:
             return extended == FLAG_EXTENDED_MASK;
         }
 
+        bool isRelative() const
+        {
+            auto relative = childrenCountFlags & FLAG_RELATIVE_MASK;
+
+            return relative == FLAG_RELATIVE_MASK;
+        }
+
+        bool hasInlineValues() const
+        {
+            auto inlineValues = childrenCountFlags & FLAG_INLINE_VALUES_MASK;
+
+            return inlineValues == FLAG_INLINE_VALUES_MASK;
+        }
+
+        bool hasIntervalExtensions() const
+        {
+            auto extensions = childrenCountFlags &
+                              FLAG_INTERVAL_EXTENSIONS_MASK;
+
+            return extensions == FLAG_INTERVAL_EXTENSIONS_MASK;
+        }
+
         void setFromNode(const Node& node)
         {
             begin = node.getBegin();
@@ -101,46 +232,132 @@ private:
             std::uint32_t isClosed = node.isClosed() ? FLAG_CLOSED_MASK : 0;
             std::uint32_t isExtended = node.isExtended() ? FLAG_EXTENDED_MASK : 0;
 
-            childrenCountFlags = childrenCount | isClosed | isExtended;
+            childrenCountFlags = childrenCount | isClosed | isExtended |
+                                 FLAG_INLINE_VALUES_MASK;
         }
     };
 
+    /* Interval header with a 32-bit value field, holding either the
+     * fixed value (sign-extended when read) or the offset of the
+     * extended part or variable data.
+     */
     struct IntervalHeader
     {
         timestamp_t begin;
         timestamp_t end;
         std::uint32_t typeKey;
-        interval_value_t value;
+        std::uint32_t value;
 
-        interval_type_t getType() const
+        void setFromFields(const IntervalFields& fields, timestamp_t nodeBegin)
         {
-            auto type = (typeKey >> 24) & 0xff;
+            begin = fields.begin;
+            end = fields.end;
+            typeKey = fields.typeKey;
+            value = fields.varOffset;
 
-            return static_cast<interval_type_t>(type);
+            if (fields.varOffset == 0) {
+                value = static_cast<std::uint32_t>(fields.value);
+            }
         }
 
-        interval_key_t getKey() const
+        void getFields(IntervalFields& fields, timestamp_t nodeBegin) const
         {
-            auto key = typeKey & 0xffffff;
+            fields.begin = begin;
+            fields.end = end;
+            fields.typeKey = typeKey;
+            fields.varOffset = value;
+            fields.value = static_cast<interval_value_t>(
+                static_cast<std::int32_t>(value));
+        }
+    };
 
-            return static_cast<interval_key_t>(key);
+    // interval header of a node with relative timestamps
+    struct RelativeIntervalHeader
+    {
+        std::uint32_t begin;
+        std::uint32_t end;
+        std::uint32_t typeKey;
+        std::uint32_t value;
+
+        void setFromFields(const IntervalFields& fields, timestamp_t nodeBegin)
+        {
+            IntervalHeader header;
+            header.setFromFields(fields, nodeBegin);
+            begin = static_cast<std::uint32_t>(header.begin - nodeBegin);
+            end = static_cast<std::uint32_t>(header.end - nodeBegin);
+            typeKey = header.typeKey;
+            value = header.value;
         }
 
-        void setFromInterval(const AbstractInterval& interval)
+        void getFields(IntervalFields& fields, timestamp_t nodeBegin) const
         {
-            begin = interval.getBegin();
-            end = interval.getEnd();
-            value = interval.getFixedValue();
+            IntervalHeader header {nodeBegin + begin, nodeBegin + end,
+                                   typeKey, value};
+            header.getFields(fields, nodeBegin);
+        }
+    };
 
-            auto type = static_cast<std::uint32_t>(interval.getType());
-            type <<= 24;
-            auto key = static_cast<std::uint32_t>(interval.getKey());
-            key &= 0xffffff;
+    /* Interval header with a 64-bit fixed value field and a separate
+     * offset of the extended part or variable data.
+     */
+    struct WideIntervalHeader
+    {
+        timestamp_t begin;
+        timestamp_t end;
+        std::uint32_t typeKey;
+        std::uint32_t varOffset;
+        interval_value_t value;
 
-            typeKey = type | key;
+        void setFromFields(const IntervalFields& fields, timestamp_t nodeBegin)
+        {
+            begin = fields.begin;
+            end = fields.end;
+            typeKey = fields.typeKey;
+            varOffset = fields.varOffset;
+            value = fields.value;
+        }
+
+        void getFields(IntervalFields& fields, timestamp_t nodeBegin) const
+        {
+            fields.begin = begin;
+            fields.end = end;
+            fields.typeKey = typeKey;
+            fields.varOffset = varOffset;
+            fields.value = value;
         }
     };
 
+    // wide interval header of a node with relative timestamps
+    struct RelativeWideIntervalHeader
+    {
+        std::uint32_t begin;
+        std::uint32_t end;
+        std::uint32_t typeKey;
+        std::uint32_t varOffset;
+        interval_value_t value;
+
+        void setFromFields(const IntervalFields& fields, timestamp_t nodeBegin)
+        {
+            begin = static_cast<std::uint32_t>(fields.begin - nodeBegin);
+            end = static_cast<std::uint32_t>(fields.end - nodeBegin);
+            typeKey = fields.typeKey;
+            varOffset = fields.varOffset;
+            value = fields.value;
+        }
+
+        void getFields(IntervalFields& fields, timestamp_t nodeBegin) const
+        {
+            fields.begin = nodeBegin + begin;
+            fields.end = nodeBegin + end;
+            fields.typeKey = typeKey;
+            fields.varOffset = varOffset;
+            fields.value = value;
+        }
+    };
+
+    bool _relativeTimestamps;
+    bool _wideValues;
+
     struct ChildNodePointerHeader
     {
         timestamp_t begin;
@@ -0,0 +1,119 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _ARCNODECACHE_HPP
+#define _ARCNODECACHE_HPP
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+
+#include <delorean/node/AbstractNodeCache.hpp>
+#include <delorean/node/Node.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+/**
+ * Adaptive replacement cache (ARC, Megiddo and Modha) of nodes. This
+ * cache resists scans and adapts itself to the workload.
+ *
+ * Cached nodes are split between a recency list (T1: nodes accessed
+ * once recently) and a frequency list (T2: nodes accessed at least
+ * twice recently). Two ghost lists (B1 and B2) remember the sequence
+ * numbers of nodes recently evicted from T1 and T2. A hit in a ghost
+ * list moves the target size of T1 in favour of the list which would
+ * have kept the node. A scan only flows through T1, leaving the
+ * frequently used nodes of T2 in the cache.
+ *
+ * This cache tracks the memory size of its cached nodes, but doesn't
+ * support a byte budget: its adaptation is based on node counts.
+ *
+ * @author Philippe Proulx
+ */
+class ArcNodeCache :
+    public AbstractNodeCache
+{
+public:
+    /**
+     * Builds an ARC node cache.
+     *
+     * @param size Size of cache (node count)
+     */
+    ArcNodeCache(std::size_t size);
+
+protected:
+    Node::SP getNodeImpl(node_seq_t seqNumber);
+    bool nodeIsCachedImpl(node_seq_t seqNumber) const;
+    void invalidateImpl();
+    bool putNodeImpl(node_seq_t seqNumber, Node::SP node);
+    Node::SP peekNodeImpl(node_seq_t seqNumber) const;
+
+private:
+    enum class Queue
+    {
+        T1,
+        T2,
+        B1,
+        B2,
+    };
+
+    struct Entry
+    {
+        // sequence number
+        node_seq_t seqNumber;
+
+        // cached node (`nullptr` in ghost lists)
+        Node::SP node;
+
+        // memory size of cached node
+        std::size_t memorySize;
+    };
+
+    typedef std::list<Entry> EntryList;
+
+    struct Location
+    {
+        Queue queue;
+        EntryList::iterator it;
+    };
+
+private:
+    EntryList& getList(Queue queue);
+    void moveToFront(Location& location, Queue queue);
+    void dropBack(EntryList& list);
+    void replace(bool inB2);
+    void insertNew(node_seq_t seqNumber, Node::SP node);
+
+private:
+    // target size of T1
+    std::size_t _t1Target;
+
+    // lists (most recent first)
+    EntryList _t1List;
+    EntryList _t2List;
+    EntryList _b1List;
+    EntryList _b2List;
+
+    // locations of all entries
+    std::unordered_map<node_seq_t, Location> _locations;
+};
+
+}
+
+#endif // _ARCNODECACHE_HPP
@@ -0,0 +1,291 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _COLUMNARNODESERDES_HPP
+#define _COLUMNARNODESERDES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <delorean/node/Node.hpp>
+#include <delorean/node/ChildNodePointer.hpp>
+#include <delorean/node/AbstractNodeSerDes.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+/**
+ * Columnar node serializer/deserializer.
+ *
+ * The node header is followed by the begin timestamps, then the sequence
+ * numbers of the child node pointers (room for the maximum number of
+ * children is reserved). The intervals are then stored as separate
+ * columns, in this order: begin timestamps, end timestamps, keys, fixed
+ * values (64-bit each) and types (8-bit). Each column starts on a
+ * multiple of COLUMN_ALIGNMENT bytes from the beginning of the node, so
+ * that a column of a node read at an aligned address may be loaded with
+ * aligned SIMD loads. Variable data is stored at the end of the node,
+ * like with AlignedNodeSerDes: the fixed value of an interval having
+ * variable data is the offset of its variable data from the end of the
+ * node.
+ *
+ * The static methods getColumns(), findAll() and findOne() run queries
+ * directly over the bytes of a serialized node, only touching the
+ * columns they need, without deserializing it.
+ *
+ * @author Philippe Proulx
+ */
+class ColumnarNodeSerDes :
+    public AbstractNodeSerDes
+{
+public:
+    enum {
+        /// Alignment of each column within a node (bytes)
+        COLUMN_ALIGNMENT = 32,
+    };
+
+    /**
+     * Interval columns of a serialized node.
+     */
+    class Columns
+    {
+        friend class ColumnarNodeSerDes;
+
+    public:
+        /**
+         * Returns the number of intervals.
+         *
+         * @returns Number of intervals
+         */
+        std::size_t getIntervalCount() const
+        {
+            return _intervalCount;
+        }
+
+        /**
+         * Returns the begin timestamp of the interval at index \p index.
+         *
+         * @param index Interval index
+         * @returns     Begin timestamp
+         */
+        timestamp_t getBegin(std::size_t index) const
+        {
+            return load<timestamp_t>(_begins, index);
+        }
+
+        /**
+         * Returns the end timestamp of the interval at index \p index.
+         *
+         * @param index Interval index
+         * @returns     End timestamp
+         */
+        timestamp_t getEnd(std::size_t index) const
+        {
+            return load<timestamp_t>(_ends, index);
+        }
+
+        /**
+         * Returns the key of the interval at index \p index.
+         *
+         * @param index Interval index
+         * @returns     Key
+         */
+        interval_key_t getKey(std::size_t index) const
+        {
+            return load<interval_key_t>(_keys, index);
+        }
+
+        /**
+         * Returns the serialized fixed value of the interval at index
+         * \p index (offset of its variable data from the end of the
+         * node if it has any).
+         *
+         * @param index Interval index
+         * @returns     Serialized fixed value
+         */
+        interval_value_t getValue(std::size_t index) const
+        {
+            return load<interval_value_t>(_values, index);
+        }
+
+        /**
+         * Returns the type of the interval at index \p index.
+         *
+         * @param index Interval index
+         * @returns     Type
+         */
+        interval_type_t getType(std::size_t index) const
+        {
+            return static_cast<interval_type_t>(_types[index]);
+        }
+
+    private:
+        template<typename T>
+        static T load(const std::uint8_t* column, std::size_t index)
+        {
+            T value;
+
+            std::memcpy(&value, column + index * sizeof(T), sizeof(T));
+
+            return value;
+        }
+
+    private:
+        std::size_t _intervalCount;
+        const std::uint8_t* _begins;
+        const std::uint8_t* _ends;
+        const std::uint8_t* _keys;
+        const std::uint8_t* _values;
+        const std::uint8_t* _types;
+    };
+
+public:
+    ColumnarNodeSerDes();
+    virtual ~ColumnarNodeSerDes();
+
+    /**
+     * Returns the interval columns of the node serialized at
+     * \p headPtr.
+     *
+     * @param headPtr Address of serialized node
+     * @returns       Interval columns
+     */
+    static Columns getColumns(const std::uint8_t* headPtr);
+
+    /**
+     * Finds the intervals of \p columns intersecting \p ts, like
+     * Node::findAll(), and appends their indexes to \p indexes in
+     * ascending order of end time. Only the end and begin columns
+     * are read.
+     *
+     * @param columns Interval columns
+     * @param ts      Timestamp
+     * @param indexes Vector to which to append interval indexes
+     * @returns       True if at least one interval was found
+     */
+    static bool findAll(const Columns& columns, timestamp_t ts,
+                        std::vector<std::size_t>& indexes);
+
+    /**
+     * Finds the interval of \p columns intersecting \p ts and having
+     * key \p key, like Node::findOne(). Only the end, key and begin
+     * columns are read.
+     *
+     * @param columns Interval columns
+     * @param ts      Timestamp
+     * @param key     Key
+     * @param index   Found interval index
+     * @returns       True if an interval was found
+     */
+    static bool findOne(const Columns& columns, timestamp_t ts,
+                        interval_key_t key, std::size_t& index);
+
+protected:
+    void serializeNodeImpl(const Node& node, std::uint8_t* headPtr) const;
+    std::size_t getHeaderSizeImpl(const Node& node) const;
+    std::size_t getChildNodePointerSizeImpl(const ChildNodePointer& cnp) const;
+    std::size_t getIntervalSizeImpl(const AbstractInterval& interval) const;
+    Node::UP deserializeNodeImpl(const std::uint8_t* headPtr,
+                                 std::size_t size,
+                                 std::size_t maxChildren) const;
+
+private:
+    struct NodeHeader
+    {
+        timestamp_t begin;
+        timestamp_t end;
+        std::uint32_t childrenCountFlags;
+        node_seq_t seqNumber;
+        node_seq_t parentSeqNumber;
+        std::uint32_t intervalCount;
+        std::uint32_t columnsOffset;
+        std::uint32_t reserved;
+
+        enum {
+            FLAG_CLOSED_MASK = 1,
+            FLAG_EXTENDED_MASK = 2,
+        };
+
+        std::size_t getChildrenCount() const
+        {
+            auto childrenCount = (childrenCountFlags >> 8) & 0xffffff;
+
+            return static_cast<std::size_t>(childrenCount);
+        }
+
+        bool isClosed() const
+        {
+            auto closed = childrenCountFlags & FLAG_CLOSED_MASK;
+
+            return closed == FLAG_CLOSED_MASK;
+        }
+
+        bool isExtended() const
+        {
+            auto extended = childrenCountFlags & FLAG_EXTENDED_MASK;
+
+            return extended == FLAG_EXTENDED_MASK;
+        }
+
+        void setFromNode(const Node& node)
+        {
+            begin = node.getBegin();
+            end = node.getEnd();
+            seqNumber = node.getSeqNumber();
+            parentSeqNumber = node.getParentSeqNumber();
+            intervalCount = node.getIntervalCount();
+            reserved = 0;
+
+            std::uint32_t childrenCount = static_cast<uint32_t>(node.getChildrenCount());
+            childrenCount <<= 8;
+            std::uint32_t isClosed = node.isClosed() ? FLAG_CLOSED_MASK : 0;
+            std::uint32_t isExtended = node.isExtended() ? FLAG_EXTENDED_MASK : 0;
+
+            childrenCountFlags = childrenCount | isClosed | isExtended;
+        }
+    };
+
+    // size of the fixed part of an interval, in all columns
+    static constexpr std::size_t intervalColumnsSize()
+    {
+        return sizeof(timestamp_t) * 2 + sizeof(std::uint64_t) * 2 +
+               sizeof(std::uint8_t);
+    }
+
+    static std::size_t alignColumn(std::size_t offset)
+    {
+        return (offset + COLUMN_ALIGNMENT - 1) & ~static_cast<std::size_t>(COLUMN_ALIGNMENT - 1);
+    }
+
+    static std::size_t getColumnsOffset(std::size_t maxChildren)
+    {
+        return alignColumn(sizeof(NodeHeader) +
+                           maxChildren * (sizeof(timestamp_t) +
+                                          sizeof(node_seq_t)));
+    }
+
+    static Columns makeColumns(const std::uint8_t* headPtr,
+                               std::size_t columnsOffset,
+                               std::size_t intervalCount);
+};
+
+}
+
+#endif // _COLUMNARNODESERDES_HPP
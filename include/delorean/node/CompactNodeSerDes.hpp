@@ -0,0 +1,142 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _COMPACTNODESERDES_HPP
+#define _COMPACTNODESERDES_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <delorean/node/Node.hpp>
+#include <delorean/node/ChildNodePointer.hpp>
+#include <delorean/node/AbstractNodeSerDes.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+/**
+ * Compact node serializer/deserializer.
+ *
+ * The node header is the same as the one of AlignedNodeSerDes, but
+ * child node pointers and intervals are packed as unsigned LEB128
+ * numbers (varints):
+ *
+ *   * Child node pointer: begin timestamp (delta from the previous
+ *     child's begin, or from the node's begin for the first one) and
+ *     sequence number.
+ *   * Interval: end timestamp (delta from the previous interval's end,
+ *     or from the node's begin for the first one), duration (end minus
+ *     begin), type (single byte), key, fixed value, then variable data,
+ *     if any, inline.
+ *
+ * Signed deltas and fixed values are zigzag-encoded first so that small
+ * negative values stay small. The size of an interval thus depends on
+ * the node it's added to (see getIntervalSize(const Node&, const
+ * AbstractInterval&)). Room for the maximum number of children, each
+ * one taking its maximum encoded size, is reserved in the header size,
+ * so that children may still be added once a node is full of intervals.
+ *
+ * A node full of small integer intervals holds several times more
+ * intervals than with AlignedNodeSerDes.
+ *
+ * @author Philippe Proulx
+ */
+class CompactNodeSerDes :
+    public AbstractNodeSerDes
+{
+public:
+    CompactNodeSerDes();
+    virtual ~CompactNodeSerDes();
+
+protected:
+    void serializeNodeImpl(const Node& node, std::uint8_t* headPtr) const;
+    std::size_t getHeaderSizeImpl(const Node& node) const;
+    std::size_t getChildNodePointerSizeImpl(const ChildNodePointer& cnp) const;
+    std::size_t getIntervalSizeImpl(const AbstractInterval& interval) const;
+    std::size_t getIntervalSizeInNodeImpl(const Node& node,
+                                          const AbstractInterval& interval) const;
+    Node::UP deserializeNodeImpl(const std::uint8_t* headPtr,
+                                 std::size_t size,
+                                 std::size_t maxChildren) const;
+
+private:
+    struct NodeHeader
+    {
+        timestamp_t begin;
+        timestamp_t end;
+        std::uint32_t childrenCountFlags;
+        node_seq_t seqNumber;
+        node_seq_t parentSeqNumber;
+        std::uint32_t intervalCount;
+
+        enum {
+            FLAG_CLOSED_MASK = 1,
+            FLAG_EXTENDED_MASK = 2,
+        };
+
+        std::size_t getChildrenCount() const
+        {
+            auto childrenCount = (childrenCountFlags >> 8) & 0xffffff;
+
+            return static_cast<std::size_t>(childrenCount);
+        }
+
+        bool isClosed() const
+        {
+            auto closed = childrenCountFlags & FLAG_CLOSED_MASK;
+
+            return closed == FLAG_CLOSED_MASK;
+        }
+
+        bool isExtended() const
+        {
+            auto extended = childrenCountFlags & FLAG_EXTENDED_MASK;
+
+            return extended == FLAG_EXTENDED_MASK;
+        }
+
+        void setFromNode(const Node& node)
+        {
+            begin = node.getBegin();
+            end = node.getEnd();
+            seqNumber = node.getSeqNumber();
+            parentSeqNumber = node.getParentSeqNumber();
+            intervalCount = node.getIntervalCount();
+
+            std::uint32_t childrenCount = static_cast<uint32_t>(node.getChildrenCount());
+            childrenCount <<= 8;
+            std::uint32_t isClosed = node.isClosed() ? FLAG_CLOSED_MASK : 0;
+            std::uint32_t isExtended = node.isExtended() ? FLAG_EXTENDED_MASK : 0;
+
+            childrenCountFlags = childrenCount | isClosed | isExtended;
+        }
+    };
+
+    // maximum encoded sizes
+    enum {
+        MAX_TIMESTAMP_SIZE = 10,
+        MAX_SEQ_NUMBER_SIZE = 5,
+        MAX_KEY_SIZE = 10,
+        MAX_VALUE_SIZE = 10,
+        MAX_CHILD_NODE_POINTER_SIZE = MAX_TIMESTAMP_SIZE + MAX_SEQ_NUMBER_SIZE,
+    };
+};
+
+}
+
+#endif // _COMPACTNODESERDES_HPP
@@ -0,0 +1,77 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _COMPRESSEDNODESERDES_HPP
+#define _COMPRESSEDNODESERDES_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <delorean/node/Node.hpp>
+#include <delorean/node/CompactNodeSerDes.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+/**
+ * Compressed node serializer/deserializer.
+ *
+ * Nodes are first serialized like with CompactNodeSerDes to an image of
+ * the node's (logical) size, which is then compressed with LzCodec. The
+ * serialized node is a 32-bit compressed length field followed by the
+ * compressed payload. If the payload doesn't get smaller, the image is
+ * stored as is instead (flagged in the length field); room for the
+ * length field is reserved in the header size so that this always fits
+ * within the node's size.
+ *
+ * Since a serialized node is usually much smaller than the node's size,
+ * history files using this ser/des store nodes back to back instead of
+ * in fixed-size slots (see getSerializedSize()).
+ *
+ * @author Philippe Proulx
+ */
+class CompressedNodeSerDes :
+    public CompactNodeSerDes
+{
+public:
+    CompressedNodeSerDes();
+    virtual ~CompressedNodeSerDes();
+
+protected:
+    void serializeNodeImpl(const Node& node, std::uint8_t* headPtr) const;
+    std::size_t getHeaderSizeImpl(const Node& node) const;
+    std::size_t getSerializedSizeImpl(const std::uint8_t* headPtr,
+                                      std::size_t size) const;
+    Node::UP deserializeNodeImpl(const std::uint8_t* headPtr,
+                                 std::size_t size,
+                                 std::size_t maxChildren) const;
+
+private:
+    enum {
+        LENGTH_FIELD_SIZE = sizeof(std::uint32_t),
+    };
+
+    enum : std::uint32_t {
+        FLAG_STORED_MASK = 0x80000000,
+        LENGTH_MASK = 0x7fffffff,
+    };
+};
+
+}
+
+#endif // _COMPRESSEDNODESERDES_HPP
@@ -0,0 +1,77 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _CRC32C_HPP
+#define _CRC32C_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace delo
+{
+
+/**
+ * CRC-32C (Castagnoli) checksum, as used to detect corrupted nodes.
+ *
+ * compute() uses the SSE4.2 CRC32 instruction when the CPU supports it
+ * (checked once at run time), and a table-driven implementation
+ * otherwise; both give the same results.
+ *
+ * @author Philippe Proulx
+ */
+class Crc32c
+{
+public:
+    /**
+     * Computes the CRC-32C of \p size bytes at \p data.
+     *
+     * \p crc may be the result of a previous call to continue the
+     * checksum of consecutive buffers.
+     *
+     * @param data Address of bytes
+     * @param size Number of bytes
+     * @param crc  Checksum of the previous bytes, or 0
+     * @returns    Checksum
+     */
+    static std::uint32_t compute(const std::uint8_t* data, std::size_t size,
+                                 std::uint32_t crc = 0);
+
+    /**
+     * Computes the CRC-32C of \p size bytes at \p data like compute(),
+     * always without hardware acceleration.
+     *
+     * @param data Address of bytes
+     * @param size Number of bytes
+     * @param crc  Checksum of the previous bytes, or 0
+     * @returns    Checksum
+     */
+    static std::uint32_t computeSoftware(const std::uint8_t* data,
+                                         std::size_t size,
+                                         std::uint32_t crc = 0);
+
+    /**
+     * Returns whether or not compute() uses the SSE4.2 CRC32
+     * instruction on this CPU.
+     *
+     * @returns True if hardware-accelerated
+     */
+    static bool isHardwareAccelerated();
+};
+
+}
+
+#endif // _CRC32C_HPP
@@ -19,6 +19,7 @@
 #define _DIRECTMAPPEDNODECACHE_HPP
 
 #include <cstddef>
+#include <vector>
 
 #include <delorean/node/AbstractNodeCache.hpp>
 #include <delorean/node/Node.hpp>
@@ -54,10 +55,15 @@ protected:
     Node::SP getNodeImpl(node_seq_t seqNumber);
     bool nodeIsCachedImpl(node_seq_t seqNumber) const;
     void invalidateImpl();
+    bool putNodeImpl(node_seq_t seqNumber, Node::SP node);
+    Node::SP peekNodeImpl(node_seq_t seqNumber) const;
 
 private:
     // cache
     std::vector<Node::SP> _cache;
+
+    // memory sizes of cached nodes
+    std::vector<std::size_t> _memorySizes;
 };
 
 }
@@ -20,8 +20,8 @@
 #define _LRUNODECACHE_HPP
 
 #include <cstddef>
-#include <list>
-#include <map>
+#include <cstdint>
+#include <vector>
 
 #include <delorean/node/AbstractNodeCache.hpp>
 #include <delorean/node/Node.hpp>
@@ -33,31 +33,95 @@ namespace delo {
  * Least recently used node cache. The cache always replaces the least
  * recently used node on a cache miss.
  *
+ * All entries are preallocated when building the cache and linked
+ * together in recency order by index (intrusive list). Nodes are found
+ * using an open addressing hash table (linear probing) mapping sequence
+ * numbers to entry indexes. Thus getting a node is O(1) and nothing is
+ * allocated, neither on a hit nor on a miss.
+ *
+ * This cache supports a byte budget: least recently used nodes are also
+ * dropped to keep the memory size of cached nodes within the budget. A
+ * node larger than the whole budget is never cached.
+ *
  * @author Simon Marchi
  */
 class LruNodeCache :
     public AbstractNodeCache
 {
-private:
-    typedef std::list<Node::SP> NodeList;
-    typedef std::map<node_seq_t, NodeList::iterator> NodeMap;
-
 public:
     /**
      * Builds an LRU node cache.
      *
-     * @param size Size of cache (node count)
+     * @param size       Size of cache (node count)
+     * @param byteBudget Maximum memory size of cached nodes (bytes), or
+     *                   0 for no limit
      */
-    LruNodeCache(std::size_t size);
+    LruNodeCache(std::size_t size, std::size_t byteBudget = 0);
 
 protected:
     Node::SP getNodeImpl(node_seq_t seqNumber);
     bool nodeIsCachedImpl(node_seq_t seqNumber) const;
     void invalidateImpl();
+    bool putNodeImpl(node_seq_t seqNumber, Node::SP node);
+    Node::SP peekNodeImpl(node_seq_t seqNumber) const;
 
 private:
-    NodeList _list;
-    NodeMap _map;
+    typedef std::uint32_t index_t;
+
+    struct Entry
+    {
+        // cached node
+        Node::SP node;
+
+        // sequence number of cached node
+        node_seq_t seqNumber;
+
+        // memory size of cached node
+        std::size_t memorySize;
+
+        // previous (more recently used) and next entries (next free
+        // entry when free)
+        index_t prev;
+        index_t next;
+    };
+
+    // "no entry" index (end of list, empty table slot)
+    static const index_t NONE = static_cast<index_t>(-1);
+
+private:
+    std::size_t getHomeSlot(node_seq_t seqNumber) const
+    {
+        // Fibonacci hashing: consecutive sequence numbers spread well
+        auto hash = static_cast<std::uint32_t>(seqNumber) * 2654435769U;
+
+        return static_cast<std::size_t>(hash >> _tableShift);
+    }
+
+    std::size_t findSlot(node_seq_t seqNumber) const;
+    void removeFromTable(std::size_t slot);
+    bool insertNode(node_seq_t seqNumber, Node::SP node);
+    void dropLeastRecentlyUsed();
+    void resetFreeList();
+    void unlink(index_t index);
+    void pushFront(index_t index);
+
+private:
+    // preallocated entries
+    std::vector<Entry> _entries;
+
+    // hash table of entry indexes (power of two size)
+    std::vector<index_t> _table;
+
+    // table index mask and hash shift
+    std::size_t _tableMask;
+    unsigned int _tableShift;
+
+    // most and least recently used entries
+    index_t _head;
+    index_t _tail;
+
+    // first free entry
+    index_t _free;
 };
 
 }
@@ -0,0 +1,85 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _LZCODEC_HPP
+#define _LZCODEC_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace delo
+{
+
+/**
+ * Small and fast LZ77 block codec.
+ *
+ * A compressed block is a sequence of
+ *
+ *   * a token byte (high nibble: literal count, low nibble: match
+ *     length minus 4), 15 meaning that more length bytes follow
+ *     (each one added until one is not 255);
+ *   * literal bytes;
+ *   * a 16-bit little-endian match offset, except for the last
+ *     sequence which only holds literals.
+ *
+ * Matches are found with a single hash table probe, favoring speed over
+ * ratio; this is enough for the zero-filled and repetitive contents of
+ * serialized nodes.
+ *
+ * @author Philippe Proulx
+ */
+class LzCodec
+{
+public:
+    /**
+     * Compresses \p srcSize bytes at \p src to \p dst.
+     *
+     * @param src         Address of bytes to compress
+     * @param srcSize     Number of bytes to compress
+     * @param dst         Address at which to write compressed bytes
+     * @param dstCapacity Maximum number of bytes to write at \p dst
+     * @returns           Compressed size, or 0 if it would exceed
+     *                    \p dstCapacity
+     */
+    static std::size_t compress(const std::uint8_t* src, std::size_t srcSize,
+                                std::uint8_t* dst, std::size_t dstCapacity);
+
+    /**
+     * Decompresses \p srcSize bytes at \p src to exactly \p dstSize
+     * bytes at \p dst.
+     *
+     * @param src     Address of compressed bytes
+     * @param srcSize Number of compressed bytes
+     * @param dst     Address at which to write decompressed bytes
+     * @param dstSize Expected decompressed size
+     * @returns       True if the block is valid and decompresses to
+     *                exactly \p dstSize bytes
+     */
+    static bool decompress(const std::uint8_t* src, std::size_t srcSize,
+                           std::uint8_t* dst, std::size_t dstSize);
+
+private:
+    enum {
+        MIN_MATCH_SIZE = 4,
+        MAX_OFFSET = 0xffff,
+        HASH_BITS = 12,
+    };
+};
+
+}
+
+#endif // _LZCODEC_HPP
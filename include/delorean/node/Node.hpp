@@ -22,9 +22,11 @@
 #include <memory>
 #include <cstdint>
 #include <vector>
+#include <algorithm>
 
 #include <delorean/interval/AbstractInterval.hpp>
 #include <delorean/interval/IntervalJar.hpp>
+#include <delorean/interval/FlatIntervalJar.hpp>
 #include <delorean/node/AbstractNodeSerDes.hpp>
 #include <delorean/ex/IndexOutOfRange.hpp>
 #include <delorean/BasicTypes.hpp>
@@ -86,6 +88,16 @@ public:
      */
     bool intervalFits(const AbstractInterval& interval);
 
+    /**
+     * Extends this node to a total size of \p size bytes, so that its
+     * variable area spills over extension pages and intervals too large
+     * for a regular node may be added. An extended node is serialized
+     * to \p size bytes.
+     *
+     * @param size New total size (not less than the current one)
+     */
+    void extend(std::size_t size);
+
     /**
      * Closes this node with end timestamp \p end. Once a node is closed,
      * it's not possible to add new intervals or new children.
@@ -103,6 +115,17 @@ public:
      */
     bool findAll(timestamp_t ts, IntervalJar& intervals) const;
 
+    /**
+     * Finds all intervals that intersect with \p ts and appends them
+     * to the flat jar \p intervals, without sorting it. The caller
+     * must call FlatIntervalJar::normalize() once done appending.
+     *
+     * @param ts        Timestamp
+     * @param intervals Flat jar to which to append matching intervals
+     * @returns         True if at least one interval was found
+     */
+    bool findAll(timestamp_t ts, FlatIntervalJar& intervals) const;
+
     /**
      * Finds the first interval intersecting \p ts and having key
      * \p key.
@@ -113,6 +136,37 @@ public:
      */
     AbstractInterval::SP findOne(timestamp_t ts, interval_key_t key) const;
 
+    /**
+     * Visits all intervals that intersect with \p ts, in ascending order
+     * of end time, without copying any interval shared pointer.
+     *
+     * \p visitor is called as <code>bool visitor(const
+     * AbstractInterval&)</code> for each matching interval and must
+     * return \a true to continue the visit or \a false to stop it.
+     *
+     * @param ts      Timestamp
+     * @param visitor Visitor to call for each matching interval
+     * @returns       False if \p visitor stopped the visit
+     */
+    template<typename VisitorT>
+    bool visitAll(timestamp_t ts, VisitorT& visitor) const;
+
+    /**
+     * Visits all intervals that intersect with the time range
+     * [\p begin, \p end), in ascending order of end time. Intervals of
+     * length 0 never intersect a time range.
+     *
+     * \p visitor is called exactly like in visitAll().
+     *
+     * @param begin   Range begin timestamp
+     * @param end     Range end timestamp (excluded)
+     * @param visitor Visitor to call for each matching interval
+     * @returns       False if \p visitor stopped the visit
+     */
+    template<typename VisitorT>
+    bool visitRange(timestamp_t begin, timestamp_t end,
+                    VisitorT& visitor) const;
+
     /**
      * Adds a child (pointer) to this node.
      *
@@ -194,6 +248,16 @@ public:
         return _totalSize;
     }
 
+    /**
+     * Returns the approximate size of the memory used by this node
+     * object in bytes, including its intervals (and their variable
+     * data) and its children pointers. This is not the serialized
+     * size of this node (see getSize()).
+     *
+     * @returns Approximate memory size in bytes
+     */
+    std::size_t getMemorySize() const;
+
     /**
      * Returns this node's begin timestamp.
      *
@@ -305,6 +369,16 @@ public:
         return _children;
     }
 
+    /**
+     * Returns the ser/des of this node, used to compute its size.
+     *
+     * @returns Node ser/des pointer (may be \a nullptr)
+     */
+    const AbstractNodeSerDes* getSerDes() const
+    {
+        return _serdes;
+    }
+
     /**
      * Returns the root node's parent sequence number constant.
      *
@@ -353,6 +427,55 @@ private:
     const AbstractNodeSerDes* _serdes;
 };
 
+template<typename VisitorT>
+bool Node::visitAll(timestamp_t ts, VisitorT& visitor) const
+{
+    // fast path when there's no interval
+    if (_intervals.empty()) {
+        return true;
+    }
+
+    for (auto it = this->getFirstItForTs(ts); it != _intervals.end(); ++it) {
+        const auto& interval = **it;
+
+        if (ts >= interval.getBegin()) {
+            if (!visitor(interval)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+template<typename VisitorT>
+bool Node::visitRange(timestamp_t begin, timestamp_t end,
+                      VisitorT& visitor) const
+{
+    // fast path when there's no interval
+    if (_intervals.empty()) {
+        return true;
+    }
+
+    /* Intervals are sorted by end time, so we may skip all the ones ending
+     * at or before `begin`, but we need to check all the others since
+     * their begin timestamps are not sorted.
+     */
+    for (auto it = this->getFirstItForTs(begin); it != _intervals.end(); ++it) {
+        const auto& interval = **it;
+        auto maxBegin = std::max(begin, interval.getBegin());
+        auto minEnd = std::min(end, interval.getEnd());
+
+        if (maxBegin < minEnd) {
+            if (!visitor(interval)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
 }
 
 #endif // _NODE_HPP
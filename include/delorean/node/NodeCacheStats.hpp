@@ -0,0 +1,66 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _NODECACHESTATS_HPP
+#define _NODECACHESTATS_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+namespace delo
+{
+
+/**
+ * Node cache statistics.
+ *
+ * @see AbstractNodeCache::getStats()
+ * @author Philippe Proulx
+ */
+struct NodeCacheStats
+{
+    /// Number of requested nodes found in the cache
+    std::uint64_t hits = 0;
+
+    /// Number of requested nodes which had to be loaded from the owner
+    std::uint64_t misses = 0;
+
+    /// Number of cached nodes evicted to make room for other ones
+    std::uint64_t evictions = 0;
+
+    /// Number of evictions caused by a mapping conflict (direct mapped
+    /// caches only)
+    std::uint64_t collisions = 0;
+
+    /// Number of bytes read by the owner to load nodes into the cache,
+    /// as reported by the owner (see AbstractNodeCache::addBytesLoaded())
+    std::uint64_t bytesLoaded = 0;
+
+    /// Total memory size (see Node::getMemorySize()) of the decoded
+    /// nodes loaded from the owner (bytes), not the number of bytes
+    /// read to load them
+    std::uint64_t decodedBytesLoaded = 0;
+
+    /// Number of currently cached nodes
+    std::size_t nodeCount = 0;
+
+    /// Current memory size of cached nodes (bytes)
+    std::size_t memorySize = 0;
+};
+
+}
+
+#endif // _NODECACHESTATS_HPP
@@ -31,6 +31,12 @@ namespace delo
 enum class NodeSerDesType
 {
     ALIGNED = 0,
+    COMPACT = 1,
+    COMPRESSED = 2,
+    COLUMNAR = 3,
+    ALIGNED_RELATIVE = 4,
+    ALIGNED_WIDE = 5,
+    ALIGNED_WIDE_RELATIVE = 6,
     COUNT       // number of items above; always last
 };
 
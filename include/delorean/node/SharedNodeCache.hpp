@@ -0,0 +1,237 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _SHAREDNODECACHE_HPP
+#define _SHAREDNODECACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <boost/filesystem.hpp>
+
+#include <delorean/node/AbstractNodeCache.hpp>
+#include <delorean/node/NodeCacheStats.hpp>
+#include <delorean/node/Node.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+/**
+ * Node cache shared by many owners (typically many history file
+ * sources), with a single capacity and a single byte budget.
+ *
+ * A shared node cache is not used directly: each owner gets its own
+ * view of it (see createView()), which is a regular node cache with its
+ * own owner callback. Cached nodes are keyed by file identity and
+ * sequence number, so that the views of the same history file share
+ * their nodes, and the least recently used node is evicted, whatever
+ * its file, so that the hot histories get most of the memory.
+ *
+ * A shared node cache and its views may be used from many threads.
+ * Nodes are loaded from their owners outside of the internal lock.
+ *
+ * A shared node cache must be owned by a shared pointer (views keep it
+ * alive).
+ *
+ * @author Philippe Proulx
+ */
+class SharedNodeCache :
+    public std::enable_shared_from_this<SharedNodeCache>
+{
+public:
+    /// Shared pointer to shared node cache
+    typedef std::shared_ptr<SharedNodeCache> SP;
+
+    /**
+     * View of a shared node cache, used by one owner.
+     *
+     * The cache statistics of a view only count its hits, misses and
+     * bytes loaded; see SharedNodeCache::getStats() for the global
+     * occupancy and evictions. Invalidating a view drops the nodes of
+     * its file from the shared cache, and so does destroying the last
+     * view of a file.
+     */
+    class View :
+        public AbstractNodeCache
+    {
+        friend class SharedNodeCache;
+
+    public:
+        virtual ~View();
+
+    protected:
+        Node::SP getNodeImpl(node_seq_t seqNumber);
+        bool nodeIsCachedImpl(node_seq_t seqNumber) const;
+        void invalidateImpl();
+        bool putNodeImpl(node_seq_t seqNumber, Node::SP node);
+        Node::SP peekNodeImpl(node_seq_t seqNumber) const;
+        void addBytesLoadedImpl(std::uint64_t size);
+
+    private:
+        View(SharedNodeCache::SP cache, std::uint32_t fileId);
+
+        Node::SP loadNode(node_seq_t seqNumber)
+        {
+            return this->getNodeFromOwner(seqNumber);
+        }
+
+    private:
+        SharedNodeCache::SP _cache;
+        std::uint32_t _fileId;
+    };
+
+public:
+    /**
+     * Builds a shared node cache.
+     *
+     * @param size       Size of cache (node count, all owners)
+     * @param byteBudget Maximum memory size of cached nodes (bytes, all
+     *                   owners), or 0 for no limit
+     */
+    SharedNodeCache(std::size_t size, std::size_t byteBudget = 0);
+
+    /**
+     * Creates a new view of this shared cache for a new owner of the
+     * history file \p path. Pass it to HistoryFileSource::open(), for
+     * example. Views of the same file (same canonical path) share their
+     * cached nodes.
+     *
+     * @param path Path to existing history file of the new owner
+     * @returns    New view
+     */
+    std::shared_ptr<AbstractNodeCache> createView(const boost::filesystem::path& path);
+
+    /**
+     * Creates a new view of this shared cache for a new owner of its
+     * own, sharing its cached nodes with no other view.
+     *
+     * @returns New view
+     */
+    std::shared_ptr<AbstractNodeCache> createView();
+
+    /**
+     * Returns the size of this cache.
+     *
+     * @returns Size of this cache (number of nodes, all owners)
+     */
+    std::size_t getSize() const
+    {
+        return _size;
+    }
+
+    /**
+     * Returns the byte budget of this cache.
+     *
+     * @returns Maximum memory size of cached nodes (bytes), or 0 if
+     *          there's no limit
+     */
+    std::size_t getByteBudget() const
+    {
+        return _byteBudget;
+    }
+
+    /**
+     * Returns the current statistics of this cache, all owners
+     * included.
+     *
+     * @returns Statistics
+     */
+    NodeCacheStats getStats() const;
+
+private:
+    struct Entry
+    {
+        // file ID and sequence number
+        std::uint64_t key;
+
+        // cached node
+        Node::SP node;
+
+        // memory size of cached node
+        std::size_t memorySize;
+    };
+
+    typedef std::list<Entry> EntryList;
+
+    struct File
+    {
+        // canonical path, or empty for a view of its own
+        std::string path;
+
+        // number of views of this file
+        std::size_t viewCount;
+
+        // sequence numbers of the cached nodes of this file
+        std::unordered_set<node_seq_t> seqNumbers;
+    };
+
+private:
+    static std::uint64_t makeKey(std::uint32_t fileId, node_seq_t seqNumber)
+    {
+        return (static_cast<std::uint64_t>(fileId) << 32) | seqNumber;
+    }
+
+    static std::uint32_t getFileId(std::uint64_t key)
+    {
+        return static_cast<std::uint32_t>(key >> 32);
+    }
+
+    std::shared_ptr<AbstractNodeCache> createFileView(const std::string& path);
+    Node::SP getNode(View& view, node_seq_t seqNumber);
+    bool putNode(std::uint32_t fileId, node_seq_t seqNumber, Node::SP node);
+    bool insertNode(std::uint64_t key, Node::SP node, std::size_t memorySize);
+    bool nodeIsCached(std::uint32_t fileId, node_seq_t seqNumber) const;
+    Node::SP peekNode(std::uint32_t fileId, node_seq_t seqNumber) const;
+    void addBytesLoaded(std::uint64_t size);
+    void removeFileNodes(std::uint32_t fileId);
+    void invalidateFile(std::uint32_t fileId);
+    void releaseFile(std::uint32_t fileId);
+    bool exceedsByteBudget(std::size_t memorySize) const;
+    void removeEntry(EntryList::iterator it);
+
+private:
+    // capacity
+    std::size_t _size;
+    std::size_t _byteBudget;
+
+    // next file ID
+    std::uint32_t _nextFileId;
+
+    // files with views, and IDs of files by canonical path
+    std::unordered_map<std::uint32_t, File> _files;
+    std::unordered_map<std::string, std::uint32_t> _fileIds;
+
+    // entries (most recently used first) and their locations
+    EntryList _list;
+    std::unordered_map<std::uint64_t, EntryList::iterator> _map;
+
+    // global statistics
+    NodeCacheStats _stats;
+
+    // protects everything above
+    mutable std::mutex _mutex;
+};
+
+}
+
+#endif // _SHAREDNODECACHE_HPP
@@ -0,0 +1,119 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TWOQUEUENODECACHE_HPP
+#define _TWOQUEUENODECACHE_HPP
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+
+#include <delorean/node/AbstractNodeCache.hpp>
+#include <delorean/node/Node.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+/**
+ * 2Q node cache (Johnson and Shasha). This cache resists scans: a node
+ * accessed only once never evicts the frequently used nodes.
+ *
+ * A newly loaded node first enters a FIFO queue (A1in) which holds
+ * about a quarter of the cache. When it's evicted from there, only its
+ * sequence number is remembered in a ghost queue (A1out). If it's
+ * accessed again while remembered, it's admitted into the main LRU
+ * queue (Am). Thus the ghost queue acts as an admission filter for the
+ * main queue: a long scan only flows through A1in and A1out.
+ *
+ * This cache supports a byte budget: nodes are also evicted to keep the
+ * memory size of cached nodes within the budget. A node larger than the
+ * whole budget is never cached.
+ *
+ * @author Philippe Proulx
+ */
+class TwoQueueNodeCache :
+    public AbstractNodeCache
+{
+public:
+    /**
+     * Builds a 2Q node cache.
+     *
+     * @param size       Size of cache (node count)
+     * @param byteBudget Maximum memory size of cached nodes (bytes), or
+     *                   0 for no limit
+     */
+    TwoQueueNodeCache(std::size_t size, std::size_t byteBudget = 0);
+
+protected:
+    Node::SP getNodeImpl(node_seq_t seqNumber);
+    bool nodeIsCachedImpl(node_seq_t seqNumber) const;
+    void invalidateImpl();
+    bool putNodeImpl(node_seq_t seqNumber, Node::SP node);
+    Node::SP peekNodeImpl(node_seq_t seqNumber) const;
+
+private:
+    enum class Queue
+    {
+        IN,
+        OUT,
+        MAIN,
+    };
+
+    struct Entry
+    {
+        // sequence number
+        node_seq_t seqNumber;
+
+        // cached node (`nullptr` in the ghost queue)
+        Node::SP node;
+
+        // memory size of cached node
+        std::size_t memorySize;
+    };
+
+    typedef std::list<Entry> EntryList;
+
+    struct Location
+    {
+        Queue queue;
+        EntryList::iterator it;
+    };
+
+private:
+    EntryList& getList(Queue queue);
+    void moveToFront(Location& location, Queue queue);
+    void evictOne();
+    bool makeRoom(std::size_t memorySize);
+
+private:
+    // maximum sizes of A1in and A1out
+    std::size_t _inSize;
+    std::size_t _outSize;
+
+    // queues (most recent first)
+    EntryList _inList;
+    EntryList _outList;
+    EntryList _mainList;
+
+    // locations of all entries
+    std::unordered_map<node_seq_t, Location> _locations;
+};
+
+}
+
+#endif // _TWOQUEUENODECACHE_HPP
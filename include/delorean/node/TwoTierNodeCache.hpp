@@ -0,0 +1,193 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TWOTIERNODECACHE_HPP
+#define _TWOTIERNODECACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <list>
+#include <unordered_map>
+
+#include <delorean/node/AbstractNodeCache.hpp>
+#include <delorean/node/AbstractNodeSerDes.hpp>
+#include <delorean/node/Node.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+/**
+ * Two-tier node cache: a small LRU tier of decoded nodes backed by a
+ * large LRU tier of serialized node images.
+ *
+ * A decoded node is several times larger than its serialized image.
+ * When a node is evicted from the decoded tier, it's serialized again
+ * and its image is demoted to the raw tier instead of being dropped.
+ * Getting a node found in the raw tier promotes it back to the decoded
+ * tier: it only needs to be deserialized, without asking the owner
+ * (no I/O). Both tiers are exclusive: a node is in one of them at most.
+ *
+ * Raw images may be compacted (enabled by default): the longest run of
+ * zero bytes of an image (usually the free space between the fixed
+ * and the variable parts of a node) is not stored.
+ *
+ * The size and the byte budget of this cache (see AbstractNodeCache)
+ * apply to the decoded tier; the raw tier has its own byte budget. A
+ * promotion counts as a hit in the cache statistics.
+ *
+ * @author Philippe Proulx
+ */
+class TwoTierNodeCache :
+    public AbstractNodeCache
+{
+public:
+    /**
+     * Builds a two-tier node cache.
+     *
+     * @param size          Size of decoded tier (node count)
+     * @param rawByteBudget Maximum memory size of raw images (bytes), or
+     *                      0 for no raw tier
+     * @param byteBudget    Maximum memory size of decoded nodes (bytes),
+     *                      or 0 for no limit
+     */
+    TwoTierNodeCache(std::size_t size, std::size_t rawByteBudget,
+                     std::size_t byteBudget = 0);
+
+    /**
+     * Returns the byte budget of the raw tier.
+     *
+     * @returns Maximum memory size of raw images (bytes)
+     */
+    std::size_t getRawByteBudget() const
+    {
+        return _rawByteBudget;
+    }
+
+    /**
+     * Returns the current memory size of the raw tier.
+     *
+     * @returns Memory size of raw images (bytes)
+     */
+    std::size_t getRawMemorySize() const
+    {
+        return _rawMemorySize;
+    }
+
+    /**
+     * Returns the current number of nodes in the raw tier.
+     *
+     * @returns Number of raw images
+     */
+    std::size_t getRawNodeCount() const
+    {
+        return _rawList.size();
+    }
+
+    /**
+     * Returns the number of promotions from the raw tier so far.
+     *
+     * @returns Number of promotions
+     */
+    std::uint64_t getPromotionCount() const
+    {
+        return _promotions;
+    }
+
+    /**
+     * Enables or disables the compaction of raw images (enabled by
+     * default). This only applies to images demoted afterwards.
+     *
+     * @param enabled True to enable compaction
+     */
+    void setRawCompactionEnabled(bool enabled)
+    {
+        _rawCompactionEnabled = enabled;
+    }
+
+protected:
+    Node::SP getNodeImpl(node_seq_t seqNumber);
+    bool nodeIsCachedImpl(node_seq_t seqNumber) const;
+    void invalidateImpl();
+    bool putNodeImpl(node_seq_t seqNumber, Node::SP node);
+    Node::SP peekNodeImpl(node_seq_t seqNumber) const;
+
+private:
+    struct Entry
+    {
+        // sequence number
+        node_seq_t seqNumber;
+
+        // decoded node
+        Node::SP node;
+
+        // memory size of decoded node
+        std::size_t memorySize;
+    };
+
+    struct RawEntry
+    {
+        // sequence number
+        node_seq_t seqNumber;
+
+        // serialized image, without its elided zero bytes
+        std::vector<std::uint8_t> image;
+
+        // offset and size of the elided zero bytes within the image
+        std::size_t gapOffset;
+        std::size_t gapSize;
+
+        // what's needed to deserialize the image
+        const AbstractNodeSerDes* serdes;
+        std::size_t maxChildren;
+    };
+
+    typedef std::list<Entry> EntryList;
+    typedef std::list<RawEntry> RawEntryList;
+
+private:
+    void insertDecoded(node_seq_t seqNumber, Node::SP node);
+    void demote(const Entry& entry);
+    Node::SP promote(RawEntryList::iterator it);
+    static Node::SP decodeRaw(const RawEntry& rawEntry);
+    void dropRaw(RawEntryList::iterator it);
+
+    static std::size_t getRawMemorySize(const RawEntry& entry)
+    {
+        return sizeof(entry) + entry.image.size();
+    }
+
+private:
+    // decoded tier (most recently used first)
+    EntryList _list;
+    std::unordered_map<node_seq_t, EntryList::iterator> _map;
+
+    // raw tier (most recently used first)
+    RawEntryList _rawList;
+    std::unordered_map<node_seq_t, RawEntryList::iterator> _rawMap;
+    std::size_t _rawByteBudget;
+    std::size_t _rawMemorySize;
+    bool _rawCompactionEnabled;
+
+    // number of promotions
+    std::uint64_t _promotions;
+};
+
+}
+
+#endif // _TWOTIERNODECACHE_HPP
@@ -0,0 +1,219 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <numeric>
+#include <cstddef>
+
+#include <delorean/HistoryCursor.hpp>
+#include <delorean/HistoryFileSource.hpp>
+#include <delorean/NodePrefetcher.hpp>
+#include <delorean/node/Node.hpp>
+#include <delorean/interval/AbstractInterval.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+HistoryCursor::HistoryCursor(HistoryFileSource& source) :
+    _source (source),
+    _ts {0},
+    _isPositioned {false},
+    _prefetcher {nullptr},
+    _prefetchedTs {0}
+{
+}
+
+void HistoryCursor::moveTo(timestamp_t ts)
+{
+    _source.validateQuery(ts);
+
+    if (_isPositioned && ts == _ts) {
+        return;
+    }
+
+    // find the first level of which the node doesn't contain `ts`
+    std::size_t crossedIndex = 0;
+    if (_isPositioned) {
+        while (crossedIndex < _levels.size() &&
+                this->nodeContains(*_levels[crossedIndex].node, ts)) {
+            crossedIndex++;
+        }
+    }
+
+    /* Forget intervals of crossed nodes first: they're all intersecting
+     * the current timestamp.
+     */
+    this->leaveLevelsFrom(crossedIndex);
+
+    // nodes still containing `ts`: update what changed in between
+    for (const auto& level : _levels) {
+        this->moveWithinLevel(level, ts);
+    }
+
+    // draw the rest of the branch down to the deepest node
+    Node::SP node;
+    if (_levels.empty()) {
+        node = _source.getRootNode();
+    } else {
+        node = _source.getChildNodeAtTs(*_levels.back().node, ts,
+                                        _levels.size());
+    }
+
+    auto forward = !_isPositioned || ts > _ts;
+    _ts = ts;
+    _isPositioned = true;
+
+    while (node) {
+        this->enterNode(node);
+        node = _source.getChildNodeAtTs(*node, ts, _levels.size());
+    }
+
+    if (_prefetcher) {
+        this->prefetchNextLeaf(forward);
+    }
+}
+
+void HistoryCursor::prefetchNextLeaf(bool forward)
+{
+    // the next leaf begins where the current one ends (or vice versa)
+    const auto& leaf = *_levels.back().node;
+    auto ts = forward ? leaf.getEnd() : leaf.getBegin() - 1;
+
+    if (ts < _source.getBegin() || ts >= _source.getEnd() ||
+            ts == _prefetchedTs) {
+        return;
+    }
+
+    _prefetcher->prefetchBranch(ts);
+    _prefetchedTs = ts;
+}
+
+void HistoryCursor::enterNode(Node::SP node)
+{
+    // add intervals intersecting the new current timestamp
+    const auto& intervals = node->getIntervals();
+    for (const auto& interval : intervals) {
+        if (interval->intersects(_ts)) {
+            this->addInterval(interval);
+        }
+    }
+
+    // index intervals by begin timestamp
+    Level level;
+    level.byBegin.resize(intervals.size());
+    std::iota(level.byBegin.begin(), level.byBegin.end(), 0);
+    std::sort(level.byBegin.begin(), level.byBegin.end(),
+              [&intervals] (std::size_t a, std::size_t b) {
+        return intervals[a]->getBegin() < intervals[b]->getBegin();
+    });
+    level.node = std::move(node);
+    _levels.push_back(std::move(level));
+}
+
+void HistoryCursor::leaveLevelsFrom(std::size_t index)
+{
+    for (auto it = _levels.begin() + index; it != _levels.end(); ++it) {
+        for (const auto& interval : it->node->getIntervals()) {
+            if (interval->intersects(_ts)) {
+                this->removeInterval(interval);
+            }
+        }
+    }
+
+    _levels.resize(index);
+}
+
+void HistoryCursor::moveWithinLevel(const Level& level, timestamp_t ts)
+{
+    /* Only intervals ending or beginning within (lo, hi] may intersect
+     * one of `lo` and `hi` but not the other:
+     *
+     *   * Intervals ending within (lo, hi] and beginning at or before
+     *     `lo` intersect `lo` only.
+     *   * Intervals beginning within (lo, hi] and ending after `hi`
+     *     intersect `hi` only.
+     *
+     * Moving forward, the former are removed and the latter are added;
+     * moving backward, it's the opposite.
+     */
+    auto forward = ts > _ts;
+    auto lo = std::min(_ts, ts);
+    auto hi = std::max(_ts, ts);
+    const auto& intervals = level.node->getIntervals();
+
+    // intervals ending within (lo, hi] (sorted by end timestamp)
+    auto endCompare = [] (timestamp_t ts, const AbstractInterval::SP& interval) {
+        return ts < interval->getEnd();
+    };
+    auto endIt = std::upper_bound(intervals.begin(), intervals.end(), lo,
+                                  endCompare);
+    auto endItEnd = std::upper_bound(endIt, intervals.end(), hi,
+                                     endCompare);
+
+    for (; endIt != endItEnd; ++endIt) {
+        const auto& interval = *endIt;
+
+        if (interval->getBegin() <= lo) {
+            if (forward) {
+                this->removeInterval(interval);
+            } else {
+                this->addInterval(interval);
+            }
+        }
+    }
+
+    // intervals beginning within (lo, hi] (sorted by begin timestamp)
+    auto beginCompare = [&intervals] (timestamp_t ts, std::size_t index) {
+        return ts < intervals[index]->getBegin();
+    };
+    auto beginIt = std::upper_bound(level.byBegin.begin(),
+                                    level.byBegin.end(), lo, beginCompare);
+    auto beginItEnd = std::upper_bound(beginIt, level.byBegin.end(), hi,
+                                       beginCompare);
+
+    for (; beginIt != beginItEnd; ++beginIt) {
+        const auto& interval = intervals[*beginIt];
+
+        if (interval->getEnd() > hi) {
+            if (forward) {
+                this->addInterval(interval);
+            } else {
+                this->removeInterval(interval);
+            }
+        }
+    }
+}
+
+void HistoryCursor::addInterval(const AbstractInterval::SP& interval)
+{
+    _intervals[interval->getKey()] = interval;
+}
+
+void HistoryCursor::removeInterval(const AbstractInterval::SP& interval)
+{
+    /* Another interval having the same key could already have replaced
+     * this one (coming from another level): only remove this very one.
+     */
+    auto it = _intervals.find(interval->getKey());
+
+    if (it != _intervals.end() && it->second == interval) {
+        _intervals.erase(it);
+    }
+}
+
+}
@@ -28,8 +28,16 @@
 #include <delorean/interval/AbstractInterval.hpp>
 #include <delorean/node/Node.hpp>
 #include <delorean/node/NodeSerDesType.hpp>
+#include <delorean/interval/StringInterval.hpp>
+#include <delorean/interval/DictionaryStringInterval.hpp>
+#include <delorean/interval/StandardIntervalType.hpp>
 #include <delorean/node/AlignedNodeSerDes.hpp>
+#include <delorean/node/CompactNodeSerDes.hpp>
+#include <delorean/node/CompressedNodeSerDes.hpp>
+#include <delorean/node/ColumnarNodeSerDes.hpp>
+#include <delorean/node/Crc32c.hpp>
 #include <delorean/ex/IO.hpp>
+#include <delorean/ex/NodeFull.hpp>
 #include <delorean/ex/IntervalOutOfRange.hpp>
 #include <delorean/ex/TimestampOutOfRange.hpp>
 #include <delorean/ex/UnknownNodeSerDesType.hpp>
@@ -40,7 +48,21 @@ namespace bfs = boost::filesystem;
 namespace delo
 {
 
-HistoryFileSink::HistoryFileSink()
+HistoryFileSink::HistoryFileSink() :
+    _nodeExtensionEnabled {false},
+    _extendNodes {false},
+    _packNodes {false},
+    _nodeDataEnd {0},
+    _nodeIndexOffset {0},
+    _stringDictionaryEnabled {false},
+    _stringDictionaryOffset {0},
+    _stringDictionarySize {0},
+    _nodeChecksumsEnabled {false},
+    _checksumNodes {false},
+    _nodeChecksumsOffset {0},
+    _nodeDirectoryEnabled {true},
+    _writeNodeDirectory {false},
+    _nodeDirectoryOffset {0}
 {
 }
 
@@ -64,6 +86,30 @@ void HistoryFileSink::open(const bfs::path& path, std::size_t nodeSize,
         AbstractNodeSerDes::UP nodeSerdes {new AlignedNodeSerDes {}};
         this->setNodeSerDes(std::move(nodeSerdes));
         _magic = HistoryFileHeader::MAGIC_ALIGNED_NODE_SERDES;
+    } else if (serdesType == NodeSerDesType::COMPACT) {
+        AbstractNodeSerDes::UP nodeSerdes {new CompactNodeSerDes {}};
+        this->setNodeSerDes(std::move(nodeSerdes));
+        _magic = HistoryFileHeader::MAGIC_COMPACT_NODE_SERDES;
+    } else if (serdesType == NodeSerDesType::COMPRESSED) {
+        AbstractNodeSerDes::UP nodeSerdes {new CompressedNodeSerDes {}};
+        this->setNodeSerDes(std::move(nodeSerdes));
+        _magic = HistoryFileHeader::MAGIC_COMPRESSED_NODE_SERDES;
+    } else if (serdesType == NodeSerDesType::COLUMNAR) {
+        AbstractNodeSerDes::UP nodeSerdes {new ColumnarNodeSerDes {}};
+        this->setNodeSerDes(std::move(nodeSerdes));
+        _magic = HistoryFileHeader::MAGIC_COLUMNAR_NODE_SERDES;
+    } else if (serdesType == NodeSerDesType::ALIGNED_RELATIVE) {
+        AbstractNodeSerDes::UP nodeSerdes {new AlignedNodeSerDes {true}};
+        this->setNodeSerDes(std::move(nodeSerdes));
+        _magic = HistoryFileHeader::MAGIC_ALIGNED_RELATIVE_NODE_SERDES;
+    } else if (serdesType == NodeSerDesType::ALIGNED_WIDE) {
+        AbstractNodeSerDes::UP nodeSerdes {new AlignedNodeSerDes {false, true}};
+        this->setNodeSerDes(std::move(nodeSerdes));
+        _magic = HistoryFileHeader::MAGIC_ALIGNED_WIDE_NODE_SERDES;
+    } else if (serdesType == NodeSerDesType::ALIGNED_WIDE_RELATIVE) {
+        AbstractNodeSerDes::UP nodeSerdes {new AlignedNodeSerDes {true, true}};
+        this->setNodeSerDes(std::move(nodeSerdes));
+        _magic = HistoryFileHeader::MAGIC_ALIGNED_WIDE_RELATIVE_NODE_SERDES;
     } else {
         throw ex::UnknownNodeSerDesType(serdesType);
     }
@@ -77,6 +123,32 @@ void HistoryFileSink::open(const bfs::path& path, std::size_t nodeSize,
     // clear latest branch (this will also free contained nodes)
     _latestBranch.clear();
 
+    /* Compressed and extended nodes are stored back to back, located by
+     * an index.
+     */
+    _extendNodes = _nodeExtensionEnabled;
+    _packNodes = (serdesType == NodeSerDesType::COMPRESSED) || _extendNodes;
+    _nodeIndex.clear();
+    _nodeDataEnd = HistoryFileHeader::SIZE;
+    _nodeIndexOffset = 0;
+
+    // new string dictionary, if needed
+    _stringDictionary.reset();
+    _stringDictionaryOffset = 0;
+    _stringDictionarySize = 0;
+
+    if (_stringDictionaryEnabled) {
+        _stringDictionary = std::make_shared<StringDictionary>();
+    }
+
+    // node checksums are only known once nodes are committed
+    _checksumNodes = _nodeChecksumsEnabled;
+    _nodeChecksums.clear();
+    _nodeChecksumsOffset = 0;
+    _writeNodeDirectory = _nodeDirectoryEnabled;
+    _nodeDirectory.clear();
+    _nodeDirectoryOffset = 0;
+
     // set/reset attributes
     this->setPath(path);
     this->setNodeSize(nodeSize);
@@ -101,15 +173,101 @@ void HistoryFileSink::writeHeader()
     // prepare header
     HistoryFileHeader header;
     header.magic = static_cast<uint32_t>(_magic);
+
+    if (_extendNodes) {
+        header.magic |= HistoryFileHeader::MAGIC_EXTENSION_NODES_MASK;
+    }
+
+    if (_stringDictionary) {
+        header.magic |= HistoryFileHeader::MAGIC_STRING_DICTIONARY_MASK;
+    }
+
     header.nodeSize = this->getNodeSize();
     header.maxChildren = this->getMaxChildren();
     header.nodeCount = this->getNodeCount();
     header.rootNodeSeqNumber = this->getRootNodeSeqNumber();
+    header.nodeIndexOffset = _nodeIndexOffset;
+    header.stringDictionaryOffset = _stringDictionaryOffset;
+    header.stringDictionarySize = _stringDictionarySize;
+    header.nodeChecksumsOffset = _nodeChecksumsOffset;
+    header.nodeDirectoryOffset = _nodeDirectoryOffset;
 
     // write header
     _outputStream.write(reinterpret_cast<char*>(&header), sizeof(header));
 }
 
+void HistoryFileSink::writeNodeIndex()
+{
+    _nodeIndex.resize(this->getNodeCount());
+    _nodeIndexOffset = _nodeDataEnd;
+    _outputStream.seekp(_nodeIndexOffset);
+    _outputStream.write(reinterpret_cast<char*>(_nodeIndex.data()),
+                        _nodeIndex.size() * sizeof(NodeIndexEntry));
+}
+
+void HistoryFileSink::writeStringDictionary()
+{
+    std::vector<std::uint8_t> buf;
+    _stringDictionary->serialize(buf);
+    _outputStream.seekp(0, std::ios::end);
+    _stringDictionaryOffset = _outputStream.tellp();
+    _stringDictionarySize = buf.size();
+    _outputStream.write(reinterpret_cast<char*>(buf.data()), buf.size());
+}
+
+void HistoryFileSink::writeNodeChecksums()
+{
+    _nodeChecksums.resize(this->getNodeCount());
+    _outputStream.seekp(0, std::ios::end);
+    _nodeChecksumsOffset = _outputStream.tellp();
+    _outputStream.write(reinterpret_cast<char*>(_nodeChecksums.data()),
+                        _nodeChecksums.size() * sizeof(std::uint32_t));
+}
+
+void HistoryFileSink::writeNodeDirectory()
+{
+    _nodeDirectory.resize(this->getNodeCount());
+
+    /* Levels are only known now: the tree grows from the top when a new
+     * root is added. A parent may also have a greater sequence number
+     * than its child, so resolve the level of each chain of ancestors.
+     */
+    const auto rootParent = Node::ROOT_PARENT_SEQ_NUMBER();
+    const auto unknownLevel = static_cast<uint32_t>(-1);
+    std::vector<node_seq_t> chain;
+
+    for (auto& entry : _nodeDirectory) {
+        entry.level = unknownLevel;
+    }
+
+    for (node_seq_t seq = 0; seq < _nodeDirectory.size(); ++seq) {
+        auto current = seq;
+
+        chain.clear();
+
+        while (current != rootParent && current < _nodeDirectory.size() &&
+                _nodeDirectory[current].level == unknownLevel) {
+            chain.push_back(current);
+            current = _nodeDirectory[current].parentSeqNumber;
+        }
+
+        uint32_t level = 0;
+
+        if (current != rootParent && current < _nodeDirectory.size()) {
+            level = _nodeDirectory[current].level + 1;
+        }
+
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            _nodeDirectory[*it].level = level++;
+        }
+    }
+
+    _outputStream.seekp(0, std::ios::end);
+    _nodeDirectoryOffset = _outputStream.tellp();
+    _outputStream.write(reinterpret_cast<char*>(_nodeDirectory.data()),
+                        _nodeDirectory.size() * sizeof(NodeDirectoryEntry));
+}
+
 void HistoryFileSink::close(timestamp_t end)
 {
     if (!this->isOpened()) {
@@ -125,6 +283,26 @@ void HistoryFileSink::close(timestamp_t end)
     // close latest branch
     this->commitNodesDownFromIndex(0);
 
+    // write node index after all the nodes, if needed
+    if (_packNodes) {
+        this->writeNodeIndex();
+    }
+
+    // write string dictionary at the end, if needed
+    if (_stringDictionary) {
+        this->writeStringDictionary();
+    }
+
+    // write node checksums at the end, if needed
+    if (_checksumNodes) {
+        this->writeNodeChecksums();
+    }
+
+    // write node directory at the end, if needed
+    if (_writeNodeDirectory) {
+        this->writeNodeDirectory();
+    }
+
     // write header now
     this->writeHeader();
 
@@ -155,6 +333,30 @@ void HistoryFileSink::addInterval(AbstractInterval::SP interval)
         };
     }
 
+    /* Dictionary-encode standard string interval (not a subclass with
+     * its own type), unless already encoded with this dictionary.
+     */
+    auto stringType = static_cast<interval_type_t>(StandardIntervalType::STRING);
+
+    if (_stringDictionary && interval->getType() == stringType) {
+        auto dictInterval =
+            dynamic_cast<const DictionaryStringInterval*>(interval.get());
+
+        if (!dictInterval ||
+                dictInterval->getDictionary() != _stringDictionary.get()) {
+            const auto& strInterval =
+                static_cast<const StringInterval&>(*interval);
+            DictionaryStringInterval::SP encoded {new DictionaryStringInterval {
+                interval->getBegin(),
+                interval->getEnd(),
+                interval->getKey(),
+                _stringDictionary
+            }};
+            encoded->setValue(strInterval.getValue());
+            interval = encoded;
+        }
+    }
+
     // try inserting it in current leaf node
     this->tryAddIntervalToNode(interval, _latestBranch.size() - 1);
 
@@ -203,10 +405,24 @@ void HistoryFileSink::tryAddIntervalToNode(AbstractInterval::SP intr,
 
     // does this interval fits the target node?
     if (!targetNode->intervalFits(*intr)) {
-        // nope: add to a new leaf sibling instead
-        this->addSiblingNode(index);
-        this->tryAddIntervalToNode(intr, _latestBranch.size() - 1);
-        return;
+        if (targetNode->getIntervalCount() > 0) {
+            // nope: add to a new leaf sibling instead
+            this->addSiblingNode(index);
+            this->tryAddIntervalToNode(intr, _latestBranch.size() - 1);
+            return;
+        }
+
+        // not even in an empty node: is it for an ancestor?
+        if (intr->getBegin() < targetNode->getBegin()) {
+            this->tryAddIntervalToNode(intr, index - 1);
+            return;
+        }
+
+        if (!_extendNodes) {
+            throw ex::NodeFull();
+        }
+
+        this->extendNode(*targetNode, *intr);
     }
 
     // make sure the interval time range fits the target node
@@ -220,6 +436,14 @@ void HistoryFileSink::tryAddIntervalToNode(AbstractInterval::SP intr,
     targetNode->addInterval(intr);
 }
 
+void HistoryFileSink::extendNode(Node& node, const AbstractInterval& intr)
+{
+    // add node-sized extension pages until the interval fits
+    while (!node.intervalFits(intr)) {
+        node.extend(node.getSize() + this->getNodeSize());
+    }
+}
+
 void HistoryFileSink::addSiblingNode(std::size_t index)
 {
     /* We're in a situation like this (latest branch):
@@ -317,19 +541,69 @@ void HistoryFileSink::addSiblingNode(std::size_t index)
 
 void HistoryFileSink::commitNode(Node& node)
 {
-    // seek output stream to the right offset
-    _outputStream.seekp(HistoryFileHeader::SIZE +
-                        this->getNodeSize() * node.getSeqNumber());
-
     // close node with this tree's end
     node.close(this->getEnd());
 
-    // serialize node to buffer
-    this->getNodeSerDes().serializeNode(node, _nodeBuf.get());
+    // summarize node in directory, if needed
+    auto seqNumber = node.getSeqNumber();
+
+    if (_writeNodeDirectory) {
+        if (seqNumber >= _nodeDirectory.size()) {
+            _nodeDirectory.resize(seqNumber + 1);
+        }
+
+        auto& dirEntry = _nodeDirectory[seqNumber];
+        dirEntry.begin = node.getBegin();
+        dirEntry.end = node.getEnd();
+        dirEntry.parentSeqNumber = node.getParentSeqNumber();
+        dirEntry.intervalCount =
+            static_cast<uint32_t>(node.getIntervalCount());
+    }
+
+    // serialize node to buffer (larger one for an extended node)
+    std::vector<std::uint8_t> extendedBuf;
+    auto buf = _nodeBuf.get();
+    auto size = node.getSize();
+
+    if (node.isExtended()) {
+        extendedBuf.resize(size);
+        buf = extendedBuf.data();
+    }
+
+    const auto& serdes = this->getNodeSerDes();
+    serdes.serializeNode(node, buf);
+
+    if (_packNodes) {
+        // append node after the last one and remember where it is
+        size = serdes.getSerializedSize(buf, size);
+
+        if (seqNumber >= _nodeIndex.size()) {
+            _nodeIndex.resize(seqNumber + 1);
+        }
+
+        _nodeIndex[seqNumber].offset = _nodeDataEnd;
+        _nodeIndex[seqNumber].size = static_cast<uint32_t>(size);
+        _nodeIndex[seqNumber].extendedSize =
+            node.isExtended() ? static_cast<uint32_t>(node.getSize()) : 0;
+        _outputStream.seekp(_nodeDataEnd);
+        _nodeDataEnd += size;
+    } else {
+        // seek output stream to the right offset
+        _outputStream.seekp(HistoryFileHeader::SIZE +
+                            size * seqNumber);
+    }
+
+    // checksum of the stored bytes, if needed
+    if (_checksumNodes) {
+        if (seqNumber >= _nodeChecksums.size()) {
+            _nodeChecksums.resize(seqNumber + 1);
+        }
+
+        _nodeChecksums[seqNumber] = Crc32c::compute(buf, size);
+    }
 
     // write buffer
-    _outputStream.write(reinterpret_cast<char*>(_nodeBuf.get()),
-                        this->getNodeSize());
+    _outputStream.write(reinterpret_cast<char*>(buf), size);
 }
 
 void HistoryFileSink::commitNodesDownFromIndex(std::size_t index)
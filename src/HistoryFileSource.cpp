@@ -19,13 +19,37 @@
 #include <memory>
 #include <functional>
 #include <fstream>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
+#include <stdexcept>
+#include <iterator>
+#include <cstdint>
+#include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 
 #include <delorean/node/AbstractNodeCache.hpp>
 #include <delorean/node/PassThroughNodeCache.hpp>
+#include <delorean/node/DirectMappedNodeCache.hpp>
+#include <delorean/node/LruNodeCache.hpp>
+#include <delorean/node/TwoQueueNodeCache.hpp>
+#include <delorean/node/ArcNodeCache.hpp>
+#include <delorean/node/NodeCacheType.hpp>
 #include <delorean/node/AlignedNodeSerDes.hpp>
+#include <delorean/node/CompactNodeSerDes.hpp>
+#include <delorean/node/CompressedNodeSerDes.hpp>
+#include <delorean/node/ColumnarNodeSerDes.hpp>
+#include <delorean/node/Crc32c.hpp>
+#include <delorean/interval/StringDictionary.hpp>
+#include <delorean/interval/DictionaryStringIntervalFactory.hpp>
+#include <delorean/interval/StandardIntervalType.hpp>
 #include <delorean/ex/TimestampOutOfRange.hpp>
 #include <delorean/ex/IO.hpp>
+#include <delorean/ex/CorruptedNode.hpp>
 #include <delorean/AbstractHistory.hpp>
 #include <delorean/HistoryFileSource.hpp>
 
@@ -34,7 +58,19 @@ namespace bfs = boost::filesystem;
 namespace delo
 {
 
-HistoryFileSource::HistoryFileSource()
+HistoryFileSource::HistoryFileSource() :
+    _pinnedLevelCount {0},
+    _pinnedByteBudget {0},
+    _pinnedMemorySize {0},
+    _warmUpLevelCount {0},
+    _warmUpBegin {0},
+    _warmUpEnd {0},
+    _warmUpWorkerCount {1},
+    _warmingUp {false},
+    _warmUpStopped {false},
+    _accessLogRecording {false},
+    _accessLogPreload {false},
+    _fileSize {0}
 {
 }
 
@@ -58,8 +94,15 @@ void HistoryFileSource::open(const boost::filesystem::path& path,
         throw ex::IO("History file is too small");
     }
 
+    _fileSize = static_cast<std::uint64_t>(_inputStream.tellg());
+
     // read header
-    this->readHeader();
+    try {
+        this->readHeader();
+    } catch (...) {
+        _inputStream.close();
+        throw;
+    }
 
     /* Allocate new buffer for node deserialization (reallocating because
      * its size could have changed).
@@ -74,7 +117,7 @@ void HistoryFileSource::open(const boost::filesystem::path& path,
             new PassThroughNodeCache
         };
     }
-    auto getNodeFromOwnerCb = std::bind(&HistoryFileSource::getNode, this,
+    auto getNodeFromOwnerCb = std::bind(&HistoryFileSource::loadNode, this,
                                         std::placeholders::_1);
     nodeCache->setGetNodeFromOwnerCb(getNodeFromOwnerCb);
     _nodeCache = nodeCache;
@@ -83,10 +126,82 @@ void HistoryFileSource::open(const boost::filesystem::path& path,
     this->setPath(path);
     this->setOpened(true);
 
+    // pin upper levels (before any node gets cached)
+    this->pinUpperLevels();
+
     // get root node now to set begin/end
     auto node = this->getRootNode();
     this->setBegin(node->getBegin());
     this->setEnd(node->getEnd());
+
+    // record accesses if needed
+    if (_accessLogRecording && !_accessLogPath.empty()) {
+        _accessCounts.assign(this->getNodeCount(), 0);
+
+        // older accesses count half as much as the new ones
+        if (!this->readAccessLog(_accessLogBaseCounts)) {
+            _accessLogBaseCounts.assign(this->getNodeCount(), 0);
+        }
+
+        for (auto& count : _accessLogBaseCounts) {
+            count /= 2;
+        }
+    }
+
+    // start warming up the cache in the background
+    auto preload = _accessLogPreload && !_accessLogPath.empty();
+
+    if ((_warmUpLevelCount > 0 || preload) && _nodeCache->getSize() > 0) {
+        _warmingUp = true;
+        _warmUpStopped = false;
+        _warmUpThread = std::thread {
+            &HistoryFileSource::runWarmUp, this, _warmUpLevelCount,
+            _warmUpBegin, _warmUpEnd, _warmUpWorkerCount, preload
+        };
+    }
+}
+
+void HistoryFileSource::open(const boost::filesystem::path& path,
+                             NodeCacheType nodeCacheType,
+                             std::size_t nodeCacheSize,
+                             std::size_t byteBudget)
+{
+    std::shared_ptr<AbstractNodeCache> nodeCache;
+
+    // a requested memory cap must be honoured
+    if (byteBudget != 0 && nodeCacheType != NodeCacheType::LRU &&
+            nodeCacheType != NodeCacheType::TWO_QUEUE) {
+        throw std::invalid_argument {
+            "Node cache type does not support a byte budget"
+        };
+    }
+
+    switch (nodeCacheType) {
+    case NodeCacheType::PASS_THROUGH:
+        nodeCache.reset(new PassThroughNodeCache);
+        break;
+
+    case NodeCacheType::DIRECT_MAPPED:
+        nodeCache.reset(new DirectMappedNodeCache {nodeCacheSize});
+        break;
+
+    case NodeCacheType::LRU:
+        nodeCache.reset(new LruNodeCache {nodeCacheSize, byteBudget});
+        break;
+
+    case NodeCacheType::TWO_QUEUE:
+        nodeCache.reset(new TwoQueueNodeCache {nodeCacheSize, byteBudget});
+        break;
+
+    case NodeCacheType::ARC:
+        nodeCache.reset(new ArcNodeCache {nodeCacheSize});
+        break;
+
+    default:
+        throw std::invalid_argument {"Unknown node cache type"};
+    }
+
+    this->open(path, nodeCache);
 }
 
 void HistoryFileSource::close()
@@ -96,10 +211,466 @@ void HistoryFileSource::close()
         return;
     }
 
+    this->stopWarmUp();
+
+    if (!_accessCounts.empty()) {
+        try {
+            this->saveAccessLog();
+        } catch (...) {
+            // the access log is only a hint for the next open
+        }
+
+        _accessCounts.clear();
+        _accessLogBaseCounts.clear();
+    }
+
     _inputStream.close();
+    _pinnedNodes.clear();
+    _pinnedMemorySize = 0;
     this->setOpened(false);
 }
 
+void HistoryFileSource::pinUpperLevels()
+{
+    _pinnedNodes.clear();
+    _pinnedMemorySize = 0;
+
+    if (_pinnedLevelCount == 0) {
+        return;
+    }
+
+    // pins a node if it fits within the byte budget
+    auto pinNode = [this] (const Node::SP& node) {
+        auto memorySize = node->getMemorySize();
+
+        if (_pinnedByteBudget != 0 &&
+                _pinnedMemorySize + memorySize > _pinnedByteBudget) {
+            return false;
+        }
+
+        _pinnedNodes.emplace_back(node->getSeqNumber(), node);
+        _pinnedMemorySize += memorySize;
+
+        return true;
+    };
+
+    std::vector<Node::SP> levelNodes;
+    auto root = this->getNode(this->getRootNodeSeqNumber());
+
+    if (root && pinNode(root)) {
+        levelNodes.push_back(root);
+    }
+
+    /* Pin level by level: stop reading nodes as soon as one doesn't
+     * fit within the byte budget.
+     */
+    auto budgetReached = false;
+
+    for (std::size_t level = 1; level < _pinnedLevelCount &&
+            !levelNodes.empty() && !budgetReached; ++level) {
+        std::vector<Node::SP> nextLevelNodes;
+
+        for (const auto& node : levelNodes) {
+            for (std::size_t x = 0; x < node->getChildrenCount(); ++x) {
+                auto child = this->getNode(node->getChildSeqAtIndex(x));
+
+                if (!child) {
+                    continue;
+                }
+
+                if (!pinNode(child)) {
+                    budgetReached = true;
+                    break;
+                }
+
+                nextLevelNodes.push_back(std::move(child));
+            }
+
+            if (budgetReached) {
+                break;
+            }
+        }
+
+        levelNodes = std::move(nextLevelNodes);
+    }
+
+    std::sort(_pinnedNodes.begin(), _pinnedNodes.end(),
+              [] (const PinnedNode& a, const PinnedNode& b) {
+        return a.first < b.first;
+    });
+}
+
+void HistoryFileSource::warmUpNodes(const std::vector<node_seq_t>& seqs,
+                                    std::size_t workerCount,
+                                    const WarmUpNodeCb& nodeCb)
+{
+    auto maxChildren = this->getMaxChildren();
+    const auto& serdes = this->getNodeSerDes();
+
+    // maximum number of consecutive nodes read at once
+    const std::size_t runNodeCount = 64;
+
+    // loads a part of the nodes
+    auto worker = [&] (std::size_t index, std::size_t first,
+                       std::size_t count) {
+        try {
+            bfs::ifstream input {this->getPath(), std::ios::binary};
+            std::vector<std::uint8_t> buf;
+            auto partSeqs = &seqs[first];
+            std::size_t x = 0;
+
+            while (x < count && input && !_warmUpStopped) {
+                // find a run of nodes stored one after the other
+                auto first = this->getNodeLocation(partSeqs[x]);
+                std::vector<std::size_t> bufOffsets {0};
+                std::uint64_t runEnd = first.offset + first.size;
+                std::size_t runSize = 1;
+
+                while (x + runSize < count && runSize < runNodeCount) {
+                    auto next = this->getNodeLocation(partSeqs[x + runSize]);
+
+                    if (next.offset != runEnd) {
+                        break;
+                    }
+
+                    bufOffsets.push_back(runEnd - first.offset);
+                    runEnd += next.size;
+                    runSize++;
+                }
+
+                buf.resize(runEnd - first.offset);
+                input.seekg(first.offset);
+                input.read(reinterpret_cast<char*>(buf.data()), buf.size());
+
+                if (!input) {
+                    break;
+                }
+
+                for (std::size_t y = 0; y < runSize; ++y) {
+                    auto bufEnd = y + 1 < runSize ? bufOffsets[y + 1] :
+                                  buf.size();
+                    this->verifyNode(partSeqs[x + y], &buf[bufOffsets[y]],
+                                     bufEnd - bufOffsets[y]);
+
+                    auto location = this->getNodeLocation(partSeqs[x + y]);
+                    Node::SP node = serdes.deserializeNode(&buf[bufOffsets[y]],
+                                                           this->getExtendedNodeSize(location),
+                                                           maxChildren);
+
+                    if (nodeCb) {
+                        nodeCb(index, *node);
+                    }
+
+                    this->putNodeIntoCache(partSeqs[x + y], node);
+                }
+
+                x += runSize;
+            }
+        } catch (...) {
+            // warming up is only an optimization: stop here
+        }
+    };
+
+    if (seqs.empty()) {
+        return;
+    }
+
+    // split into contiguous parts, one per worker
+    auto partCount = std::min(std::max(workerCount,
+                                       static_cast<std::size_t>(1)),
+                              seqs.size());
+    auto partSize = (seqs.size() + partCount - 1) / partCount;
+    std::vector<std::thread> workers;
+
+    for (std::size_t x = 0; x < partCount; ++x) {
+        auto first = x * partSize;
+
+        if (first >= seqs.size()) {
+            break;
+        }
+
+        auto count = std::min(partSize, seqs.size() - first);
+        workers.emplace_back(worker, x, first, count);
+    }
+
+    for (auto& thread : workers) {
+        thread.join();
+    }
+}
+
+void HistoryFileSource::runWarmUp(std::size_t levelCount, timestamp_t begin,
+                                  timestamp_t end, std::size_t workerCount,
+                                  bool preload)
+{
+    workerCount = std::max(workerCount, static_cast<std::size_t>(1));
+
+    std::size_t loadedNodeCount = 0;
+
+    if (levelCount > 0) {
+        loadedNodeCount = this->warmUp(levelCount, begin, end, workerCount);
+    }
+
+    if (preload) {
+        this->preloadFromAccessLog(_nodeCache->getSize() - loadedNodeCount,
+                                   workerCount);
+    }
+
+    _warmingUp = false;
+}
+
+std::size_t HistoryFileSource::warmUp(std::size_t levelCount,
+                                      timestamp_t begin, timestamp_t end,
+                                      std::size_t workerCount)
+{
+    auto hasRange = end > begin;
+
+    // never load more nodes than the cache can hold
+    auto remaining = _nodeCache->getSize();
+
+    // children of loaded nodes, per worker
+    std::vector<std::vector<node_seq_t>> children;
+
+    auto nodeCb = [&] (std::size_t index, const Node& node) {
+        const auto& nodeChildren = node.getChildren();
+
+        for (auto it = nodeChildren.begin(); it != nodeChildren.end(); ++it) {
+            if (hasRange) {
+                auto childEnd = node.getEnd();
+                if (it + 1 != nodeChildren.end()) {
+                    childEnd = (it + 1)->getBegin();
+                }
+
+                if (childEnd <= begin || it->getBegin() >= end) {
+                    continue;
+                }
+            }
+
+            children[index].push_back(it->getSeqNumber());
+        }
+    };
+
+    std::vector<node_seq_t> levelSeqs {this->getRootNodeSeqNumber()};
+
+    for (std::size_t level = 0; level < levelCount; ++level) {
+        if (levelSeqs.empty() || remaining == 0 || _warmUpStopped) {
+            break;
+        }
+
+        std::sort(levelSeqs.begin(), levelSeqs.end());
+
+        if (levelSeqs.size() > remaining) {
+            levelSeqs.resize(remaining);
+        }
+
+        remaining -= levelSeqs.size();
+        children.assign(workerCount, {});
+        this->warmUpNodes(levelSeqs, workerCount, nodeCb);
+        levelSeqs.clear();
+
+        for (const auto& partChildren : children) {
+            levelSeqs.insert(levelSeqs.end(), partChildren.begin(),
+                             partChildren.end());
+        }
+    }
+
+    return _nodeCache->getSize() - remaining;
+}
+
+void HistoryFileSource::preloadFromAccessLog(std::size_t maxNodeCount,
+                                             std::size_t workerCount)
+{
+    std::vector<std::uint32_t> counts;
+
+    if (!this->readAccessLog(counts) || maxNodeCount == 0) {
+        return;
+    }
+
+    std::vector<node_seq_t> seqs;
+
+    for (std::size_t seq = 0; seq < counts.size(); ++seq) {
+        if (counts[seq] > 0) {
+            seqs.push_back(static_cast<node_seq_t>(seq));
+        }
+    }
+
+    // keep the hottest nodes only
+    if (seqs.size() > maxNodeCount) {
+        std::stable_sort(seqs.begin(), seqs.end(),
+                         [&counts] (node_seq_t a, node_seq_t b) {
+            return counts[a] > counts[b];
+        });
+        seqs.resize(maxNodeCount);
+    }
+
+    // load them in on-disk order
+    std::sort(seqs.begin(), seqs.end());
+    this->warmUpNodes(seqs, workerCount, nullptr);
+}
+
+bool HistoryFileSource::readAccessLog(std::vector<std::uint32_t>& counts)
+{
+    bfs::ifstream input {_accessLogPath, std::ios::binary};
+
+    if (!input) {
+        return false;
+    }
+
+    AccessLogHeader header;
+    input.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    // only a log of this very history is useful
+    if (!input || header.magic != AccessLogHeader::MAGIC ||
+            header.major != AccessLogHeader::MAJOR ||
+            header.nodeCount != this->getNodeCount() ||
+            header.rootNodeSeqNumber != this->getRootNodeSeqNumber() ||
+            header.fileSize != _fileSize) {
+        return false;
+    }
+
+    counts.assign(header.nodeCount, 0);
+
+    std::istreambuf_iterator<char> it {input};
+    std::istreambuf_iterator<char> endIt;
+    std::uint64_t seq = 0;
+
+    // reads an unsigned LEB128 number
+    auto readVarUint = [&it, &endIt] (std::uint64_t& value) {
+        value = 0;
+
+        for (unsigned int shift = 0; shift < 64; shift += 7) {
+            if (it == endIt) {
+                return false;
+            }
+
+            auto byte = static_cast<std::uint8_t>(*it);
+            ++it;
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    for (std::uint32_t x = 0; x < header.entryCount; ++x) {
+        std::uint64_t seqDelta;
+        std::uint64_t count;
+
+        if (!readVarUint(seqDelta) || !readVarUint(count)) {
+            return false;
+        }
+
+        seq += seqDelta;
+
+        if (seq >= counts.size()) {
+            return false;
+        }
+
+        counts[seq] = static_cast<std::uint32_t>(
+            std::min(count, static_cast<std::uint64_t>(UINT32_MAX))
+        );
+    }
+
+    return true;
+}
+
+void HistoryFileSource::saveAccessLog()
+{
+    if (!this->isOpened()) {
+        throw ex::IO("No access log is being recorded");
+    }
+
+    // base counts and all the accesses so far: saving again is harmless
+    std::vector<std::uint32_t> counts;
+
+    {
+        std::lock_guard<std::mutex> lock {_nodeCacheMutex};
+
+        if (_accessCounts.empty()) {
+            throw ex::IO("No access log is being recorded");
+        }
+
+        counts = _accessLogBaseCounts;
+
+        for (std::size_t seq = 0; seq < counts.size(); ++seq) {
+            std::uint64_t count = counts[seq];
+            count += _accessCounts[seq];
+            counts[seq] = static_cast<std::uint32_t>(
+                std::min(count, static_cast<std::uint64_t>(UINT32_MAX))
+            );
+        }
+    }
+
+    // entries: sequence number delta and count (unsigned LEB128)
+    std::vector<std::uint8_t> entries;
+    std::uint32_t entryCount = 0;
+    std::size_t prevSeq = 0;
+
+    auto writeVarUint = [&entries] (std::uint64_t value) {
+        while (value >= 0x80) {
+            entries.push_back(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+
+        entries.push_back(static_cast<std::uint8_t>(value));
+    };
+
+    for (std::size_t seq = 0; seq < counts.size(); ++seq) {
+        if (counts[seq] == 0) {
+            continue;
+        }
+
+        writeVarUint(seq - prevSeq);
+        writeVarUint(counts[seq]);
+        prevSeq = seq;
+        entryCount++;
+    }
+
+    AccessLogHeader header;
+    header.magic = AccessLogHeader::MAGIC;
+    header.nodeCount = static_cast<std::uint32_t>(counts.size());
+    header.entryCount = entryCount;
+    header.rootNodeSeqNumber = this->getRootNodeSeqNumber();
+    header.fileSize = _fileSize;
+
+    // write a temporary file, then replace the log at once
+    auto tmpPath = _accessLogPath;
+    tmpPath += ".tmp";
+
+    {
+        bfs::ofstream output {tmpPath, std::ios::binary | std::ios::trunc};
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        output.write(reinterpret_cast<const char*>(entries.data()),
+                     entries.size());
+
+        if (!output) {
+            throw ex::IO("Cannot write access log");
+        }
+    }
+
+    boost::system::error_code ec;
+    bfs::rename(tmpPath, _accessLogPath, ec);
+
+    if (ec) {
+        throw ex::IO("Cannot write access log");
+    }
+}
+
+void HistoryFileSource::waitForWarmUp()
+{
+    if (_warmUpThread.joinable()) {
+        _warmUpThread.join();
+    }
+}
+
+void HistoryFileSource::stopWarmUp()
+{
+    _warmUpStopped = true;
+    this->waitForWarmUp();
+}
+
 void HistoryFileSource::readHeader()
 {
     // seek to offset 0
@@ -109,96 +680,647 @@ void HistoryFileSource::readHeader()
     HistoryFileHeader header;
     _inputStream.read(reinterpret_cast<char*>(&header), sizeof(header));
 
+    // make sure we recognize the version
+    if (!_inputStream || header.major != HistoryFileHeader::MAJOR) {
+        throw ex::IO("Unsupported history file version");
+    }
+
     // make sure we recognize the magic (and set node ser/des)
-    if (header.magic == HistoryFileHeader::MAGIC_ALIGNED_NODE_SERDES) {
+    std::uint32_t extensionMask = HistoryFileHeader::MAGIC_EXTENSION_NODES_MASK;
+    std::uint32_t dictionaryMask = HistoryFileHeader::MAGIC_STRING_DICTIONARY_MASK;
+    auto magic = header.magic & ~(extensionMask | dictionaryMask);
+    auto hasExtensionNodes = (header.magic & extensionMask) != 0;
+    auto hasStringDictionary = (header.magic & dictionaryMask) != 0;
+
+    if (magic == HistoryFileHeader::MAGIC_ALIGNED_NODE_SERDES) {
         std::unique_ptr<AlignedNodeSerDes> serdes {new AlignedNodeSerDes};
         this->setNodeSerDes(std::move(serdes));
+    } else if (magic == HistoryFileHeader::MAGIC_COMPACT_NODE_SERDES) {
+        std::unique_ptr<CompactNodeSerDes> serdes {new CompactNodeSerDes};
+        this->setNodeSerDes(std::move(serdes));
+    } else if (magic == HistoryFileHeader::MAGIC_COMPRESSED_NODE_SERDES) {
+        std::unique_ptr<CompressedNodeSerDes> serdes {new CompressedNodeSerDes};
+        this->setNodeSerDes(std::move(serdes));
+    } else if (magic == HistoryFileHeader::MAGIC_COLUMNAR_NODE_SERDES) {
+        std::unique_ptr<ColumnarNodeSerDes> serdes {new ColumnarNodeSerDes};
+        this->setNodeSerDes(std::move(serdes));
+    } else if (magic == HistoryFileHeader::MAGIC_ALIGNED_RELATIVE_NODE_SERDES) {
+        std::unique_ptr<AlignedNodeSerDes> serdes {new AlignedNodeSerDes {true}};
+        this->setNodeSerDes(std::move(serdes));
+    } else if (magic == HistoryFileHeader::MAGIC_ALIGNED_WIDE_NODE_SERDES) {
+        std::unique_ptr<AlignedNodeSerDes> serdes {new AlignedNodeSerDes {false, true}};
+        this->setNodeSerDes(std::move(serdes));
+    } else if (magic == HistoryFileHeader::MAGIC_ALIGNED_WIDE_RELATIVE_NODE_SERDES) {
+        std::unique_ptr<AlignedNodeSerDes> serdes {new AlignedNodeSerDes {true, true}};
+        this->setNodeSerDes(std::move(serdes));
     } else {
         throw ex::IO("Unknown history file magic number");
     }
 
+    // extension nodes are located by the node index
+    if (hasExtensionNodes && header.nodeIndexOffset == 0) {
+        throw ex::IO("Missing history file node index");
+    }
+
+    // a string dictionary is announced by the magic number
+    if (hasStringDictionary != (header.stringDictionaryOffset != 0)) {
+        throw ex::IO("Inconsistent history file string dictionary");
+    }
+
     // set other parameters
     this->setNodeSize(header.nodeSize);
     this->setMaxChildren(header.maxChildren);
     this->setNodeCount(header.nodeCount);
     this->setRootNodeSeqNumber(header.rootNodeSeqNumber);
+
+    // read node index, if nodes are not stored in fixed-size slots
+    _nodeIndex.clear();
+
+    if (header.nodeIndexOffset != 0) {
+        this->readNodeIndex(header.nodeIndexOffset);
+    }
+
+    // read string dictionary, if string intervals are dictionary-encoded
+    _stringDictionary.reset();
+
+    if (header.stringDictionaryOffset != 0) {
+        this->readStringDictionary(header.stringDictionaryOffset,
+                                   header.stringDictionarySize);
+    }
+
+    // read node checksums, if nodes have checksums
+    _nodeChecksums.clear();
+
+    if (header.nodeChecksumsOffset != 0) {
+        this->readNodeChecksums(header.nodeChecksumsOffset);
+    }
+
+    // read node directory, if any
+    _nodeDirectory.clear();
+    _levelSeqs.clear();
+
+    if (header.nodeDirectoryOffset != 0) {
+        this->readNodeDirectory(header.nodeDirectoryOffset);
+    }
+}
+
+void HistoryFileSource::readStringDictionary(std::uint64_t offset,
+                                             std::uint64_t size)
+{
+    std::vector<std::uint8_t> buf(size);
+    _inputStream.clear();
+    _inputStream.seekg(offset);
+    _inputStream.read(reinterpret_cast<char*>(buf.data()), buf.size());
+
+    if (!_inputStream) {
+        throw ex::IO("Cannot read history file string dictionary");
+    }
+
+    StringDictionary::SP dictionary {new StringDictionary};
+
+    if (!dictionary->deserialize(buf.data(), buf.size())) {
+        throw ex::IO("Invalid history file string dictionary");
+    }
+
+    // string intervals now refer to this dictionary
+    IIntervalFactory::UP factory {
+        new DictionaryStringIntervalFactory {dictionary}
+    };
+    auto stringType = static_cast<interval_type_t>(StandardIntervalType::STRING);
+    auto& serdes = this->getNodeSerDes();
+    serdes.unregisterIntervalFactory(stringType);
+    serdes.registerIntervalFactory(stringType, std::move(factory));
+    _stringDictionary = dictionary;
+}
+
+void HistoryFileSource::readNodeIndex(std::uint64_t offset)
+{
+    _nodeIndex.resize(this->getNodeCount());
+    _inputStream.clear();
+    _inputStream.seekg(offset);
+    _inputStream.read(reinterpret_cast<char*>(_nodeIndex.data()),
+                      _nodeIndex.size() * sizeof(NodeIndexEntry));
+
+    if (!_inputStream) {
+        throw ex::IO("Cannot read history file node index");
+    }
+
+    // make sure every node lies between the header and the index
+    for (const auto& entry : _nodeIndex) {
+        if (entry.offset < HistoryFileHeader::SIZE ||
+                entry.size > this->getExtendedNodeSize(entry) ||
+                entry.offset + entry.size > offset) {
+            throw ex::IO("Invalid history file node index");
+        }
+    }
+}
+
+void HistoryFileSource::readNodeChecksums(std::uint64_t offset)
+{
+    _nodeChecksums.resize(this->getNodeCount());
+    _inputStream.clear();
+    _inputStream.seekg(offset);
+    _inputStream.read(reinterpret_cast<char*>(_nodeChecksums.data()),
+                      _nodeChecksums.size() * sizeof(std::uint32_t));
+
+    if (!_inputStream) {
+        throw ex::IO("Cannot read history file node checksums");
+    }
+}
+
+void HistoryFileSource::readNodeDirectory(std::uint64_t offset)
+{
+    _nodeDirectory.resize(this->getNodeCount());
+    _inputStream.clear();
+    _inputStream.seekg(offset);
+    _inputStream.read(reinterpret_cast<char*>(_nodeDirectory.data()),
+                      _nodeDirectory.size() * sizeof(NodeDirectoryEntry));
+
+    if (!_inputStream) {
+        throw ex::IO("Cannot read history file node directory");
+    }
+
+    // group nodes by level, in time order
+    for (node_seq_t seq = 0; seq < _nodeDirectory.size(); ++seq) {
+        const auto& entry = _nodeDirectory[seq];
+
+        if (entry.level >= _nodeDirectory.size()) {
+            throw ex::IO("Invalid history file node directory");
+        }
+
+        if (entry.level >= _levelSeqs.size()) {
+            _levelSeqs.resize(entry.level + 1);
+        }
+
+        _levelSeqs[entry.level].push_back(seq);
+    }
+
+    for (auto& seqs : _levelSeqs) {
+        std::stable_sort(seqs.begin(), seqs.end(),
+                         [this] (node_seq_t a, node_seq_t b) {
+            return _nodeDirectory[a].begin < _nodeDirectory[b].begin;
+        });
+    }
+}
+
+bool HistoryFileSource::getNodeInfo(node_seq_t seqNumber,
+                                    NodeInfo& info) const
+{
+    if (seqNumber >= _nodeDirectory.size()) {
+        return false;
+    }
+
+    const auto& entry = _nodeDirectory[seqNumber];
+
+    info.seqNumber = seqNumber;
+    info.parentSeqNumber = entry.parentSeqNumber;
+    info.begin = entry.begin;
+    info.end = entry.end;
+    info.level = entry.level;
+    info.intervalCount = entry.intervalCount;
+
+    return true;
+}
+
+void HistoryFileSource::findNodesInRange(timestamp_t begin, timestamp_t end,
+                                         std::size_t level,
+                                         std::vector<node_seq_t>& seqs) const
+{
+    if (level >= _levelSeqs.size()) {
+        return;
+    }
+
+    /* Nodes of a level follow each other in time: the end of each one
+     * is the begin of the next one.
+     */
+    const auto& levelSeqs = _levelSeqs[level];
+    auto it = std::upper_bound(levelSeqs.begin(), levelSeqs.end(), begin,
+                               [this] (timestamp_t ts, node_seq_t seq) {
+        return ts < _nodeDirectory[seq].end;
+    });
+
+    for (; it != levelSeqs.end(); ++it) {
+        const auto& entry = _nodeDirectory[*it];
+
+        if (entry.begin >= end) {
+            break;
+        }
+
+        seqs.push_back(*it);
+    }
+}
+
+void HistoryFileSource::verifyNode(node_seq_t seqNumber,
+                                   const std::uint8_t* buf,
+                                   std::size_t size) const
+{
+    if (_nodeChecksums.empty()) {
+        return;
+    }
+
+    if (Crc32c::compute(buf, size) != _nodeChecksums[seqNumber]) {
+        throw ex::CorruptedNode {seqNumber};
+    }
+}
+
+AbstractHistoryFile::NodeIndexEntry HistoryFileSource::getNodeLocation(node_seq_t seqNumber) const
+{
+    if (!_nodeIndex.empty()) {
+        return _nodeIndex[seqNumber];
+    }
+
+    NodeIndexEntry entry;
+    auto nodeSize = this->getNodeSize();
+
+    entry.offset = HistoryFileHeader::SIZE +
+                   static_cast<std::uint64_t>(nodeSize) * seqNumber;
+    entry.size = static_cast<std::uint32_t>(nodeSize);
+
+    return entry;
+}
+
+std::size_t HistoryFileSource::getExtendedNodeSize(const NodeIndexEntry& location) const
+{
+    if (location.extendedSize != 0) {
+        return location.extendedSize;
+    }
+
+    return this->getNodeSize();
+}
+
+void HistoryFileSource::getNodeSeqsInFileOrder(std::vector<node_seq_t>& seqs) const
+{
+    seqs.clear();
+
+    for (node_seq_t seq = 0; seq < this->getNodeCount(); ++seq) {
+        seqs.push_back(seq);
+    }
+
+    if (!_nodeIndex.empty()) {
+        std::sort(seqs.begin(), seqs.end(),
+                  [this] (node_seq_t a, node_seq_t b) {
+            return _nodeIndex[a].offset < _nodeIndex[b].offset;
+        });
+    }
 }
 
 Node::SP HistoryFileSource::getNode(node_seq_t seqNumber)
 {
     // make sure the node exists
-    if (seqNumber > this->getNodeCount()) {
+    if (seqNumber >= this->getNodeCount()) {
         return nullptr;
     }
 
     // seek input stream to the right offset
-    _inputStream.seekg(HistoryFileHeader::SIZE +
-                       this->getNodeSize() * seqNumber);
+    auto location = this->getNodeLocation(seqNumber);
+    _inputStream.seekg(location.offset);
 
-    // read node bytes
-    _inputStream.read(reinterpret_cast<char*>(_nodeBuf.get()),
-                      this->getNodeSize());
+    // read node bytes (into a larger buffer for an extended node)
+    auto size = this->getExtendedNodeSize(location);
+    std::vector<std::uint8_t> extendedBuf;
+    auto buf = _nodeBuf.get();
+
+    if (size > this->getNodeSize()) {
+        extendedBuf.resize(size);
+        buf = extendedBuf.data();
+    }
+
+    _inputStream.read(reinterpret_cast<char*>(buf), location.size);
+    this->verifyNode(seqNumber, buf, location.size);
 
     // deserialize node into buffer
-    auto node = this->getNodeSerDes().deserializeNode(_nodeBuf.get(),
-                                                      this->getNodeSize(),
+    auto node = this->getNodeSerDes().deserializeNode(buf, size,
                                                       this->getMaxChildren());
     Node::SP nodeSp = std::move(node);
 
     return nodeSp;
 }
 
-Node::SP HistoryFileSource::getNodeFromCache(node_seq_t seqNumber)
+Node::SP HistoryFileSource::loadNode(node_seq_t seqNumber)
 {
-    return _nodeCache->getNode(seqNumber);
-}
+    // node cache callback: report the bytes read from the file
+    auto node = this->getNode(seqNumber);
 
-Node::SP HistoryFileSource::getRootNode()
-{
-    return this->getNodeFromCache(this->getRootNodeSeqNumber());
+    if (node) {
+        _nodeCache->addBytesLoaded(this->getNodeLocation(seqNumber).size);
+    }
+
+    return node;
 }
 
-bool HistoryFileSource::findAll(timestamp_t ts, IntervalJar& intervals)
+void HistoryFileSource::scan(const ScanCb& cb, std::size_t workerCount,
+                             std::size_t chunkSize)
 {
-    // make sure this history file is opened
     if (!this->isOpened()) {
-        throw ex::IO("Trying to query a closed history file source");
+        throw ex::IO("Trying to scan a closed history file source");
     }
 
-    // check range
-    if (!this->validateTs(ts)) {
-        throw ex::TimestampOutOfRange {this->getBegin(), this->getEnd(), ts};
+    // dedicated input stream: the regular one is used by queries
+    bfs::ifstream input {this->getPath(), std::ios::binary};
+    if (!input) {
+        throw ex::IO("Cannot open history file for scanning");
     }
 
-    // initial jar size
-    auto initSize = intervals.size();
+    workerCount = std::max(workerCount, static_cast<std::size_t>(1));
 
-    // current node: root node
-    auto currentNode = this->getRootNode();
+    auto nodeSize = this->getNodeSize();
+    auto maxChildren = this->getMaxChildren();
+    const auto& serdes = this->getNodeSerDes();
 
-    // climb tree
-    currentNode->findAll(ts, intervals);
-    while (currentNode->getChildrenCount() > 0) {
-        // select next current node, a child of the current node
-        auto nextNodeSeqNumber = currentNode->getChildSeqAtTs(ts);
-        if (nextNodeSeqNumber == currentNode->getSeqNumber()) {
-            break;
+    // nodes in file order
+    std::vector<node_seq_t> seqs;
+    this->getNodeSeqsInFileOrder(seqs);
+
+    // chunk of consecutive serialized nodes
+    struct Chunk
+    {
+        std::vector<std::uint8_t> buf;
+        std::vector<std::size_t> nodeOffsets;
+        std::vector<node_seq_t> nodeSeqs;
+    };
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::vector<std::unique_ptr<Chunk>> freeChunks;
+    std::deque<std::unique_ptr<Chunk>> fullChunks;
+    std::exception_ptr error;
+    bool done = false;
+
+    // two chunks per worker: one being decoded and one ready
+    for (std::size_t x = 0; x < workerCount * 2; ++x) {
+        std::unique_ptr<Chunk> chunk {new Chunk};
+        chunk->buf.reserve(std::max(chunkSize, nodeSize));
+        freeChunks.push_back(std::move(chunk));
+    }
+
+    auto fail = [&] () {
+        {
+            std::lock_guard<std::mutex> lock {mutex};
+
+            if (!error) {
+                error = std::current_exception();
+            }
         }
-        currentNode = this->getNodeFromCache(nextNodeSeqNumber);
-        if (!currentNode) {
-            // weird, but possible
-            break;
+
+        cond.notify_all();
+    };
+
+    auto worker = [&] (std::size_t index) {
+        try {
+            while (true) {
+                std::unique_ptr<Chunk> chunk;
+
+                {
+                    std::unique_lock<std::mutex> lock {mutex};
+                    cond.wait(lock, [&] () {
+                        return !fullChunks.empty() || done || error;
+                    });
+
+                    if (error || fullChunks.empty()) {
+                        return;
+                    }
+
+                    chunk = std::move(fullChunks.front());
+                    fullChunks.pop_front();
+                }
+
+                auto& offsets = chunk->nodeOffsets;
+
+                for (std::size_t x = 0; x < offsets.size(); ++x) {
+                    auto nodeBuf = &chunk->buf[offsets[x]];
+                    auto nodeEnd = x + 1 < offsets.size() ? offsets[x + 1] :
+                                   chunk->buf.size();
+                    this->verifyNode(chunk->nodeSeqs[x], nodeBuf,
+                                     nodeEnd - offsets[x]);
+
+                    auto location = this->getNodeLocation(chunk->nodeSeqs[x]);
+                    auto node = serdes.deserializeNode(nodeBuf,
+                                                       this->getExtendedNodeSize(location),
+                                                       maxChildren);
+
+                    for (const auto& interval : node->getIntervals()) {
+                        cb(index, interval);
+                    }
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock {mutex};
+                    freeChunks.push_back(std::move(chunk));
+                }
+
+                cond.notify_all();
+            }
+        } catch (...) {
+            fail();
+        }
+    };
+
+    // read chunks in this thread while workers decode them
+    std::vector<std::thread> workers;
+
+    try {
+        for (std::size_t x = 0; x < workerCount; ++x) {
+            workers.emplace_back(worker, x);
         }
 
-        // find all intervals in this node
-        currentNode->findAll(ts, intervals);
+        std::size_t index = 0;
+
+        while (index < seqs.size()) {
+            std::unique_ptr<Chunk> chunk;
+
+            {
+                std::unique_lock<std::mutex> lock {mutex};
+                cond.wait(lock, [&] () {
+                    return !freeChunks.empty() || error;
+                });
+
+                if (error) {
+                    break;
+                }
+
+                chunk = std::move(freeChunks.back());
+                freeChunks.pop_back();
+            }
+
+            // take nodes stored one after the other, up to the chunk size
+            auto location = this->getNodeLocation(seqs[index]);
+            auto begin = location.offset;
+            auto end = begin;
+
+            chunk->nodeOffsets.clear();
+            chunk->nodeSeqs.clear();
+
+            while (index < seqs.size()) {
+                location = this->getNodeLocation(seqs[index]);
+
+                if (location.offset != end ||
+                        (!chunk->nodeOffsets.empty() &&
+                         end + location.size - begin > chunkSize)) {
+                    break;
+                }
+
+                chunk->nodeOffsets.push_back(end - begin);
+                chunk->nodeSeqs.push_back(seqs[index]);
+                end += location.size;
+                index++;
+            }
+
+            chunk->buf.resize(end - begin);
+            input.seekg(begin);
+            input.read(reinterpret_cast<char*>(chunk->buf.data()),
+                       chunk->buf.size());
+
+            if (!input) {
+                throw ex::IO("Cannot read history file nodes");
+            }
+
+            {
+                std::lock_guard<std::mutex> lock {mutex};
+                fullChunks.push_back(std::move(chunk));
+            }
+
+            cond.notify_all();
+        }
+    } catch (...) {
+        fail();
     }
 
-    return intervals.size() > initSize;
+    {
+        std::lock_guard<std::mutex> lock {mutex};
+        done = true;
+    }
+
+    cond.notify_all();
+
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
 }
 
-AbstractInterval::SP HistoryFileSource::findOne(timestamp_t ts,
-                                                interval_key_t key)
+Node::SP HistoryFileSource::findPinnedNode(node_seq_t seqNumber) const
+{
+    if (_pinnedNodes.empty()) {
+        return nullptr;
+    }
+
+    auto it = std::lower_bound(_pinnedNodes.begin(), _pinnedNodes.end(),
+                               seqNumber,
+                               [] (const PinnedNode& pinnedNode,
+                                   node_seq_t seqNumber) {
+        return pinnedNode.first < seqNumber;
+    });
+
+    if (it != _pinnedNodes.end() && it->first == seqNumber) {
+        return it->second;
+    }
+
+    return nullptr;
+}
+
+Node::SP HistoryFileSource::readNode(std::istream& input,
+                                    std::vector<std::uint8_t>& buf,
+                                    node_seq_t seqNumber)
+{
+    if (seqNumber >= this->getNodeCount()) {
+        return nullptr;
+    }
+
+    auto location = this->getNodeLocation(seqNumber);
+    auto nodeSize = this->getExtendedNodeSize(location);
+
+    buf.resize(nodeSize);
+    input.seekg(location.offset);
+    input.read(reinterpret_cast<char*>(buf.data()), location.size);
+
+    if (!input) {
+        input.clear();
+
+        return nullptr;
+    }
+
+    this->verifyNode(seqNumber, buf.data(), location.size);
+
+    const auto& serdes = this->getNodeSerDes();
+    Node::SP node = serdes.deserializeNode(buf.data(), nodeSize,
+                                           this->getMaxChildren());
+
+    return node;
+}
+
+Node::SP HistoryFileSource::getNodeIfCached(node_seq_t seqNumber)
+{
+    auto pinnedNode = this->findPinnedNode(seqNumber);
+
+    if (pinnedNode) {
+        return pinnedNode;
+    }
+
+    // probing isn't an access: no statistics, no recency change
+    std::lock_guard<std::mutex> lock {_nodeCacheMutex};
+
+    return _nodeCache->peekNode(seqNumber);
+}
+
+void HistoryFileSource::putNodeIntoCache(node_seq_t seqNumber, Node::SP node)
+{
+    // pinned nodes stay out of the node cache
+    if (this->findPinnedNode(seqNumber)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock {_nodeCacheMutex};
+
+    _nodeCache->addBytesLoaded(this->getNodeLocation(seqNumber).size);
+    _nodeCache->putNode(seqNumber, node);
+}
+
+Node::SP HistoryFileSource::getNodeFromCache(node_seq_t seqNumber,
+                                            std::size_t level)
+{
+    auto pinnedNode = this->findPinnedNode(seqNumber);
+
+    if (pinnedNode) {
+        return pinnedNode;
+    }
+
+    std::lock_guard<std::mutex> lock {_nodeCacheMutex};
+
+    if (seqNumber < _accessCounts.size() &&
+            _accessCounts[seqNumber] != UINT32_MAX) {
+        _accessCounts[seqNumber]++;
+    }
+
+    return _nodeCache->getNode(seqNumber, level);
+}
+
+Node::SP HistoryFileSource::getRootNode()
+{
+    return this->getNodeFromCache(this->getRootNodeSeqNumber(), 0);
+}
+
+Node::SP HistoryFileSource::getChildNodeAtTs(const Node& node,
+                                            timestamp_t ts,
+                                            std::size_t level)
+{
+    if (node.getChildrenCount() == 0) {
+        return nullptr;
+    }
+
+    // select child node including the timestamp
+    auto childSeqNumber = node.getChildSeqAtTs(ts);
+    if (childSeqNumber == node.getSeqNumber()) {
+        return nullptr;
+    }
+
+    // this may be `nullptr` too (weird, but possible)
+    return this->getNodeFromCache(childSeqNumber, level);
+}
+
+void HistoryFileSource::validateQuery(timestamp_t ts) const
 {
     // make sure this history file is opened
     if (!this->isOpened()) {
@@ -209,27 +1331,68 @@ AbstractInterval::SP HistoryFileSource::findOne(timestamp_t ts,
     if (!this->validateTs(ts)) {
         throw ex::TimestampOutOfRange {this->getBegin(), this->getEnd(), ts};
     }
+}
 
-    // current node: root node
-    auto currentNode = this->getRootNode();
-
-    // climb tree
-    auto interval = currentNode->findOne(ts, key);
-    while (currentNode->getChildrenCount() > 0 && !interval) {
-        // select next current node, a child of the current node
-        auto nextNodeSeqNumber = currentNode->getChildSeqAtTs(ts);
-        if (nextNodeSeqNumber == currentNode->getSeqNumber()) {
-            break;
-        }
-        currentNode = this->getNodeFromCache(nextNodeSeqNumber);
-        if (!currentNode) {
-            // weird, but possible
-            break;
-        }
+void HistoryFileSource::validateRangeQuery(timestamp_t begin,
+                                           timestamp_t end) const
+{
+    this->validateQuery(begin);
 
-        // find one interval in this node
-        interval = currentNode->findOne(ts, key);
+    // range end is excluded, so it may be the history end
+    if (end <= begin || end > this->getEnd()) {
+        throw ex::TimestampOutOfRange {this->getBegin(), this->getEnd(), end};
     }
+}
+
+bool HistoryFileSource::findAll(timestamp_t ts, IntervalJar& intervals)
+{
+    this->validateQuery(ts);
+
+    // initial jar size
+    auto initSize = intervals.size();
+
+    // find all intervals in each node of the branch
+    this->visitBranchAtTs(ts, [ts, &intervals] (const Node& node) {
+        node.findAll(ts, intervals);
+
+        return true;
+    });
+
+    return intervals.size() > initSize;
+}
+
+bool HistoryFileSource::findAll(timestamp_t ts, FlatIntervalJar& intervals)
+{
+    this->validateQuery(ts);
+
+    // initial jar size
+    auto initSize = intervals.size();
+
+    // append all intervals of each node of the branch
+    this->visitBranchAtTs(ts, [ts, &intervals] (const Node& node) {
+        node.findAll(ts, intervals);
+
+        return true;
+    });
+
+    // sort appended intervals
+    intervals.normalize(initSize);
+
+    return intervals.size() > initSize;
+}
+
+AbstractInterval::SP HistoryFileSource::findOne(timestamp_t ts,
+                                                interval_key_t key)
+{
+    this->validateQuery(ts);
+
+    // find one interval in each node of the branch until found
+    AbstractInterval::SP interval;
+    this->visitBranchAtTs(ts, [ts, key, &interval] (const Node& node) {
+        interval = node.findOne(ts, key);
+
+        return !interval;
+    });
 
     return interval;
 }
@@ -0,0 +1,184 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstddef>
+
+#include <delorean/HistoryReplayIterator.hpp>
+#include <delorean/HistoryFileSource.hpp>
+#include <delorean/node/Node.hpp>
+#include <delorean/interval/AbstractInterval.hpp>
+#include <delorean/ex/TimestampOutOfRange.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+HistoryReplayIterator::HistoryReplayIterator(HistoryFileSource& source,
+                                             timestamp_t begin,
+                                             timestamp_t end) :
+    _source (source),
+    _begin {begin},
+    _end {end}
+{
+    _source.validateQuery(begin);
+
+    if (end <= begin) {
+        throw ex::TimestampOutOfRange {
+            _source.getBegin(), _source.getEnd(), end
+        };
+    }
+
+    // all leaves are at the same depth: count levels along any branch
+    auto root = _source.getRootNode();
+    std::size_t levelCount = 1;
+
+    for (auto node = root; node && node->getChildrenCount() > 0;) {
+        node = _source.getNodeFromCache(node->getChildSeqAtIndex(0));
+        levelCount++;
+    }
+
+    // position each level stream on its first node
+    _levels.resize(levelCount);
+
+    for (std::size_t depth = 0; depth < levelCount; ++depth) {
+        auto& stream = _levels[depth];
+
+        stream.path.push_back({root, this->getFirstChildIndex(*root)});
+        this->nextNode(stream, depth);
+    }
+}
+
+std::size_t HistoryReplayIterator::getFirstChildIndex(const Node& node) const
+{
+    /* Skip children which end before the window begin: they cannot
+     * contain intervals ending within the window.
+     */
+    std::size_t index = 0;
+
+    while (index < node.getChildrenCount() &&
+            getChildEnd(node, index) < _begin) {
+        index++;
+    }
+
+    return index;
+}
+
+void HistoryReplayIterator::nextNode(LevelStream& stream, std::size_t depth)
+{
+    auto& path = stream.path;
+
+    stream.node = nullptr;
+
+    while (!path.empty()) {
+        auto& frame = path.back();
+
+        // reached the level of this stream?
+        if (path.size() - 1 == depth) {
+            auto node = std::move(frame.node);
+            path.pop_back();
+
+            // skip intervals ending before the window begin
+            const auto& intervals = node->getIntervals();
+            auto it = std::lower_bound(intervals.begin(), intervals.end(),
+                                       _begin,
+                                       [] (const AbstractInterval::SP& interval,
+                                           timestamp_t ts) {
+                return interval->getEnd() < ts;
+            });
+
+            if (it == intervals.end()) {
+                continue;
+            }
+
+            stream.node = std::move(node);
+            stream.intervalIndex = it - intervals.begin();
+
+            return;
+        }
+
+        // no more children in this subtree?
+        if (frame.nextChild >= frame.node->getChildrenCount()) {
+            path.pop_back();
+            continue;
+        }
+
+        auto childIndex = frame.nextChild++;
+
+        /* Children beginning at or after the window end only contain
+         * intervals ending after it, and so do the next ones.
+         */
+        if (frame.node->getChildBeginAtIndex(childIndex) >= _end) {
+            frame.nextChild = frame.node->getChildrenCount();
+            continue;
+        }
+
+        auto childSeq = frame.node->getChildSeqAtIndex(childIndex);
+        auto child = _source.getNodeFromCache(childSeq, path.size());
+
+        if (!child) {
+            continue;
+        }
+
+        auto firstChildIndex = this->getFirstChildIndex(*child);
+        path.push_back({std::move(child), firstChildIndex});
+    }
+}
+
+AbstractInterval::SP HistoryReplayIterator::next()
+{
+    // find the level stream having the interval ending first
+    LevelStream* minStream = nullptr;
+    std::size_t minDepth = 0;
+    timestamp_t minEnd = _end;
+
+    for (std::size_t depth = 0; depth < _levels.size(); ++depth) {
+        auto& stream = _levels[depth];
+
+        if (!stream.node) {
+            continue;
+        }
+
+        const auto& intervals = stream.node->getIntervals();
+        auto end = intervals[stream.intervalIndex]->getEnd();
+
+        if (end < minEnd) {
+            minStream = &stream;
+            minDepth = depth;
+            minEnd = end;
+        }
+    }
+
+    // nothing left ending within the window
+    if (!minStream) {
+        return nullptr;
+    }
+
+    const auto& intervals = minStream->node->getIntervals();
+    auto interval = intervals[minStream->intervalIndex];
+
+    // advance this level stream
+    minStream->intervalIndex++;
+
+    if (minStream->intervalIndex >= intervals.size()) {
+        this->nextNode(*minStream, minDepth);
+    }
+
+    return interval;
+}
+
+}
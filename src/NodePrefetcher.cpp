@@ -0,0 +1,214 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <mutex>
+#include <boost/filesystem/fstream.hpp>
+
+#include <delorean/NodePrefetcher.hpp>
+#include <delorean/HistoryFileSource.hpp>
+#include <delorean/node/Node.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+NodePrefetcher::NodePrefetcher(HistoryFileSource& source,
+                               std::size_t workerCount) :
+    _source (source),
+    _busyCount {0},
+    _stopped {false},
+    _readNodeCount {0}
+{
+    workerCount = std::max(workerCount, static_cast<std::size_t>(1));
+
+    for (std::size_t x = 0; x < workerCount; ++x) {
+        _workers.emplace_back(&NodePrefetcher::work, this);
+    }
+}
+
+NodePrefetcher::~NodePrefetcher()
+{
+    {
+        std::lock_guard<std::mutex> lock {_mutex};
+        _requests.clear();
+        _stopped = true;
+    }
+
+    _cond.notify_all();
+
+    for (auto& thread : _workers) {
+        thread.join();
+    }
+}
+
+void NodePrefetcher::prefetchNode(node_seq_t seqNumber)
+{
+    this->addRequest({false, 0, seqNumber});
+}
+
+void NodePrefetcher::prefetchBranch(timestamp_t ts)
+{
+    this->addRequest({true, ts, 0});
+}
+
+void NodePrefetcher::prefetchBranches(const std::vector<timestamp_t>& tss)
+{
+    {
+        std::lock_guard<std::mutex> lock {_mutex};
+
+        for (auto ts : tss) {
+            _requests.push_back({true, ts, 0});
+        }
+    }
+
+    _cond.notify_all();
+}
+
+void NodePrefetcher::addRequest(const Request& request)
+{
+    {
+        std::lock_guard<std::mutex> lock {_mutex};
+        _requests.push_back(request);
+    }
+
+    _cond.notify_one();
+}
+
+void NodePrefetcher::cancel()
+{
+    std::lock_guard<std::mutex> lock {_mutex};
+    _requests.clear();
+}
+
+void NodePrefetcher::wait()
+{
+    std::unique_lock<std::mutex> lock {_mutex};
+    _cond.wait(lock, [this] () {
+        return _requests.empty() && _busyCount == 0;
+    });
+}
+
+void NodePrefetcher::work()
+{
+    Worker worker;
+    worker.input.open(_source.getPath(), std::ios::binary);
+
+    std::unique_lock<std::mutex> lock {_mutex};
+
+    while (true) {
+        _cond.wait(lock, [this] () {
+            return !_requests.empty() || _stopped;
+        });
+
+        if (_stopped) {
+            return;
+        }
+
+        auto request = _requests.front();
+        _requests.pop_front();
+        _busyCount++;
+        lock.unlock();
+
+        try {
+            this->serve(worker, request);
+        } catch (...) {
+            // prefetching is only a hint: ignore
+        }
+
+        lock.lock();
+        _busyCount--;
+
+        if (_requests.empty() && _busyCount == 0) {
+            // wake up waiters
+            _cond.notify_all();
+        }
+    }
+}
+
+void NodePrefetcher::serve(Worker& worker, const Request& request)
+{
+    if (!request.isBranch) {
+        this->loadNode(worker, request.seqNumber);
+
+        return;
+    }
+
+    auto ts = request.ts;
+
+    if (ts < _source.getBegin() || ts >= _source.getEnd()) {
+        return;
+    }
+
+    /* Consecutive branch requests usually share their upper nodes:
+     * reuse the ones of the previous branch still containing `ts`.
+     */
+    std::size_t level = 0;
+    auto& branch = worker.branch;
+
+    while (level < branch.size() && branch[level]->getBegin() <= ts &&
+            ts < branch[level]->getEnd()) {
+        level++;
+    }
+
+    branch.resize(level);
+
+    Node::SP node;
+    if (branch.empty()) {
+        node = this->loadNode(worker, _source.getRootNodeSeqNumber());
+    } else {
+        node = branch.back();
+        branch.pop_back();
+    }
+
+    while (node) {
+        branch.push_back(node);
+
+        if (node->getChildrenCount() == 0) {
+            break;
+        }
+
+        auto childSeqNumber = node->getChildSeqAtTs(ts);
+        if (childSeqNumber == node->getSeqNumber()) {
+            break;
+        }
+
+        node = this->loadNode(worker, childSeqNumber);
+    }
+}
+
+Node::SP NodePrefetcher::loadNode(Worker& worker, node_seq_t seqNumber)
+{
+    auto node = _source.getNodeIfCached(seqNumber);
+
+    if (node) {
+        return node;
+    }
+
+    node = _source.readNode(worker.input, worker.buf, seqNumber);
+
+    if (node) {
+        _readNodeCount++;
+        _source.putNodeIntoCache(seqNumber, node);
+    }
+
+    return node;
+}
+
+}
@@ -33,8 +33,9 @@ AbstractInterval::AbstractInterval(timestamp_t begin, timestamp_t end,
                                    interval_type_t type) :
     _begin {begin},
     _end {end},
-    _type {type},
-    _key {key}
+    _key {key},
+    _fixedValue {0},
+    _type {type}
 {
     // check range (begin == end is allowed and means an interval of length 0)
     if (begin > end) {
@@ -63,6 +64,11 @@ std::size_t AbstractInterval::getVariableDataSize() const
     return this->getVariableDataSizeImpl();
 }
 
+std::size_t AbstractInterval::getMemorySizeImpl() const
+{
+    return sizeof(AbstractInterval) + this->getVariableDataSize();
+}
+
 void AbstractInterval::serializeVariableData(std::uint8_t* varAtPtr) const
 {
     this->serializeVariableDataImpl(varAtPtr);
@@ -0,0 +1,76 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+
+#include <delorean/interval/DictionaryStringInterval.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+DictionaryStringInterval::DictionaryStringInterval(timestamp_t begin,
+                                                   timestamp_t end,
+                                                   interval_key_t key,
+                                                   StringDictionary::SP dictionary) :
+    StringInterval {begin, end, key},
+    _dictionary {dictionary},
+    _value {nullptr}
+{
+}
+
+void DictionaryStringInterval::setValueImpl(const std::string& value)
+{
+    auto id = _dictionary->addString(value);
+
+    this->setFixedValue(id);
+    _value = &_dictionary->getString(id);
+}
+
+const std::string& DictionaryStringInterval::getValueImpl() const
+{
+    // no value yet: empty string
+    if (!_value) {
+        return StringInterval::getValueImpl();
+    }
+
+    return *_value;
+}
+
+std::size_t DictionaryStringInterval::getMemorySizeImpl() const
+{
+    // the dictionary owns the string
+    return sizeof(*this);
+}
+
+std::size_t DictionaryStringInterval::getVariableDataSizeImpl() const
+{
+    // the fixed value is the dictionary ID
+    return 0;
+}
+
+void DictionaryStringInterval::serializeVariableDataImpl(std::uint8_t* varAtPtr) const
+{
+}
+
+void DictionaryStringInterval::deserializeVariableDataImpl(const std::uint8_t* varAtPtr)
+{
+    // resolve dictionary ID (fixed value is already set)
+    _value = &_dictionary->getString(this->getFixedValue());
+}
+
+}
@@ -0,0 +1,115 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <stdexcept>
+
+#include <delorean/interval/FlatIntervalJar.hpp>
+#include <delorean/interval/AbstractInterval.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+namespace
+{
+
+bool entryKeyLess(const FlatIntervalJar::Entry& a,
+                  const FlatIntervalJar::Entry& b)
+{
+    return a.first < b.first;
+}
+
+bool entryKeyEquals(const FlatIntervalJar::Entry& a,
+                    const FlatIntervalJar::Entry& b)
+{
+    return a.first == b.first;
+}
+
+}
+
+FlatIntervalJar::FlatIntervalJar()
+{
+}
+
+FlatIntervalJar::const_iterator FlatIntervalJar::find(interval_key_t key) const
+{
+    auto compare = [] (const Entry& entry, interval_key_t key) {
+        return entry.first < key;
+    };
+    auto it = std::lower_bound(_entries.begin(), _entries.end(), key,
+                               compare);
+
+    if (it == _entries.end() || it->first != key) {
+        return _entries.end();
+    }
+
+    return it;
+}
+
+const AbstractInterval::SP& FlatIntervalJar::at(interval_key_t key) const
+{
+    auto it = this->find(key);
+
+    if (it == _entries.end()) {
+        throw std::out_of_range {"No interval with this key in jar"};
+    }
+
+    return it->second;
+}
+
+bool FlatIntervalJar::insert(const AbstractInterval::SP& interval)
+{
+    auto key = interval->getKey();
+    auto compare = [] (const Entry& entry, interval_key_t key) {
+        return entry.first < key;
+    };
+    auto it = std::lower_bound(_entries.begin(), _entries.end(), key,
+                               compare);
+
+    if (it != _entries.end() && it->first == key) {
+        return false;
+    }
+
+    _entries.insert(it, std::make_pair(key, interval));
+
+    return true;
+}
+
+void FlatIntervalJar::normalize(std::size_t from)
+{
+    auto mid = _entries.begin() + from;
+
+    /* Intervals found by a single query all have different keys, so
+     * an unstable sort is enough here.
+     */
+    std::sort(mid, _entries.end(), entryKeyLess);
+
+    /* The merge is stable: for equal keys, entries which were already
+     * in the jar come first and are kept by std::unique().
+     */
+    if (from > 0) {
+        std::inplace_merge(_entries.begin(), mid, _entries.end(),
+                           entryKeyLess);
+    }
+
+    auto newEnd = std::unique(_entries.begin(), _entries.end(),
+                              entryKeyEquals);
+    _entries.erase(newEnd, _entries.end());
+}
+
+}
@@ -0,0 +1,94 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <delorean/interval/StringDictionary.hpp>
+#include <delorean/ex/IndexOutOfRange.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+interval_value_t StringDictionary::addString(const std::string& str)
+{
+    auto id = static_cast<interval_value_t>(_strings.size());
+    auto ret = _ids.insert(std::make_pair(str, id));
+
+    if (ret.second) {
+        _strings.push_back(&ret.first->first);
+    }
+
+    return ret.first->second;
+}
+
+bool StringDictionary::findId(const std::string& str,
+                              interval_value_t& id) const
+{
+    auto it = _ids.find(str);
+
+    if (it == _ids.end()) {
+        return false;
+    }
+
+    id = it->second;
+
+    return true;
+}
+
+const std::string& StringDictionary::getString(interval_value_t id) const
+{
+    if (id >= _strings.size()) {
+        throw ex::IndexOutOfRange {_strings.size(), id};
+    }
+
+    return *_strings[id];
+}
+
+void StringDictionary::serialize(std::vector<std::uint8_t>& buf) const
+{
+    for (auto str : _strings) {
+        auto cstr = reinterpret_cast<const std::uint8_t*>(str->c_str());
+        buf.insert(buf.end(), cstr, cstr + str->size() + 1);
+    }
+}
+
+bool StringDictionary::deserialize(const std::uint8_t* ptr, std::size_t size)
+{
+    auto end = ptr + size;
+
+    while (ptr != end) {
+        auto nul = static_cast<const std::uint8_t*>(std::memchr(ptr, 0,
+                                                                end - ptr));
+
+        if (!nul) {
+            return false;
+        }
+
+        this->addString(std::string {reinterpret_cast<const char*>(ptr),
+                                     static_cast<std::size_t>(nul - ptr)});
+        ptr = nul + 1;
+    }
+
+    return true;
+}
+
+}
@@ -36,6 +36,34 @@ StringInterval::StringInterval(timestamp_t begin, timestamp_t end,
 {
 }
 
+StringInterval::StringInterval(timestamp_t begin, timestamp_t end,
+                               interval_key_t key, interval_type_t type) :
+    AbstractInterval {begin, end, key, type}
+{
+}
+
+void StringInterval::setValueImpl(const std::string& value)
+{
+    _value = value;
+}
+
+const std::string& StringInterval::getValueImpl() const
+{
+    return _value;
+}
+
+std::size_t StringInterval::getMemorySizeImpl() const
+{
+    std::size_t size = sizeof(*this);
+
+    // short strings are stored within the string object itself
+    if (_value.capacity() >= sizeof(_value)) {
+        size += _value.capacity() + 1;
+    }
+
+    return size;
+}
+
 std::size_t StringInterval::getVariableDataSizeImpl() const
 {
     // includes NUL character
@@ -24,8 +24,13 @@
 namespace delo
 {
 
-AbstractNodeCache::AbstractNodeCache(std::size_t size) :
-    _size {size}
+const std::size_t AbstractNodeCache::NO_LEVEL;
+
+AbstractNodeCache::AbstractNodeCache(std::size_t size,
+                                     std::size_t byteBudget) :
+    _size {size},
+    _byteBudget {byteBudget},
+    _levelStatsEnabled {false}
 {
 }
 
@@ -35,11 +40,64 @@ AbstractNodeCache::~AbstractNodeCache()
 
 Node::SP AbstractNodeCache::getNodeFromOwner(node_seq_t seqNumber)
 {
+    _stats.misses++;
+
     if (!_getNodeFromOwnerCb) {
         return nullptr;
     }
 
-    return _getNodeFromOwnerCb(seqNumber);
+    auto node = _getNodeFromOwnerCb(seqNumber);
+
+    if (node) {
+        _stats.decodedBytesLoaded += node->getMemorySize();
+    }
+
+    return node;
+}
+
+bool AbstractNodeCache::putNodeImpl(node_seq_t seqNumber, Node::SP node)
+{
+    return this->nodeIsCached(seqNumber);
+}
+
+Node::SP AbstractNodeCache::peekNodeImpl(node_seq_t seqNumber) const
+{
+    return nullptr;
+}
+
+void AbstractNodeCache::addBytesLoadedImpl(std::uint64_t size)
+{
+}
+
+void AbstractNodeCache::resetStats()
+{
+    _stats.hits = 0;
+    _stats.misses = 0;
+    _stats.evictions = 0;
+    _stats.collisions = 0;
+    _stats.bytesLoaded = 0;
+    _stats.decodedBytesLoaded = 0;
+    _levelStats.clear();
+}
+
+void AbstractNodeCache::updateLevelStats(std::size_t level,
+                                         std::uint64_t misses,
+                                         std::uint64_t bytes,
+                                         std::uint64_t decodedBytes)
+{
+    if (level >= _levelStats.size()) {
+        _levelStats.resize(level + 1);
+    }
+
+    auto& stats = _levelStats[level];
+
+    if (misses == 0) {
+        stats.hits++;
+    } else {
+        stats.misses += misses;
+        stats.bytesLoaded += bytes;
+        stats.decodedBytesLoaded += decodedBytes;
+    }
 }
 
 }
@@ -27,6 +27,7 @@
 #include <delorean/interval/Uint64Interval.hpp>
 #include <delorean/interval/NullInterval.hpp>
 #include <delorean/interval/FloatInterval.hpp>
+#include <delorean/interval/DoubleInterval.hpp>
 #include <delorean/interval/StringInterval.hpp>
 #include <delorean/interval/SimpleIntervalFactory.hpp>
 #include <delorean/interval/StandardIntervalType.hpp>
@@ -50,6 +51,7 @@ AbstractNodeSerDes::AbstractNodeSerDes()
     auto uint64FactoryPtr = new SimpleIntervalFactory<Uint64Interval> {};
     auto stringFactoryPtr = new SimpleIntervalFactory<StringInterval> {};
     auto floatFactoryPtr = new SimpleIntervalFactory<FloatInterval> {};
+    auto doubleFactoryPtr = new SimpleIntervalFactory<DoubleInterval> {};
     auto nullFactoryPtr = new SimpleIntervalFactory<NullInterval> {};
 
     IIntervalFactory::UP int32Factory {int32FactoryPtr};
@@ -58,6 +60,7 @@ AbstractNodeSerDes::AbstractNodeSerDes()
     IIntervalFactory::UP uint64Factory {uint64FactoryPtr};
     IIntervalFactory::UP stringFactory {stringFactoryPtr};
     IIntervalFactory::UP floatFactory {floatFactoryPtr};
+    IIntervalFactory::UP doubleFactory {doubleFactoryPtr};
     IIntervalFactory::UP nullFactory {nullFactoryPtr};
 
     this->registerIntervalFactory(StandardIntervalType::INT32, std::move(int32Factory));
@@ -66,6 +69,7 @@ AbstractNodeSerDes::AbstractNodeSerDes()
     this->registerIntervalFactory(StandardIntervalType::UINT64, std::move(uint64Factory));
     this->registerIntervalFactory(StandardIntervalType::STRING, std::move(stringFactory));
     this->registerIntervalFactory(StandardIntervalType::FLOAT32, std::move(floatFactory));
+    this->registerIntervalFactory(StandardIntervalType::FLOAT64, std::move(doubleFactory));
     this->registerIntervalFactory(StandardIntervalType::NUL, std::move(nullFactory));
 }
 
@@ -73,6 +77,18 @@ AbstractNodeSerDes::~AbstractNodeSerDes()
 {
 }
 
+std::size_t AbstractNodeSerDes::getIntervalSizeInNodeImpl(const Node& node,
+                                                          const AbstractInterval& interval) const
+{
+    return this->getIntervalSizeImpl(interval);
+}
+
+std::size_t AbstractNodeSerDes::getSerializedSizeImpl(const std::uint8_t* headPtr,
+                                                      std::size_t size) const
+{
+    return size;
+}
+
 void AbstractNodeSerDes::unregisterIntervalFactory(interval_type_t type)
 {
     _intervalFactories[type] = nullptr;
@@ -30,7 +30,33 @@
 namespace delo
 {
 
-AlignedNodeSerDes::AlignedNodeSerDes()
+namespace
+{
+
+template <typename HeaderT, typename FieldsT>
+void writeHeader(std::uint8_t* headPtr, const FieldsT& fields,
+                 timestamp_t nodeBegin)
+{
+    HeaderT header;
+    header.setFromFields(fields, nodeBegin);
+    std::memcpy(headPtr, &header, sizeof(header));
+}
+
+template <typename HeaderT, typename FieldsT>
+void readHeader(const std::uint8_t* headPtr, FieldsT& fields,
+                timestamp_t nodeBegin)
+{
+    HeaderT header;
+    std::memcpy(&header, headPtr, sizeof(header));
+    header.getFields(fields, nodeBegin);
+}
+
+}
+
+AlignedNodeSerDes::AlignedNodeSerDes(bool relativeTimestamps,
+                                     bool wideValues) :
+    _relativeTimestamps {relativeTimestamps},
+    _wideValues {wideValues}
 {
 }
 
@@ -48,8 +74,14 @@ void AlignedNodeSerDes::serializeNodeImpl(const Node& node,
     NodeHeader nodeHeader;
     nodeHeader.setFromNode(node);
 
-    // write node header
-    std::memcpy(headPtr, &nodeHeader, sizeof(nodeHeader));
+    auto isRelative = this->hasRelativeTimestamps(node);
+
+    if (isRelative) {
+        nodeHeader.childrenCountFlags |= NodeHeader::FLAG_RELATIVE_MASK;
+    }
+
+    // node header is written last, once extensions are known
+    auto nodeHeaderPtr = headPtr;
     headPtr += sizeof(nodeHeader);
 
     // write children
@@ -61,31 +93,64 @@ void AlignedNodeSerDes::serializeNodeImpl(const Node& node,
     }
 
     // serialize intervals
+    auto intervalHeaderSize = this->getIntervalHeaderSize(isRelative);
     std::size_t varOffset = 0;
+
     for (const auto& interval : node.getIntervals()) {
         // update variable data pointer and offset from end
         auto variableDataSize = interval->getVariableDataSize();
-        varAtPtr -= variableDataSize;
-        varOffset += variableDataSize;
+        auto extensionSize = this->getIntervalExtensionSize(*interval);
+        varAtPtr -= extensionSize + variableDataSize;
+        varOffset += extensionSize + variableDataSize;
 
         // build interval header
-        IntervalHeader intervalHeader;
-        intervalHeader.setFromInterval(*interval);
+        IntervalFields fields;
+        fields.begin = interval->getBegin();
+        fields.end = interval->getEnd();
+        fields.value = interval->getFixedValue();
+        fields.varOffset = 0;
 
-        // override fixed value with variable data offset if there's any
-        if (variableDataSize > 0) {
-            intervalHeader.value = static_cast<interval_value_t>(varOffset);
+        auto type = static_cast<std::uint32_t>(interval->getType());
+        auto key = static_cast<std::uint32_t>(KEY_EXTENDED);
+
+        if (extensionSize == 0) {
+            key = static_cast<std::uint32_t>(interval->getKey());
+        }
+
+        fields.typeKey = (type << 24) | key;
+
+        // point to variable data if there's any
+        if (extensionSize + variableDataSize > 0) {
+            fields.varOffset = static_cast<std::uint32_t>(varOffset);
         }
 
         // write interval header
-        std::memcpy(headPtr, &intervalHeader, sizeof(intervalHeader));
-        headPtr += sizeof(intervalHeader);
+        this->writeIntervalHeader(headPtr, fields, node.getBegin(),
+                                  isRelative);
+        headPtr += intervalHeaderSize;
+
+        // write extended key and fixed value (only key if wide values)
+        if (extensionSize > 0) {
+            nodeHeader.childrenCountFlags |=
+                NodeHeader::FLAG_INTERVAL_EXTENSIONS_MASK;
+
+            std::uint64_t key = interval->getKey();
+            std::memcpy(varAtPtr, &key, sizeof(key));
+
+            if (!_wideValues) {
+                std::uint64_t value = interval->getFixedValue();
+                std::memcpy(varAtPtr + sizeof(key), &value, sizeof(value));
+            }
+        }
 
         // write variable data
         if (variableDataSize > 0) {
-            interval->serializeVariableData(varAtPtr);
+            interval->serializeVariableData(varAtPtr + extensionSize);
         }
     }
+
+    // write node header
+    std::memcpy(nodeHeaderPtr, &nodeHeader, sizeof(nodeHeader));
 }
 
 Node::UP AlignedNodeSerDes::deserializeNodeImpl(const std::uint8_t* headPtr,
@@ -116,24 +181,53 @@ Node::UP AlignedNodeSerDes::deserializeNodeImpl(const std::uint8_t* headPtr,
     }
 
     // add intervals
+    auto isRelative = nodeHeader.isRelative();
+    auto intervalHeaderSize = this->getIntervalHeaderSize(isRelative);
+
     for (std::size_t x = 0; x < nodeHeader.intervalCount; ++x) {
         // read interval header
-        IntervalHeader intervalHeader;
-        std::memcpy(&intervalHeader, headPtr, sizeof(intervalHeader));
-        headPtr += sizeof(intervalHeader);
+        IntervalFields fields;
+        this->readIntervalHeader(headPtr, fields, nodeHeader.begin,
+                                 isRelative);
+        headPtr += intervalHeaderSize;
+
+        // read extended key and fixed value (only key if wide values)
+        auto key = fields.getKey();
+        auto value = fields.value;
+        auto varAtPtr = varEndPtr - static_cast<std::size_t>(fields.varOffset);
+
+        if (nodeHeader.hasIntervalExtensions() && fields.isExtended()) {
+            std::uint64_t extendedKey;
+            std::memcpy(&extendedKey, varAtPtr, sizeof(extendedKey));
+            key = static_cast<interval_key_t>(extendedKey);
+            varAtPtr += sizeof(extendedKey);
+
+            if (!_wideValues) {
+                std::uint64_t extendedValue;
+                std::memcpy(&extendedValue, varAtPtr, sizeof(extendedValue));
+                value = static_cast<interval_value_t>(extendedValue);
+                varAtPtr += sizeof(extendedValue);
+            }
+        }
+
+        // legacy 64-bit value: 8 bytes of variable data
+        auto isLegacyValue = !nodeHeader.hasInlineValues() &&
+                             isLegacyVariableValueType(fields.getType());
+
+        if (isLegacyValue) {
+            std::uint64_t legacyValue;
+            std::memcpy(&legacyValue, varAtPtr, sizeof(legacyValue));
+            value = static_cast<interval_value_t>(legacyValue);
+        }
 
         // create interval
-        auto interval = this->createInterval(intervalHeader.begin,
-                                             intervalHeader.end,
-                                             intervalHeader.getKey(),
-                                             intervalHeader.getType());
+        auto interval = this->createInterval(fields.begin, fields.end, key,
+                                             fields.getType());
 
         // set fixed value
-        interval->setFixedValue(intervalHeader.value);
+        interval->setFixedValue(value);
 
         // deserialize variable data
-        auto varDataOffset = static_cast<std::size_t>(interval->getFixedValue());
-        auto varAtPtr = varEndPtr - varDataOffset;
         interval->deserializeVariableData(varAtPtr);
 
         // add interval to node
@@ -141,6 +235,11 @@ Node::UP AlignedNodeSerDes::deserializeNodeImpl(const std::uint8_t* headPtr,
         node->addInterval(intervalSp);
     }
 
+    // extended node: `size` is its extended size
+    if (nodeHeader.isExtended()) {
+        node->extend(size);
+    }
+
     // close if necessary
     if (nodeHeader.isClosed()) {
         node->close(nodeHeader.end);
@@ -149,6 +248,88 @@ Node::UP AlignedNodeSerDes::deserializeNodeImpl(const std::uint8_t* headPtr,
     return node;
 }
 
+std::size_t AlignedNodeSerDes::getIntervalExtensionSize(const AbstractInterval& interval) const
+{
+    // extended part: 64-bit key, then 64-bit fixed value if not wide
+    auto extensionSize = sizeof(std::uint64_t);
+
+    if (!_wideValues) {
+        extensionSize += sizeof(std::uint64_t);
+    }
+
+    if (interval.getKey() >= KEY_EXTENDED) {
+        return extensionSize;
+    }
+
+    /* Wide values are always inline, and the fixed value is
+     * meaningless with variable data.
+     */
+    if (_wideValues || interval.getVariableDataSize() > 0) {
+        return 0;
+    }
+
+    auto value = static_cast<std::int64_t>(interval.getFixedValue());
+
+    if (value != static_cast<std::int32_t>(value)) {
+        return extensionSize;
+    }
+
+    return 0;
+}
+
+std::size_t AlignedNodeSerDes::getIntervalHeaderSize(bool isRelative) const
+{
+    if (_wideValues) {
+        return isRelative ? sizeof(RelativeWideIntervalHeader) :
+                            sizeof(WideIntervalHeader);
+    }
+
+    return isRelative ? sizeof(RelativeIntervalHeader) :
+                        sizeof(IntervalHeader);
+}
+
+void AlignedNodeSerDes::writeIntervalHeader(std::uint8_t* headPtr,
+                                            const IntervalFields& fields,
+                                            timestamp_t nodeBegin,
+                                            bool isRelative) const
+{
+    if (_wideValues) {
+        if (isRelative) {
+            writeHeader<RelativeWideIntervalHeader>(headPtr, fields,
+                                                    nodeBegin);
+        } else {
+            writeHeader<WideIntervalHeader>(headPtr, fields, nodeBegin);
+        }
+    } else {
+        if (isRelative) {
+            writeHeader<RelativeIntervalHeader>(headPtr, fields, nodeBegin);
+        } else {
+            writeHeader<IntervalHeader>(headPtr, fields, nodeBegin);
+        }
+    }
+}
+
+void AlignedNodeSerDes::readIntervalHeader(const std::uint8_t* headPtr,
+                                           IntervalFields& fields,
+                                           timestamp_t nodeBegin,
+                                           bool isRelative) const
+{
+    if (_wideValues) {
+        if (isRelative) {
+            readHeader<RelativeWideIntervalHeader>(headPtr, fields,
+                                                   nodeBegin);
+        } else {
+            readHeader<WideIntervalHeader>(headPtr, fields, nodeBegin);
+        }
+    } else {
+        if (isRelative) {
+            readHeader<RelativeIntervalHeader>(headPtr, fields, nodeBegin);
+        } else {
+            readHeader<IntervalHeader>(headPtr, fields, nodeBegin);
+        }
+    }
+}
+
 std::size_t AlignedNodeSerDes::getHeaderSizeImpl(const Node& node) const
 {
     /* This is a, hopefully temporary, hack to make sure the maximum number
@@ -163,9 +344,53 @@ std::size_t AlignedNodeSerDes::getChildNodePointerSizeImpl(const ChildNodePointe
     return sizeof(ChildNodePointerHeader);
 }
 
+bool AlignedNodeSerDes::hasRelativeTimestamps(const Node& node) const
+{
+    if (!_relativeTimestamps) {
+        return false;
+    }
+
+    // intervals are sorted by end time: the last one ends last
+    const auto& intervals = node.getIntervals();
+
+    if (intervals.empty()) {
+        return true;
+    }
+
+    return fitsRelative(node.getBegin(), intervals.back()->getEnd());
+}
+
+bool AlignedNodeSerDes::isLegacyVariableValueType(interval_type_t type)
+{
+    return type == static_cast<interval_type_t>(StandardIntervalType::INT64) ||
+           type == static_cast<interval_type_t>(StandardIntervalType::UINT64);
+}
+
+std::size_t AlignedNodeSerDes::getIntervalSizeInNodeImpl(const Node& node,
+                                                         const AbstractInterval& interval) const
+{
+    auto size = this->getIntervalSizeImpl(interval);
+
+    if (!this->hasRelativeTimestamps(node)) {
+        return size;
+    }
+
+    auto relativeSaving = this->getIntervalHeaderSize(false) -
+                          this->getIntervalHeaderSize(true);
+
+    if (fitsRelative(node.getBegin(), interval.getEnd())) {
+        return size - relativeSaving;
+    }
+
+    // node's previous intervals get absolute timestamps too
+    return size + node.getIntervalCount() * relativeSaving;
+}
+
 std::size_t AlignedNodeSerDes::getIntervalSizeImpl(const AbstractInterval& interval) const
 {
-    return sizeof(IntervalHeader) + interval.getVariableDataSize();
+    return this->getIntervalHeaderSize(false) +
+           this->getIntervalExtensionSize(interval) +
+           interval.getVariableDataSize();
 }
 
 }
@@ -0,0 +1,241 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <algorithm>
+#include <iterator>
+
+#include <delorean/node/AbstractNodeCache.hpp>
+#include <delorean/node/ArcNodeCache.hpp>
+#include <delorean/node/Node.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+ArcNodeCache::ArcNodeCache(std::size_t size) :
+    AbstractNodeCache {size},
+    _t1Target {0}
+{
+    _locations.reserve(size * 2 + 1);
+}
+
+ArcNodeCache::EntryList& ArcNodeCache::getList(Queue queue)
+{
+    switch (queue) {
+    case Queue::T1:
+        return _t1List;
+
+    case Queue::T2:
+        return _t2List;
+
+    case Queue::B1:
+        return _b1List;
+
+    default:
+        return _b2List;
+    }
+}
+
+void ArcNodeCache::moveToFront(Location& location, Queue queue)
+{
+    auto& list = this->getList(queue);
+
+    list.splice(list.begin(), this->getList(location.queue), location.it);
+    location.queue = queue;
+
+    // ghost lists only remember sequence numbers
+    if (queue == Queue::B1 || queue == Queue::B2) {
+        this->nodeRemoved(location.it->memorySize);
+        location.it->node = nullptr;
+    }
+}
+
+void ArcNodeCache::dropBack(EntryList& list)
+{
+    if (list.back().node) {
+        this->nodeRemoved(list.back().memorySize);
+    }
+
+    _locations.erase(list.back().seqNumber);
+    list.pop_back();
+}
+
+void ArcNodeCache::replace(bool inB2)
+{
+    // only evict when the cache is full
+    if (_t1List.size() + _t2List.size() < this->getSize()) {
+        return;
+    }
+
+    auto t1Size = _t1List.size();
+
+    if (t1Size > 0 && ((inB2 && t1Size == _t1Target) ||
+                       t1Size > _t1Target || _t2List.empty())) {
+        // evict LRU node of T1, remembering it in B1
+        auto& location = _locations[_t1List.back().seqNumber];
+        this->moveToFront(location, Queue::B1);
+    } else {
+        // evict LRU node of T2, remembering it in B2
+        auto& location = _locations[_t2List.back().seqNumber];
+        this->moveToFront(location, Queue::B2);
+    }
+}
+
+Node::SP ArcNodeCache::getNodeImpl(node_seq_t seqNumber)
+{
+    auto size = this->getSize();
+
+    if (size == 0) {
+        return this->getNodeFromOwner(seqNumber);
+    }
+
+    auto it = _locations.find(seqNumber);
+
+    if (it != _locations.end() &&
+            (it->second.queue == Queue::T1 || it->second.queue == Queue::T2)) {
+        // hit: accessed at least twice now
+        this->moveToFront(it->second, Queue::T2);
+
+        return it->second.it->node;
+    }
+
+    // miss: nothing changes if the node doesn't exist
+    auto node = this->getNodeFromOwner(seqNumber);
+
+    if (!node) {
+        return node;
+    }
+
+    if (it != _locations.end()) {
+        // ghost hit: adapt T1 target size, then admit into T2
+        auto b1Size = _b1List.size();
+        auto b2Size = _b2List.size();
+        auto inB2 = it->second.queue == Queue::B2;
+
+        if (inB2) {
+            auto delta = std::max(b1Size / b2Size,
+                                  static_cast<std::size_t>(1));
+            _t1Target -= std::min(delta, _t1Target);
+        } else {
+            auto delta = std::max(b2Size / b1Size,
+                                  static_cast<std::size_t>(1));
+            _t1Target = std::min(_t1Target + delta, size);
+        }
+
+        this->replace(inB2);
+
+        auto& location = _locations[seqNumber];
+        this->moveToFront(location, Queue::T2);
+        location.it->node = node;
+        location.it->memorySize = node->getMemorySize();
+        this->nodeAdded(location.it->memorySize);
+
+        return node;
+    }
+
+    // never seen (or forgotten)
+    this->insertNew(seqNumber, node);
+
+    return node;
+}
+
+bool ArcNodeCache::putNodeImpl(node_seq_t seqNumber, Node::SP node)
+{
+    if (this->getSize() == 0) {
+        return false;
+    }
+
+    auto it = _locations.find(seqNumber);
+
+    if (it != _locations.end()) {
+        if (it->second.queue == Queue::T1 || it->second.queue == Queue::T2) {
+            return true;
+        }
+
+        // not an access: forget the ghost entry, then admit as new
+        auto& list = it->second.queue == Queue::B1 ? _b1List : _b2List;
+
+        list.erase(it->second.it);
+        _locations.erase(it);
+    }
+
+    this->insertNew(seqNumber, node);
+
+    return true;
+}
+
+void ArcNodeCache::insertNew(node_seq_t seqNumber, Node::SP node)
+{
+    auto size = this->getSize();
+    auto l1Size = _t1List.size() + _b1List.size();
+    auto totalSize = l1Size + _t2List.size() + _b2List.size();
+
+    if (l1Size >= size) {
+        if (_t1List.size() < size) {
+            this->dropBack(_b1List);
+            this->replace(false);
+        } else {
+            this->dropBack(_t1List);
+        }
+    } else if (totalSize >= size) {
+        if (totalSize >= 2 * size) {
+            this->dropBack(_b2List);
+        }
+
+        this->replace(false);
+    }
+
+    auto memorySize = node->getMemorySize();
+    _t1List.push_front({seqNumber, node, memorySize});
+    this->nodeAdded(memorySize);
+    _locations[seqNumber] = {Queue::T1, _t1List.begin()};
+}
+
+bool ArcNodeCache::nodeIsCachedImpl(node_seq_t seqNumber) const
+{
+    auto it = _locations.find(seqNumber);
+
+    if (it == _locations.end()) {
+        return false;
+    }
+
+    return it->second.queue == Queue::T1 || it->second.queue == Queue::T2;
+}
+
+Node::SP ArcNodeCache::peekNodeImpl(node_seq_t seqNumber) const
+{
+    // no move from T1 to T2: probing isn't an access
+    if (!this->nodeIsCachedImpl(seqNumber)) {
+        return nullptr;
+    }
+
+    return _locations.find(seqNumber)->second.it->node;
+}
+
+void ArcNodeCache::invalidateImpl()
+{
+    _t1List.clear();
+    _t2List.clear();
+    _b1List.clear();
+    _b2List.clear();
+    _locations.clear();
+    _t1Target = 0;
+    this->allNodesRemoved();
+}
+
+}
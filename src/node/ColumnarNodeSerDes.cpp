@@ -0,0 +1,273 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <memory>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <delorean/node/ColumnarNodeSerDes.hpp>
+#include <delorean/node/Node.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+ColumnarNodeSerDes::ColumnarNodeSerDes()
+{
+}
+
+ColumnarNodeSerDes::~ColumnarNodeSerDes()
+{
+}
+
+ColumnarNodeSerDes::Columns ColumnarNodeSerDes::makeColumns(const std::uint8_t* headPtr,
+                                                            std::size_t columnsOffset,
+                                                            std::size_t intervalCount)
+{
+    Columns columns;
+    auto offset = columnsOffset;
+    auto column64Size = intervalCount * sizeof(std::uint64_t);
+
+    columns._intervalCount = intervalCount;
+    columns._begins = headPtr + offset;
+    offset = alignColumn(offset + column64Size);
+    columns._ends = headPtr + offset;
+    offset = alignColumn(offset + column64Size);
+    columns._keys = headPtr + offset;
+    offset = alignColumn(offset + column64Size);
+    columns._values = headPtr + offset;
+    offset = alignColumn(offset + column64Size);
+    columns._types = headPtr + offset;
+
+    return columns;
+}
+
+ColumnarNodeSerDes::Columns ColumnarNodeSerDes::getColumns(const std::uint8_t* headPtr)
+{
+    NodeHeader nodeHeader;
+    std::memcpy(&nodeHeader, headPtr, sizeof(nodeHeader));
+
+    return makeColumns(headPtr, nodeHeader.columnsOffset,
+                       nodeHeader.intervalCount);
+}
+
+bool ColumnarNodeSerDes::findAll(const Columns& columns, timestamp_t ts,
+                                 std::vector<std::size_t>& indexes)
+{
+    // intervals are sorted by end time: find the first one ending after `ts`
+    std::size_t first = 0;
+    std::size_t count = columns.getIntervalCount();
+
+    while (count > 0) {
+        auto half = count / 2;
+
+        if (columns.getEnd(first + half) <= ts) {
+            first += half + 1;
+            count -= half + 1;
+        } else {
+            count = half;
+        }
+    }
+
+    auto initSize = indexes.size();
+
+    for (auto x = first; x < columns.getIntervalCount(); ++x) {
+        if (columns.getBegin(x) <= ts) {
+            indexes.push_back(x);
+        }
+    }
+
+    return indexes.size() > initSize;
+}
+
+bool ColumnarNodeSerDes::findOne(const Columns& columns, timestamp_t ts,
+                                 interval_key_t key, std::size_t& index)
+{
+    std::size_t first = 0;
+    std::size_t count = columns.getIntervalCount();
+
+    while (count > 0) {
+        auto half = count / 2;
+
+        if (columns.getEnd(first + half) <= ts) {
+            first += half + 1;
+            count -= half + 1;
+        } else {
+            count = half;
+        }
+    }
+
+    for (auto x = first; x < columns.getIntervalCount(); ++x) {
+        if (columns.getKey(x) == key && columns.getBegin(x) <= ts) {
+            index = x;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ColumnarNodeSerDes::serializeNodeImpl(const Node& node,
+                                           std::uint8_t* headPtr) const
+{
+    // set end of node pointer now
+    auto varAtPtr = headPtr + node.getSize();
+
+    // build and write node header
+    NodeHeader nodeHeader;
+    nodeHeader.setFromNode(node);
+    nodeHeader.columnsOffset =
+        static_cast<std::uint32_t>(getColumnsOffset(node.getMaxChildren()));
+    std::memcpy(headPtr, &nodeHeader, sizeof(nodeHeader));
+
+    // write children: begin timestamps, then sequence numbers
+    auto childBeginsPtr = headPtr + sizeof(nodeHeader);
+    auto childSeqsPtr = childBeginsPtr +
+                        node.getMaxChildren() * sizeof(timestamp_t);
+    const auto& children = node.getChildren();
+
+    for (std::size_t x = 0; x < children.size(); ++x) {
+        auto begin = children[x].getBegin();
+        auto seqNumber = children[x].getSeqNumber();
+        std::memcpy(childBeginsPtr + x * sizeof(begin), &begin, sizeof(begin));
+        std::memcpy(childSeqsPtr + x * sizeof(seqNumber), &seqNumber,
+                    sizeof(seqNumber));
+    }
+
+    // write interval columns
+    const auto& intervals = node.getIntervals();
+    auto columns = makeColumns(headPtr, nodeHeader.columnsOffset,
+                               intervals.size());
+    auto begins = const_cast<std::uint8_t*>(columns._begins);
+    auto ends = const_cast<std::uint8_t*>(columns._ends);
+    auto keys = const_cast<std::uint8_t*>(columns._keys);
+    auto values = const_cast<std::uint8_t*>(columns._values);
+    auto types = const_cast<std::uint8_t*>(columns._types);
+    std::size_t varOffset = 0;
+
+    for (std::size_t x = 0; x < intervals.size(); ++x) {
+        const auto& interval = *intervals[x];
+        auto begin = interval.getBegin();
+        auto end = interval.getEnd();
+        auto key = interval.getKey();
+        auto value = interval.getFixedValue();
+        auto variableDataSize = interval.getVariableDataSize();
+
+        // variable data goes at the end, located by the fixed value
+        if (variableDataSize > 0) {
+            varAtPtr -= variableDataSize;
+            varOffset += variableDataSize;
+            value = static_cast<interval_value_t>(varOffset);
+            interval.serializeVariableData(varAtPtr);
+        }
+
+        std::memcpy(begins + x * sizeof(begin), &begin, sizeof(begin));
+        std::memcpy(ends + x * sizeof(end), &end, sizeof(end));
+        std::memcpy(keys + x * sizeof(key), &key, sizeof(key));
+        std::memcpy(values + x * sizeof(value), &value, sizeof(value));
+        types[x] = static_cast<std::uint8_t>(interval.getType());
+    }
+}
+
+Node::UP ColumnarNodeSerDes::deserializeNodeImpl(const std::uint8_t* headPtr,
+                                                 std::size_t size,
+                                                 std::size_t maxChildren) const
+{
+    // set end of node pointer now
+    auto varEndPtr = headPtr + size;
+
+    // read header
+    NodeHeader nodeHeader;
+    std::memcpy(&nodeHeader, headPtr, sizeof(nodeHeader));
+
+    // create node
+    auto node = this->createNode(size, maxChildren, nodeHeader.seqNumber,
+                                 nodeHeader.parentSeqNumber, nodeHeader.begin);
+
+    // add children
+    auto childBeginsPtr = headPtr + sizeof(nodeHeader);
+    auto childSeqsPtr = childBeginsPtr + maxChildren * sizeof(timestamp_t);
+
+    for (std::size_t x = 0; x < nodeHeader.getChildrenCount(); ++x) {
+        timestamp_t begin;
+        node_seq_t seqNumber;
+        std::memcpy(&begin, childBeginsPtr + x * sizeof(begin), sizeof(begin));
+        std::memcpy(&seqNumber, childSeqsPtr + x * sizeof(seqNumber),
+                    sizeof(seqNumber));
+        node->addChild(begin, seqNumber);
+    }
+
+    // add intervals
+    auto columns = makeColumns(headPtr, nodeHeader.columnsOffset,
+                               nodeHeader.intervalCount);
+
+    for (std::size_t x = 0; x < columns.getIntervalCount(); ++x) {
+        // create interval
+        auto interval = this->createInterval(columns.getBegin(x),
+                                             columns.getEnd(x),
+                                             columns.getKey(x),
+                                             columns.getType(x));
+
+        // set fixed value
+        auto value = columns.getValue(x);
+        interval->setFixedValue(value);
+
+        // deserialize variable data
+        auto varAtPtr = varEndPtr - static_cast<std::size_t>(value);
+        interval->deserializeVariableData(varAtPtr);
+
+        // add interval to node
+        AbstractInterval::SP intervalSp {std::move(interval)};
+        node->addInterval(intervalSp);
+    }
+
+    // extended node: `size` is its extended size
+    if (nodeHeader.isExtended()) {
+        node->extend(size);
+    }
+
+    // close if necessary
+    if (nodeHeader.isClosed()) {
+        node->close(nodeHeader.end);
+    }
+
+    return node;
+}
+
+std::size_t ColumnarNodeSerDes::getHeaderSizeImpl(const Node& node) const
+{
+    /* Room for the maximum number of children, and for the padding
+     * before each interval column but the first one.
+     */
+    return getColumnsOffset(node.getMaxChildren()) +
+           4 * (COLUMN_ALIGNMENT - 1);
+}
+
+std::size_t ColumnarNodeSerDes::getChildNodePointerSizeImpl(const ChildNodePointer& cnp) const
+{
+    // already part of the header size
+    return 0;
+}
+
+std::size_t ColumnarNodeSerDes::getIntervalSizeImpl(const AbstractInterval& interval) const
+{
+    return intervalColumnsSize() + interval.getVariableDataSize();
+}
+
+}
@@ -0,0 +1,279 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <delorean/node/CompactNodeSerDes.hpp>
+#include <delorean/node/Node.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+namespace
+{
+
+typedef std::make_signed<interval_value_t>::type signed_value_t;
+
+std::size_t varUintSize(std::uint64_t value)
+{
+    std::size_t size = 1;
+
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+
+    return size;
+}
+
+std::uint8_t* writeVarUint(std::uint8_t* ptr, std::uint64_t value)
+{
+    while (value >= 0x80) {
+        *ptr++ = static_cast<std::uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+
+    *ptr++ = static_cast<std::uint8_t>(value);
+
+    return ptr;
+}
+
+const std::uint8_t* readVarUint(const std::uint8_t* ptr, std::uint64_t& value)
+{
+    value = 0;
+
+    for (unsigned int shift = 0; shift < 64; shift += 7) {
+        auto byte = *ptr++;
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+
+    return ptr;
+}
+
+std::uint64_t zigZag(std::int64_t value)
+{
+    return (static_cast<std::uint64_t>(value) << 1) ^
+           static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t unZigZag(std::uint64_t value)
+{
+    return static_cast<std::int64_t>(value >> 1) ^
+           -static_cast<std::int64_t>(value & 1);
+}
+
+// wrapping difference of two timestamps, zigzag-encoded
+std::uint64_t tsDelta(timestamp_t ts, timestamp_t from)
+{
+    auto delta = static_cast<std::uint64_t>(ts) -
+                 static_cast<std::uint64_t>(from);
+
+    return zigZag(static_cast<std::int64_t>(delta));
+}
+
+timestamp_t tsFromDelta(std::uint64_t delta, timestamp_t from)
+{
+    auto ts = static_cast<std::uint64_t>(from) +
+              static_cast<std::uint64_t>(unZigZag(delta));
+
+    return static_cast<timestamp_t>(ts);
+}
+
+std::uint64_t encodeValue(interval_value_t value)
+{
+    return zigZag(static_cast<signed_value_t>(value));
+}
+
+interval_value_t decodeValue(std::uint64_t value)
+{
+    auto signedValue = static_cast<signed_value_t>(unZigZag(value));
+
+    return static_cast<interval_value_t>(signedValue);
+}
+
+std::uint64_t duration(const AbstractInterval& interval)
+{
+    return static_cast<std::uint64_t>(interval.getEnd()) -
+           static_cast<std::uint64_t>(interval.getBegin());
+}
+
+}
+
+CompactNodeSerDes::CompactNodeSerDes()
+{
+}
+
+CompactNodeSerDes::~CompactNodeSerDes()
+{
+}
+
+void CompactNodeSerDes::serializeNodeImpl(const Node& node,
+                                          std::uint8_t* headPtr) const
+{
+    // write node header
+    NodeHeader nodeHeader;
+    nodeHeader.setFromNode(node);
+    std::memcpy(headPtr, &nodeHeader, sizeof(nodeHeader));
+    headPtr += sizeof(nodeHeader);
+
+    // write children
+    auto prevBegin = node.getBegin();
+
+    for (const auto& child : node.getChildren()) {
+        headPtr = writeVarUint(headPtr, tsDelta(child.getBegin(), prevBegin));
+        headPtr = writeVarUint(headPtr, child.getSeqNumber());
+        prevBegin = child.getBegin();
+    }
+
+    // write intervals
+    auto prevEnd = node.getBegin();
+
+    for (const auto& interval : node.getIntervals()) {
+        headPtr = writeVarUint(headPtr, tsDelta(interval->getEnd(), prevEnd));
+        headPtr = writeVarUint(headPtr, duration(*interval));
+        *headPtr++ = interval->getType();
+        headPtr = writeVarUint(headPtr, interval->getKey());
+        headPtr = writeVarUint(headPtr,
+                               encodeValue(interval->getFixedValue()));
+
+        // write variable data inline
+        auto variableDataSize = interval->getVariableDataSize();
+        if (variableDataSize > 0) {
+            interval->serializeVariableData(headPtr);
+            headPtr += variableDataSize;
+        }
+
+        prevEnd = interval->getEnd();
+    }
+}
+
+Node::UP CompactNodeSerDes::deserializeNodeImpl(const std::uint8_t* headPtr,
+                                                std::size_t size,
+                                                std::size_t maxChildren) const
+{
+    // read header
+    NodeHeader nodeHeader;
+    std::memcpy(&nodeHeader, headPtr, sizeof(nodeHeader));
+    headPtr += sizeof(nodeHeader);
+
+    // create node
+    auto node = this->createNode(size, maxChildren, nodeHeader.seqNumber,
+                                 nodeHeader.parentSeqNumber, nodeHeader.begin);
+
+    // add children
+    auto prevBegin = nodeHeader.begin;
+
+    for (std::size_t x = 0; x < nodeHeader.getChildrenCount(); ++x) {
+        std::uint64_t beginDelta;
+        std::uint64_t seqNumber;
+
+        headPtr = readVarUint(headPtr, beginDelta);
+        headPtr = readVarUint(headPtr, seqNumber);
+        prevBegin = tsFromDelta(beginDelta, prevBegin);
+        node->addChild(prevBegin, static_cast<node_seq_t>(seqNumber));
+    }
+
+    // add intervals
+    auto prevEnd = nodeHeader.begin;
+
+    for (std::size_t x = 0; x < nodeHeader.intervalCount; ++x) {
+        std::uint64_t endDelta;
+        std::uint64_t duration;
+        std::uint64_t key;
+        std::uint64_t value;
+
+        headPtr = readVarUint(headPtr, endDelta);
+        headPtr = readVarUint(headPtr, duration);
+        auto type = static_cast<interval_type_t>(*headPtr++);
+        headPtr = readVarUint(headPtr, key);
+        headPtr = readVarUint(headPtr, value);
+
+        // create interval
+        auto end = tsFromDelta(endDelta, prevEnd);
+        auto begin = static_cast<timestamp_t>(static_cast<std::uint64_t>(end) -
+                                              duration);
+        auto interval = this->createInterval(begin, end,
+                                             static_cast<interval_key_t>(key),
+                                             type);
+
+        // set fixed value and read variable data, if any
+        interval->setFixedValue(decodeValue(value));
+        interval->deserializeVariableData(headPtr);
+        headPtr += interval->getVariableDataSize();
+
+        // add interval to node
+        AbstractInterval::SP intervalSp {std::move(interval)};
+        node->addInterval(intervalSp);
+        prevEnd = end;
+    }
+
+    // extended node: `size` is its extended size
+    if (nodeHeader.isExtended()) {
+        node->extend(size);
+    }
+
+    // close if necessary
+    if (nodeHeader.isClosed()) {
+        node->close(nodeHeader.end);
+    }
+
+    return node;
+}
+
+std::size_t CompactNodeSerDes::getHeaderSizeImpl(const Node& node) const
+{
+    // children are accounted for here: see getChildNodePointerSizeImpl()
+    return sizeof(NodeHeader) +
+        node.getMaxChildren() * MAX_CHILD_NODE_POINTER_SIZE;
+}
+
+std::size_t CompactNodeSerDes::getChildNodePointerSizeImpl(const ChildNodePointer& cnp) const
+{
+    // already reserved in the header size
+    return 0;
+}
+
+std::size_t CompactNodeSerDes::getIntervalSizeImpl(const AbstractInterval& interval) const
+{
+    // largest possible size, without knowing the node
+    return MAX_TIMESTAMP_SIZE + MAX_TIMESTAMP_SIZE + 1 + MAX_KEY_SIZE +
+        MAX_VALUE_SIZE + interval.getVariableDataSize();
+}
+
+std::size_t CompactNodeSerDes::getIntervalSizeInNodeImpl(const Node& node,
+                                                         const AbstractInterval& interval) const
+{
+    const auto& intervals = node.getIntervals();
+    auto prevEnd = intervals.empty() ? node.getBegin() :
+                   intervals.back()->getEnd();
+
+    return varUintSize(tsDelta(interval.getEnd(), prevEnd)) +
+        varUintSize(duration(interval)) + 1 +
+        varUintSize(interval.getKey()) +
+        varUintSize(encodeValue(interval.getFixedValue())) +
+        interval.getVariableDataSize();
+}
+
+}
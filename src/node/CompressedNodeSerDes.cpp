@@ -0,0 +1,138 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+#include <delorean/node/CompressedNodeSerDes.hpp>
+#include <delorean/node/LzCodec.hpp>
+#include <delorean/node/Node.hpp>
+#include <delorean/ex/IO.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+namespace
+{
+
+/* Per-thread compact image of the node being serialized or
+ * deserialized: decoding happens on cache misses, so don't allocate it
+ * for each node.
+ */
+std::vector<std::uint8_t>& getScratchImage(std::size_t size)
+{
+    static thread_local std::vector<std::uint8_t> image;
+
+    if (image.size() < size) {
+        image.resize(size);
+    }
+
+    return image;
+}
+
+}
+
+CompressedNodeSerDes::CompressedNodeSerDes()
+{
+}
+
+CompressedNodeSerDes::~CompressedNodeSerDes()
+{
+}
+
+void CompressedNodeSerDes::serializeNodeImpl(const Node& node,
+                                             std::uint8_t* headPtr) const
+{
+    /* The compact image never exceeds the node's size minus the length
+     * field (reserved in the header size), and the rest of it is left
+     * zeroed, which compresses to almost nothing.
+     */
+    auto imageSize = node.getSize() - LENGTH_FIELD_SIZE;
+    auto& image = getScratchImage(node.getSize());
+
+    std::fill(image.begin(), image.begin() + node.getSize(), 0);
+    CompactNodeSerDes::serializeNodeImpl(node, image.data());
+
+    // compress, or store as is if it doesn't get smaller
+    auto payloadPtr = headPtr + LENGTH_FIELD_SIZE;
+    auto payloadSize = LzCodec::compress(image.data(), imageSize, payloadPtr,
+                                         imageSize - 1);
+    std::uint32_t lengthField = static_cast<std::uint32_t>(payloadSize);
+
+    if (payloadSize == 0) {
+        std::memcpy(payloadPtr, image.data(), imageSize);
+        payloadSize = imageSize;
+        lengthField = static_cast<std::uint32_t>(imageSize) | FLAG_STORED_MASK;
+    }
+
+    std::memcpy(headPtr, &lengthField, sizeof(lengthField));
+
+    // zero the rest of the node
+    auto serializedSize = LENGTH_FIELD_SIZE + payloadSize;
+    std::memset(headPtr + serializedSize, 0, node.getSize() - serializedSize);
+}
+
+Node::UP CompressedNodeSerDes::deserializeNodeImpl(const std::uint8_t* headPtr,
+                                                   std::size_t size,
+                                                   std::size_t maxChildren) const
+{
+    std::uint32_t lengthField;
+    std::memcpy(&lengthField, headPtr, sizeof(lengthField));
+
+    auto imageSize = size - LENGTH_FIELD_SIZE;
+    auto payloadSize = static_cast<std::size_t>(lengthField & LENGTH_MASK);
+    auto payloadPtr = headPtr + LENGTH_FIELD_SIZE;
+    auto& image = getScratchImage(size);
+
+    if (lengthField & FLAG_STORED_MASK) {
+        if (payloadSize != imageSize) {
+            throw ex::IO("Invalid stored node length");
+        }
+
+        std::memcpy(image.data(), payloadPtr, imageSize);
+    } else if (payloadSize >= imageSize ||
+            !LzCodec::decompress(payloadPtr, payloadSize, image.data(),
+                                 imageSize)) {
+        throw ex::IO("Cannot decompress node");
+    }
+
+    // what follows the image is zeroed, as when it was serialized
+    std::fill(image.begin() + imageSize, image.begin() + size, 0);
+
+    return CompactNodeSerDes::deserializeNodeImpl(image.data(), size,
+                                                  maxChildren);
+}
+
+std::size_t CompressedNodeSerDes::getHeaderSizeImpl(const Node& node) const
+{
+    return CompactNodeSerDes::getHeaderSizeImpl(node) + LENGTH_FIELD_SIZE;
+}
+
+std::size_t CompressedNodeSerDes::getSerializedSizeImpl(const std::uint8_t* headPtr,
+                                                        std::size_t size) const
+{
+    std::uint32_t lengthField;
+    std::memcpy(&lengthField, headPtr, sizeof(lengthField));
+
+    return LENGTH_FIELD_SIZE + (lengthField & LENGTH_MASK);
+}
+
+}
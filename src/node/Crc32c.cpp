@@ -0,0 +1,143 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <delorean/node/Crc32c.hpp>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define DELO_CRC32C_SSE42
+#endif
+
+namespace delo
+{
+
+namespace
+{
+
+// reflected Castagnoli polynomial
+const std::uint32_t POLY = 0x82f63b78;
+
+struct Table
+{
+    Table()
+    {
+        for (std::uint32_t x = 0; x < 256; ++x) {
+            auto crc = x;
+
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ (POLY & (0 - (crc & 1)));
+            }
+
+            entries[x] = crc;
+        }
+    }
+
+    std::uint32_t entries[256];
+};
+
+const Table TABLE;
+
+std::uint32_t updateSoftware(std::uint32_t crc, const std::uint8_t* data,
+                             std::size_t size)
+{
+    for (std::size_t x = 0; x < size; ++x) {
+        crc = TABLE.entries[(crc ^ data[x]) & 0xff] ^ (crc >> 8);
+    }
+
+    return crc;
+}
+
+#ifdef DELO_CRC32C_SSE42
+__attribute__((target("sse4.2")))
+std::uint32_t updateHardware(std::uint32_t crc, const std::uint8_t* data,
+                             std::size_t size)
+{
+# ifdef __x86_64__
+    std::uint64_t crc64 = crc;
+
+    while (size >= 8) {
+        std::uint64_t word;
+
+        std::memcpy(&word, data, sizeof(word));
+        crc64 = __builtin_ia32_crc32di(crc64, word);
+        data += 8;
+        size -= 8;
+    }
+
+    crc = static_cast<std::uint32_t>(crc64);
+# endif
+
+    while (size >= 4) {
+        std::uint32_t word;
+
+        std::memcpy(&word, data, sizeof(word));
+        crc = __builtin_ia32_crc32si(crc, word);
+        data += 4;
+        size -= 4;
+    }
+
+    while (size > 0) {
+        crc = __builtin_ia32_crc32qi(crc, *data);
+        data++;
+        size--;
+    }
+
+    return crc;
+}
+#endif
+
+typedef std::uint32_t (*UpdateFunc)(std::uint32_t, const std::uint8_t*,
+                                    std::size_t);
+
+UpdateFunc selectUpdateFunc()
+{
+#ifdef DELO_CRC32C_SSE42
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("sse4.2")) {
+        return updateHardware;
+    }
+#endif
+
+    return updateSoftware;
+}
+
+const UpdateFunc UPDATE_FUNC = selectUpdateFunc();
+
+}
+
+std::uint32_t Crc32c::compute(const std::uint8_t* data, std::size_t size,
+                              std::uint32_t crc)
+{
+    return ~UPDATE_FUNC(~crc, data, size);
+}
+
+std::uint32_t Crc32c::computeSoftware(const std::uint8_t* data,
+                                      std::size_t size, std::uint32_t crc)
+{
+    return ~updateSoftware(~crc, data, size);
+}
+
+bool Crc32c::isHardwareAccelerated()
+{
+    return UPDATE_FUNC != updateSoftware;
+}
+
+}
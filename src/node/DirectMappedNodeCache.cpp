@@ -38,6 +38,7 @@ DirectMappedNodeCache::DirectMappedNodeCache(std::size_t size) :
 
     // resize cache vector now
     _cache.resize(size);
+    _memorySizes.resize(size);
 }
 
 Node::SP DirectMappedNodeCache::getNodeImpl(node_seq_t seqNumber)
@@ -53,7 +54,15 @@ Node::SP DirectMappedNodeCache::getNodeImpl(node_seq_t seqNumber)
             /* Do not overwrite something else in cache if the node
              * doesn't even exist.
              */
+            if (_cache[pos]) {
+                // another node maps to the same entry
+                this->nodeRemoved(_memorySizes[pos]);
+                this->collisionOccurred();
+            }
+
             _cache[pos] = node;
+            _memorySizes[pos] = node->getMemorySize();
+            this->nodeAdded(_memorySizes[pos]);
         }
     } else {
         node = _cache[pos];
@@ -62,6 +71,26 @@ Node::SP DirectMappedNodeCache::getNodeImpl(node_seq_t seqNumber)
     return node;
 }
 
+bool DirectMappedNodeCache::putNodeImpl(node_seq_t seqNumber, Node::SP node)
+{
+    if (this->nodeIsCached(seqNumber)) {
+        return true;
+    }
+
+    auto pos = cachePosForSeqNumber(seqNumber);
+
+    if (_cache[pos]) {
+        this->nodeRemoved(_memorySizes[pos]);
+        this->collisionOccurred();
+    }
+
+    _cache[pos] = node;
+    _memorySizes[pos] = node->getMemorySize();
+    this->nodeAdded(_memorySizes[pos]);
+
+    return true;
+}
+
 bool DirectMappedNodeCache::nodeIsCachedImpl(node_seq_t seqNumber) const
 {
     const auto& node = _cache[this->cachePosForSeqNumber(seqNumber)];
@@ -73,11 +102,22 @@ bool DirectMappedNodeCache::nodeIsCachedImpl(node_seq_t seqNumber) const
     return node->getSeqNumber() == seqNumber;
 }
 
+Node::SP DirectMappedNodeCache::peekNodeImpl(node_seq_t seqNumber) const
+{
+    if (!this->nodeIsCachedImpl(seqNumber)) {
+        return nullptr;
+    }
+
+    return _cache[this->cachePosForSeqNumber(seqNumber)];
+}
+
 void DirectMappedNodeCache::invalidateImpl()
 {
     for (auto& node : _cache) {
         node = nullptr;
     }
+
+    this->allNodesRemoved();
 }
 
 }
@@ -17,8 +17,8 @@
  * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <cstddef>
-#include <stdexcept>
-#include <iostream>
+#include <cstdint>
+#include <algorithm>
 
 #include <delorean/node/AbstractNodeCache.hpp>
 #include <delorean/node/LruNodeCache.hpp>
@@ -27,56 +27,242 @@
 
 namespace delo {
 
-LruNodeCache::LruNodeCache(std::size_t size) :
-    AbstractNodeCache {size}
+const LruNodeCache::index_t LruNodeCache::NONE;
+
+LruNodeCache::LruNodeCache(std::size_t size, std::size_t byteBudget) :
+    AbstractNodeCache {size, byteBudget},
+    _entries(size),
+    _head {NONE},
+    _tail {NONE}
+{
+    this->resetFreeList();
+
+    // hash table: at most half full
+    std::size_t tableSize = 2;
+    unsigned int tableBits = 1;
+
+    while (tableSize < size * 2) {
+        tableSize <<= 1;
+        tableBits++;
+    }
+
+    _table.assign(tableSize, NONE);
+    _tableMask = tableSize - 1;
+    _tableShift = 32 - tableBits;
+}
+
+std::size_t LruNodeCache::findSlot(node_seq_t seqNumber) const
+{
+    auto slot = this->getHomeSlot(seqNumber);
+
+    while (_table[slot] != NONE) {
+        if (_entries[_table[slot]].seqNumber == seqNumber) {
+            return slot;
+        }
+
+        slot = (slot + 1) & _tableMask;
+    }
+
+    return slot;
+}
+
+void LruNodeCache::removeFromTable(std::size_t slot)
+{
+    /* Backward shift deletion: move back the following entries of the
+     * same cluster which would not be reachable anymore from their home
+     * slot, so that no tombstone is needed.
+     */
+    auto next = slot;
+
+    while (true) {
+        next = (next + 1) & _tableMask;
+
+        if (_table[next] == NONE) {
+            break;
+        }
+
+        auto home = this->getHomeSlot(_entries[_table[next]].seqNumber);
+
+        // distance from home, modulo table size
+        auto slotDist = (slot - home) & _tableMask;
+        auto nextDist = (next - home) & _tableMask;
+
+        if (slotDist < nextDist) {
+            _table[slot] = _table[next];
+            slot = next;
+        }
+    }
+
+    _table[slot] = NONE;
+}
+
+void LruNodeCache::resetFreeList()
+{
+    _free = _entries.empty() ? NONE : 0;
+
+    for (std::size_t index = 0; index < _entries.size(); ++index) {
+        auto next = index + 1;
+        _entries[index].next = next < _entries.size() ?
+                               static_cast<index_t>(next) : NONE;
+    }
+}
+
+void LruNodeCache::dropLeastRecentlyUsed()
+{
+    auto index = _tail;
+    auto& entry = _entries[index];
+
+    this->unlink(index);
+    this->removeFromTable(this->findSlot(entry.seqNumber));
+    this->nodeRemoved(entry.memorySize);
+    entry.node = nullptr;
+    entry.next = _free;
+    _free = index;
+}
+
+void LruNodeCache::unlink(index_t index)
+{
+    auto& entry = _entries[index];
+
+    if (entry.prev != NONE) {
+        _entries[entry.prev].next = entry.next;
+    } else {
+        _head = entry.next;
+    }
+
+    if (entry.next != NONE) {
+        _entries[entry.next].prev = entry.prev;
+    } else {
+        _tail = entry.prev;
+    }
+}
+
+void LruNodeCache::pushFront(index_t index)
 {
+    auto& entry = _entries[index];
+
+    entry.prev = NONE;
+    entry.next = _head;
+
+    if (_head != NONE) {
+        _entries[_head].prev = index;
+    } else {
+        _tail = index;
+    }
+
+    _head = index;
 }
 
 Node::SP LruNodeCache::getNodeImpl(node_seq_t seqNumber)
 {
-    Node::SP node;
+    if (_entries.empty()) {
+        return this->getNodeFromOwner(seqNumber);
+    }
 
-    // try finding the requested node in our map
-    auto it = _map.find(seqNumber);
+    // try finding the requested node in our table
+    auto slot = this->findSlot(seqNumber);
 
-    if (it != _map.end()) {
+    if (_table[slot] != NONE) {
         // hit: put it back in front
-        auto listIt = it->second;
-        node = *listIt;
-        _list.erase(listIt);
-        _list.push_front(node);
-    } else {
-        // miss
-        node = this->getNodeFromOwner(seqNumber);
-        if (node) {
-            _list.push_front(node);
-            auto newNodeIt = _list.begin();
-            _map[seqNumber] = newNodeIt;
-
-            if (_list.size() > this->getSize()) {
-                auto droppedNode = _list.back();
-                _list.pop_back();
-
-                auto droppedSeqNumber = droppedNode->getSeqNumber();
-                _map.erase(droppedSeqNumber);
-            }
+        auto index = _table[slot];
+
+        if (index != _head) {
+            this->unlink(index);
+            this->pushFront(index);
         }
+
+        return _entries[index].node;
+    }
+
+    // miss
+    auto node = this->getNodeFromOwner(seqNumber);
+
+    if (node) {
+        this->insertNode(seqNumber, node);
     }
 
     return node;
 }
 
+bool LruNodeCache::putNodeImpl(node_seq_t seqNumber, Node::SP node)
+{
+    if (_entries.empty()) {
+        return false;
+    }
+
+    if (_table[this->findSlot(seqNumber)] != NONE) {
+        return true;
+    }
+
+    return this->insertNode(seqNumber, node);
+}
+
+bool LruNodeCache::insertNode(node_seq_t seqNumber, Node::SP node)
+{
+    // larger than the whole budget: keep the cached nodes
+    auto memorySize = node->getMemorySize();
+
+    if (this->exceedsWholeByteBudget(memorySize)) {
+        return false;
+    }
+
+    // drop least recently used nodes until there's room for this one
+    while (_head != NONE &&
+            (_free == NONE || this->exceedsByteBudget(memorySize))) {
+        this->dropLeastRecentlyUsed();
+    }
+
+    // the slot of this node could have moved
+    auto slot = this->findSlot(seqNumber);
+
+    auto index = _free;
+    auto& entry = _entries[index];
+    _free = entry.next;
+    entry.node = node;
+    entry.seqNumber = seqNumber;
+    entry.memorySize = memorySize;
+    this->nodeAdded(memorySize);
+    this->pushFront(index);
+    _table[slot] = index;
+
+    return true;
+}
+
 bool LruNodeCache::nodeIsCachedImpl(node_seq_t seqNumber) const
 {
-    auto it = _map.find(seqNumber);
+    if (_entries.empty()) {
+        return false;
+    }
 
-    return it != _map.end();
+    return _table[this->findSlot(seqNumber)] != NONE;
+}
+
+Node::SP LruNodeCache::peekNodeImpl(node_seq_t seqNumber) const
+{
+    if (_entries.empty()) {
+        return nullptr;
+    }
+
+    auto index = _table[this->findSlot(seqNumber)];
+
+    if (index == NONE) {
+        return nullptr;
+    }
+
+    return _entries[index].node;
 }
 
 void LruNodeCache::invalidateImpl()
 {
-    _list.clear();
-    _map.clear();
+    for (auto& entry : _entries) {
+        entry.node = nullptr;
+    }
+
+    std::fill(_table.begin(), _table.end(), NONE);
+    _head = NONE;
+    _tail = NONE;
+    this->resetFreeList();
+    this->allNodesRemoved();
 }
 
 }
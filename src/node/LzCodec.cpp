@@ -0,0 +1,268 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <delorean/node/LzCodec.hpp>
+
+namespace delo
+{
+
+namespace
+{
+
+std::uint32_t read32(const std::uint8_t* ptr)
+{
+    std::uint32_t value;
+
+    std::memcpy(&value, ptr, sizeof(value));
+
+    return value;
+}
+
+class Output
+{
+public:
+    Output(std::uint8_t* dst, std::size_t capacity) :
+        _ptr {dst},
+        _end {dst + capacity}
+    {
+    }
+
+    bool put(std::uint8_t byte)
+    {
+        if (_ptr == _end) {
+            return false;
+        }
+
+        *_ptr++ = byte;
+
+        return true;
+    }
+
+    bool putLengthExtension(std::size_t length)
+    {
+        while (length >= 255) {
+            if (!this->put(255)) {
+                return false;
+            }
+
+            length -= 255;
+        }
+
+        return this->put(static_cast<std::uint8_t>(length));
+    }
+
+    bool putBytes(const std::uint8_t* src, std::size_t size)
+    {
+        if (static_cast<std::size_t>(_end - _ptr) < size) {
+            return false;
+        }
+
+        std::memcpy(_ptr, src, size);
+        _ptr += size;
+
+        return true;
+    }
+
+    std::uint8_t* getPtr() const
+    {
+        return _ptr;
+    }
+
+private:
+    std::uint8_t* _ptr;
+    std::uint8_t* _end;
+};
+
+bool writeSequence(Output& out, const std::uint8_t* literals,
+                   std::size_t literalCount, std::size_t offset,
+                   std::size_t matchSize, std::size_t minMatchSize)
+{
+    auto matchRest = offset ? matchSize - minMatchSize : 0;
+    auto token = static_cast<std::uint8_t>(
+        (std::min(literalCount, static_cast<std::size_t>(15)) << 4) |
+        std::min(matchRest, static_cast<std::size_t>(15))
+    );
+
+    if (!out.put(token)) {
+        return false;
+    }
+
+    if (literalCount >= 15 && !out.putLengthExtension(literalCount - 15)) {
+        return false;
+    }
+
+    if (!out.putBytes(literals, literalCount)) {
+        return false;
+    }
+
+    if (!offset) {
+        // last sequence: literals only
+        return true;
+    }
+
+    if (!out.put(static_cast<std::uint8_t>(offset)) ||
+            !out.put(static_cast<std::uint8_t>(offset >> 8))) {
+        return false;
+    }
+
+    if (matchRest >= 15 && !out.putLengthExtension(matchRest - 15)) {
+        return false;
+    }
+
+    return true;
+}
+
+bool readLengthExtension(const std::uint8_t*& ptr, const std::uint8_t* end,
+                         std::size_t& length)
+{
+    std::uint8_t byte;
+
+    do {
+        if (ptr == end) {
+            return false;
+        }
+
+        byte = *ptr++;
+        length += byte;
+    } while (byte == 255);
+
+    return true;
+}
+
+}
+
+std::size_t LzCodec::compress(const std::uint8_t* src, std::size_t srcSize,
+                              std::uint8_t* dst, std::size_t dstCapacity)
+{
+    // positions plus one (0 means no position)
+    std::uint32_t table[1 << HASH_BITS] = {};
+    Output out {dst, dstCapacity};
+    std::size_t anchor = 0;
+    std::size_t pos = 0;
+
+    while (pos + MIN_MATCH_SIZE <= srcSize) {
+        auto seq = read32(src + pos);
+        auto hash = (seq * 2654435761U) >> (32 - HASH_BITS);
+        std::size_t ref = table[hash];
+
+        table[hash] = static_cast<std::uint32_t>(pos + 1);
+
+        if (!ref || pos - (ref - 1) > MAX_OFFSET ||
+                read32(src + ref - 1) != seq) {
+            pos++;
+            continue;
+        }
+
+        // extend match
+        auto matchPos = ref - 1;
+        std::size_t matchSize = MIN_MATCH_SIZE;
+
+        while (pos + matchSize < srcSize &&
+                src[matchPos + matchSize] == src[pos + matchSize]) {
+            matchSize++;
+        }
+
+        if (!writeSequence(out, src + anchor, pos - anchor, pos - matchPos,
+                           matchSize, MIN_MATCH_SIZE)) {
+            return 0;
+        }
+
+        pos += matchSize;
+        anchor = pos;
+    }
+
+    // remaining literals
+    if (!writeSequence(out, src + anchor, srcSize - anchor, 0, 0,
+                       MIN_MATCH_SIZE)) {
+        return 0;
+    }
+
+    return static_cast<std::size_t>(out.getPtr() - dst);
+}
+
+bool LzCodec::decompress(const std::uint8_t* src, std::size_t srcSize,
+                         std::uint8_t* dst, std::size_t dstSize)
+{
+    auto ptr = src;
+    auto end = src + srcSize;
+    std::size_t outPos = 0;
+
+    while (ptr != end) {
+        auto token = *ptr++;
+
+        // literals
+        std::size_t literalCount = token >> 4;
+
+        if (literalCount == 15 &&
+                !readLengthExtension(ptr, end, literalCount)) {
+            return false;
+        }
+
+        if (static_cast<std::size_t>(end - ptr) < literalCount ||
+                dstSize - outPos < literalCount) {
+            return false;
+        }
+
+        std::memcpy(dst + outPos, ptr, literalCount);
+        ptr += literalCount;
+        outPos += literalCount;
+
+        if (ptr == end) {
+            // last sequence
+            return outPos == dstSize;
+        }
+
+        // match
+        if (end - ptr < 2) {
+            return false;
+        }
+
+        std::size_t offset = ptr[0] | (ptr[1] << 8);
+        ptr += 2;
+
+        std::size_t matchSize = token & 15;
+
+        if (matchSize == 15 && !readLengthExtension(ptr, end, matchSize)) {
+            return false;
+        }
+
+        matchSize += MIN_MATCH_SIZE;
+
+        if (offset == 0 || offset > outPos || dstSize - outPos < matchSize) {
+            return false;
+        }
+
+        // byte by byte since the match may overlap the output
+        auto matchPtr = dst + outPos - offset;
+
+        for (std::size_t x = 0; x < matchSize; ++x) {
+            dst[outPos + x] = matchPtr[x];
+        }
+
+        outPos += matchSize;
+    }
+
+    // missing last sequence
+    return false;
+}
+
+}
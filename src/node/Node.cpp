@@ -20,6 +20,7 @@
 
 #include <delorean/node/Node.hpp>
 #include <delorean/interval/IntervalJar.hpp>
+#include <delorean/interval/FlatIntervalJar.hpp>
 #include <delorean/ex/TimestampOutOfRange.hpp>
 #include <delorean/ex/NodeFull.hpp>
 #include <delorean/BasicTypes.hpp>
@@ -62,12 +63,12 @@ void Node::addInterval(AbstractInterval::SP interval)
      * only once.
      */
 
+    // update size cache (may depend on the intervals already added)
+    _curIntervalsSize += _serdes->getIntervalSize(*this, *interval);
+
     // add interval to jar
     _intervals.push_back(interval);
 
-    // update size cache
-    _curIntervalsSize += _serdes->getIntervalSize(*interval);
-
     // update node's end timestamp
     _end = interval->getEnd();
 
@@ -79,11 +80,20 @@ bool Node::intervalFits(const AbstractInterval& interval)
 {
     auto curSize = _curHeaderSize + _curChildrenSize + _curIntervalsSize;
     auto freeSpace = _totalSize - curSize;
-    auto intervalSize = _serdes->getIntervalSize(interval);
+    auto intervalSize = _serdes->getIntervalSize(*this, interval);
 
     return intervalSize <= freeSpace;
 }
 
+void Node::extend(std::size_t size)
+{
+    if (size > _totalSize) {
+        _totalSize = size;
+    }
+
+    _isExtended = true;
+}
+
 void Node::close(timestamp_t end)
 {
     // already closed?
@@ -128,6 +138,26 @@ bool Node::findAll(timestamp_t ts, IntervalJar& intervals) const
     return found;
 }
 
+bool Node::findAll(timestamp_t ts, FlatIntervalJar& intervals) const
+{
+    // fast path when there's no interval
+    if (_intervals.empty()) {
+        return false;
+    }
+
+    auto found = false;
+    for (auto it = getFirstItForTs(ts); it != _intervals.end(); it++) {
+        const auto& interval = *it;
+
+        if (ts >= interval->getBegin()) {
+            intervals.append(interval);
+            found = true;
+        }
+    }
+
+    return found;
+}
+
 AbstractInterval::SP Node::findOne(timestamp_t ts, interval_key_t key) const
 {
     /* We don't perform any range check here. Since a node is not exposed
@@ -191,6 +221,23 @@ std::vector<AbstractInterval::SP>::const_iterator Node::getFirstItForTs(timestam
     return it;
 }
 
+std::size_t Node::getMemorySize() const
+{
+    std::size_t size = sizeof(*this);
+
+    size += _intervals.capacity() * sizeof(AbstractInterval::SP);
+    size += _children.capacity() * sizeof(ChildNodePointer);
+
+    for (const auto& interval : _intervals) {
+        /* Also count the control block of each interval shared pointer
+         * (two reference counts and a virtual table pointer, usually).
+         */
+        size += interval->getMemorySize() + 2 * sizeof(long) + sizeof(void*);
+    }
+
+    return size;
+}
+
 void Node::addChild(timestamp_t begin, node_seq_t seqNumber)
 {
     // node full?
@@ -0,0 +1,301 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <iterator>
+#include <string>
+
+#include <delorean/node/AbstractNodeCache.hpp>
+#include <delorean/node/SharedNodeCache.hpp>
+#include <delorean/node/Node.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+SharedNodeCache::View::View(SharedNodeCache::SP cache,
+                            std::uint32_t fileId) :
+    AbstractNodeCache {cache->getSize(), cache->getByteBudget()},
+    _cache {cache},
+    _fileId {fileId}
+{
+}
+
+SharedNodeCache::View::~View()
+{
+    _cache->releaseFile(_fileId);
+}
+
+Node::SP SharedNodeCache::View::getNodeImpl(node_seq_t seqNumber)
+{
+    return _cache->getNode(*this, seqNumber);
+}
+
+bool SharedNodeCache::View::nodeIsCachedImpl(node_seq_t seqNumber) const
+{
+    return _cache->nodeIsCached(_fileId, seqNumber);
+}
+
+bool SharedNodeCache::View::putNodeImpl(node_seq_t seqNumber, Node::SP node)
+{
+    return _cache->putNode(_fileId, seqNumber, node);
+}
+
+Node::SP SharedNodeCache::View::peekNodeImpl(node_seq_t seqNumber) const
+{
+    return _cache->peekNode(_fileId, seqNumber);
+}
+
+void SharedNodeCache::View::addBytesLoadedImpl(std::uint64_t size)
+{
+    _cache->addBytesLoaded(size);
+}
+
+void SharedNodeCache::View::invalidateImpl()
+{
+    _cache->invalidateFile(_fileId);
+}
+
+SharedNodeCache::SharedNodeCache(std::size_t size, std::size_t byteBudget) :
+    _size {size},
+    _byteBudget {byteBudget},
+    _nextFileId {0}
+{
+    _map.reserve(size);
+}
+
+std::shared_ptr<AbstractNodeCache> SharedNodeCache::createView(const boost::filesystem::path& path)
+{
+    return this->createFileView(boost::filesystem::canonical(path).string());
+}
+
+std::shared_ptr<AbstractNodeCache> SharedNodeCache::createView()
+{
+    return this->createFileView(std::string {});
+}
+
+std::shared_ptr<AbstractNodeCache> SharedNodeCache::createFileView(const std::string& path)
+{
+    std::uint32_t fileId;
+
+    {
+        std::lock_guard<std::mutex> lock {_mutex};
+        auto it = _fileIds.find(path);
+
+        if (path.empty() || it == _fileIds.end()) {
+            fileId = _nextFileId++;
+            _files[fileId] = {path, 0, {}};
+
+            if (!path.empty()) {
+                _fileIds[path] = fileId;
+            }
+        } else {
+            fileId = it->second;
+        }
+
+        _files[fileId].viewCount++;
+    }
+
+    return std::shared_ptr<AbstractNodeCache> {
+        new View {this->shared_from_this(), fileId}
+    };
+}
+
+NodeCacheStats SharedNodeCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock {_mutex};
+
+    return _stats;
+}
+
+bool SharedNodeCache::exceedsByteBudget(std::size_t memorySize) const
+{
+    return _byteBudget != 0 && _stats.memorySize + memorySize > _byteBudget;
+}
+
+void SharedNodeCache::removeEntry(EntryList::iterator it)
+{
+    _stats.nodeCount--;
+    _stats.memorySize -= it->memorySize;
+    _files[getFileId(it->key)].seqNumbers.erase(
+        static_cast<node_seq_t>(it->key));
+    _map.erase(it->key);
+    _list.erase(it);
+}
+
+Node::SP SharedNodeCache::getNode(View& view, node_seq_t seqNumber)
+{
+    if (_size == 0) {
+        return view.loadNode(seqNumber);
+    }
+
+    auto key = makeKey(view._fileId, seqNumber);
+
+    {
+        std::lock_guard<std::mutex> lock {_mutex};
+        auto it = _map.find(key);
+
+        if (it != _map.end()) {
+            // hit: put it back in front
+            _stats.hits++;
+            _list.splice(_list.begin(), _list, it->second);
+
+            return it->second->node;
+        }
+
+        _stats.misses++;
+    }
+
+    // load outside the lock: other owners may use the cache meanwhile
+    auto node = view.loadNode(seqNumber);
+
+    if (!node) {
+        return node;
+    }
+
+    auto memorySize = node->getMemorySize();
+    std::lock_guard<std::mutex> lock {_mutex};
+
+    _stats.decodedBytesLoaded += memorySize;
+
+    // loaded by another thread meanwhile?
+    auto it = _map.find(key);
+
+    if (it != _map.end()) {
+        _list.splice(_list.begin(), _list, it->second);
+
+        return it->second->node;
+    }
+
+    this->insertNode(key, node, memorySize);
+
+    return node;
+}
+
+bool SharedNodeCache::putNode(std::uint32_t fileId, node_seq_t seqNumber,
+                              Node::SP node)
+{
+    if (_size == 0) {
+        return false;
+    }
+
+    auto key = makeKey(fileId, seqNumber);
+    std::lock_guard<std::mutex> lock {_mutex};
+
+    if (_map.find(key) != _map.end()) {
+        return true;
+    }
+
+    return this->insertNode(key, node, node->getMemorySize());
+}
+
+bool SharedNodeCache::insertNode(std::uint64_t key, Node::SP node,
+                                 std::size_t memorySize)
+{
+    // larger than the whole budget: keep the nodes of all the owners
+    if (_byteBudget != 0 && memorySize > _byteBudget) {
+        return false;
+    }
+
+    // drop least recently used nodes (any owner) until there's room
+    while (!_list.empty() &&
+            (_list.size() >= _size || this->exceedsByteBudget(memorySize))) {
+        _stats.evictions++;
+        this->removeEntry(std::prev(_list.end()));
+    }
+
+    _list.push_front({key, node, memorySize});
+    _map[key] = _list.begin();
+    _files[getFileId(key)].seqNumbers.insert(static_cast<node_seq_t>(key));
+    _stats.nodeCount++;
+    _stats.memorySize += memorySize;
+
+    return true;
+}
+
+bool SharedNodeCache::nodeIsCached(std::uint32_t fileId,
+                                   node_seq_t seqNumber) const
+{
+    std::lock_guard<std::mutex> lock {_mutex};
+
+    return _map.find(makeKey(fileId, seqNumber)) != _map.end();
+}
+
+void SharedNodeCache::addBytesLoaded(std::uint64_t size)
+{
+    std::lock_guard<std::mutex> lock {_mutex};
+
+    _stats.bytesLoaded += size;
+}
+
+Node::SP SharedNodeCache::peekNode(std::uint32_t fileId,
+                                   node_seq_t seqNumber) const
+{
+    std::lock_guard<std::mutex> lock {_mutex};
+    auto it = _map.find(makeKey(fileId, seqNumber));
+
+    if (it == _map.end()) {
+        return nullptr;
+    }
+
+    return it->second->node;
+}
+
+void SharedNodeCache::removeFileNodes(std::uint32_t fileId)
+{
+    // only visit the cached nodes of this file
+    const auto& seqNumbers = _files[fileId].seqNumbers;
+
+    while (!seqNumbers.empty()) {
+        auto it = _map.find(makeKey(fileId, *seqNumbers.begin()));
+
+        this->removeEntry(it->second);
+    }
+}
+
+void SharedNodeCache::invalidateFile(std::uint32_t fileId)
+{
+    std::lock_guard<std::mutex> lock {_mutex};
+
+    this->removeFileNodes(fileId);
+}
+
+void SharedNodeCache::releaseFile(std::uint32_t fileId)
+{
+    std::lock_guard<std::mutex> lock {_mutex};
+    auto& file = _files[fileId];
+
+    file.viewCount--;
+
+    if (file.viewCount > 0) {
+        return;
+    }
+
+    // last view of this file: forget it
+    this->removeFileNodes(fileId);
+
+    if (!file.path.empty()) {
+        _fileIds.erase(file.path);
+    }
+
+    _files.erase(fileId);
+}
+
+}
@@ -0,0 +1,226 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <algorithm>
+#include <iterator>
+
+#include <delorean/node/AbstractNodeCache.hpp>
+#include <delorean/node/TwoQueueNodeCache.hpp>
+#include <delorean/node/Node.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+TwoQueueNodeCache::TwoQueueNodeCache(std::size_t size,
+                                     std::size_t byteBudget) :
+    AbstractNodeCache {size, byteBudget},
+    _inSize {std::max(size / 4, static_cast<std::size_t>(1))},
+    _outSize {std::max(size / 2, static_cast<std::size_t>(1))}
+{
+    _locations.reserve(size + _outSize + 1);
+}
+
+TwoQueueNodeCache::EntryList& TwoQueueNodeCache::getList(Queue queue)
+{
+    switch (queue) {
+    case Queue::IN:
+        return _inList;
+
+    case Queue::OUT:
+        return _outList;
+
+    default:
+        return _mainList;
+    }
+}
+
+void TwoQueueNodeCache::moveToFront(Location& location, Queue queue)
+{
+    auto& list = this->getList(queue);
+
+    list.splice(list.begin(), this->getList(location.queue), location.it);
+    location.queue = queue;
+}
+
+void TwoQueueNodeCache::evictOne()
+{
+    if (_inList.size() > _inSize || _mainList.empty()) {
+        // A1in is too large: remember its oldest node in A1out
+        auto& entry = _inList.back();
+        this->nodeRemoved(entry.memorySize);
+        entry.node = nullptr;
+        _locations[entry.seqNumber].queue = Queue::OUT;
+        _outList.splice(_outList.begin(), _inList, std::prev(_inList.end()));
+
+        if (_outList.size() > _outSize) {
+            _locations.erase(_outList.back().seqNumber);
+            _outList.pop_back();
+        }
+    } else {
+        // drop the least recently used node of Am
+        this->nodeRemoved(_mainList.back().memorySize);
+        _locations.erase(_mainList.back().seqNumber);
+        _mainList.pop_back();
+    }
+}
+
+bool TwoQueueNodeCache::makeRoom(std::size_t memorySize)
+{
+    // larger than the whole budget: keep the cached nodes
+    if (this->exceedsWholeByteBudget(memorySize)) {
+        return false;
+    }
+
+    while (!_inList.empty() || !_mainList.empty()) {
+        auto count = _inList.size() + _mainList.size();
+
+        if (count < this->getSize() && !this->exceedsByteBudget(memorySize)) {
+            break;
+        }
+
+        this->evictOne();
+    }
+
+    return true;
+}
+
+Node::SP TwoQueueNodeCache::getNodeImpl(node_seq_t seqNumber)
+{
+    if (this->getSize() == 0) {
+        return this->getNodeFromOwner(seqNumber);
+    }
+
+    auto it = _locations.find(seqNumber);
+
+    if (it != _locations.end()) {
+        auto& location = it->second;
+
+        switch (location.queue) {
+        case Queue::MAIN:
+            // hit in Am: most recently used now
+            this->moveToFront(location, Queue::MAIN);
+            return location.it->node;
+
+        case Queue::IN:
+            // hit in A1in: stays where it is (FIFO)
+            return location.it->node;
+
+        case Queue::OUT:
+        {
+            // remembered: admit into Am
+            auto node = this->getNodeFromOwner(seqNumber);
+
+            if (!node) {
+                return node;
+            }
+
+            // forget it first: makeRoom() could drop it from A1out
+            _outList.erase(location.it);
+            _locations.erase(it);
+
+            auto memorySize = node->getMemorySize();
+
+            if (this->makeRoom(memorySize)) {
+                _mainList.push_front({seqNumber, node, memorySize});
+                _locations[seqNumber] = {Queue::MAIN, _mainList.begin()};
+                this->nodeAdded(memorySize);
+            }
+
+            return node;
+        }
+        }
+    }
+
+    // first access (or forgotten): enter A1in
+    auto node = this->getNodeFromOwner(seqNumber);
+
+    if (!node) {
+        return node;
+    }
+
+    auto memorySize = node->getMemorySize();
+
+    if (this->makeRoom(memorySize)) {
+        _inList.push_front({seqNumber, node, memorySize});
+        _locations[seqNumber] = {Queue::IN, _inList.begin()};
+        this->nodeAdded(memorySize);
+    }
+
+    return node;
+}
+
+bool TwoQueueNodeCache::putNodeImpl(node_seq_t seqNumber, Node::SP node)
+{
+    if (this->getSize() == 0) {
+        return false;
+    }
+
+    auto it = _locations.find(seqNumber);
+
+    if (it != _locations.end()) {
+        if (it->second.queue != Queue::OUT) {
+            return true;
+        }
+
+        // not an access: forget it and enter A1in like a new node
+        _outList.erase(it->second.it);
+        _locations.erase(it);
+    }
+
+    auto memorySize = node->getMemorySize();
+
+    if (!this->makeRoom(memorySize)) {
+        return false;
+    }
+
+    _inList.push_front({seqNumber, node, memorySize});
+    _locations[seqNumber] = {Queue::IN, _inList.begin()};
+    this->nodeAdded(memorySize);
+
+    return true;
+}
+
+bool TwoQueueNodeCache::nodeIsCachedImpl(node_seq_t seqNumber) const
+{
+    auto it = _locations.find(seqNumber);
+
+    return it != _locations.end() && it->second.queue != Queue::OUT;
+}
+
+Node::SP TwoQueueNodeCache::peekNodeImpl(node_seq_t seqNumber) const
+{
+    auto it = _locations.find(seqNumber);
+
+    if (it == _locations.end() || it->second.queue == Queue::OUT) {
+        return nullptr;
+    }
+
+    return it->second.it->node;
+}
+
+void TwoQueueNodeCache::invalidateImpl()
+{
+    _inList.clear();
+    _outList.clear();
+    _mainList.clear();
+    _locations.clear();
+    this->allNodesRemoved();
+}
+
+}
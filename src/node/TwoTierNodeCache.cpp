@@ -0,0 +1,246 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+
+#include <delorean/node/AbstractNodeCache.hpp>
+#include <delorean/node/TwoTierNodeCache.hpp>
+#include <delorean/node/Node.hpp>
+#include <delorean/BasicTypes.hpp>
+
+namespace delo
+{
+
+TwoTierNodeCache::TwoTierNodeCache(std::size_t size,
+                                   std::size_t rawByteBudget,
+                                   std::size_t byteBudget) :
+    AbstractNodeCache {size, byteBudget},
+    _rawByteBudget {rawByteBudget},
+    _rawMemorySize {0},
+    _rawCompactionEnabled {true},
+    _promotions {0}
+{
+    _map.reserve(size);
+}
+
+Node::SP TwoTierNodeCache::getNodeImpl(node_seq_t seqNumber)
+{
+    if (this->getSize() == 0) {
+        return this->getNodeFromOwner(seqNumber);
+    }
+
+    auto it = _map.find(seqNumber);
+
+    if (it != _map.end()) {
+        // decoded hit: put it back in front
+        _list.splice(_list.begin(), _list, it->second);
+
+        return it->second->node;
+    }
+
+    Node::SP node;
+    auto rawIt = _rawMap.find(seqNumber);
+
+    if (rawIt != _rawMap.end()) {
+        // raw hit: decode, no need to ask the owner
+        node = this->promote(rawIt->second);
+    } else {
+        node = this->getNodeFromOwner(seqNumber);
+    }
+
+    if (node) {
+        this->insertDecoded(seqNumber, node);
+    }
+
+    return node;
+}
+
+bool TwoTierNodeCache::putNodeImpl(node_seq_t seqNumber, Node::SP node)
+{
+    if (this->getSize() == 0) {
+        return false;
+    }
+
+    if (this->nodeIsCached(seqNumber)) {
+        return true;
+    }
+
+    this->insertDecoded(seqNumber, node);
+
+    return this->nodeIsCached(seqNumber);
+}
+
+bool TwoTierNodeCache::nodeIsCachedImpl(node_seq_t seqNumber) const
+{
+    return _map.find(seqNumber) != _map.end() ||
+           _rawMap.find(seqNumber) != _rawMap.end();
+}
+
+Node::SP TwoTierNodeCache::peekNodeImpl(node_seq_t seqNumber) const
+{
+    auto it = _map.find(seqNumber);
+
+    if (it != _map.end()) {
+        return it->second->node;
+    }
+
+    // raw image: decode it, but leave it in the raw tier
+    auto rawIt = _rawMap.find(seqNumber);
+
+    if (rawIt != _rawMap.end()) {
+        return decodeRaw(*rawIt->second);
+    }
+
+    return nullptr;
+}
+
+void TwoTierNodeCache::invalidateImpl()
+{
+    _list.clear();
+    _map.clear();
+    _rawList.clear();
+    _rawMap.clear();
+    _rawMemorySize = 0;
+    this->allNodesRemoved();
+}
+
+void TwoTierNodeCache::insertDecoded(node_seq_t seqNumber, Node::SP node)
+{
+    auto memorySize = node->getMemorySize();
+
+    if (this->exceedsWholeByteBudget(memorySize)) {
+        // larger than the whole decoded budget: keep its image at least
+        this->demote({seqNumber, node, memorySize});
+
+        return;
+    }
+
+    // demote least recently used nodes until there's room for this one
+    while (!_list.empty() && (_list.size() >= this->getSize() ||
+                              this->exceedsByteBudget(memorySize))) {
+        const auto& entry = _list.back();
+
+        this->nodeRemoved(entry.memorySize);
+        this->demote(entry);
+        _map.erase(entry.seqNumber);
+        _list.pop_back();
+    }
+
+    _list.push_front({seqNumber, node, memorySize});
+    _map[seqNumber] = _list.begin();
+    this->nodeAdded(memorySize);
+}
+
+void TwoTierNodeCache::demote(const Entry& entry)
+{
+    const auto& node = *entry.node;
+    auto serdes = node.getSerDes();
+
+    if (_rawByteBudget == 0 || !serdes) {
+        return;
+    }
+
+    // serialize (free space is left zeroed)
+    std::vector<std::uint8_t> buf(node.getSize(), 0);
+    serdes->serializeNode(node, buf.data());
+
+    RawEntry rawEntry;
+    rawEntry.seqNumber = entry.seqNumber;
+    rawEntry.gapOffset = buf.size();
+    rawEntry.gapSize = 0;
+    rawEntry.serdes = serdes;
+    rawEntry.maxChildren = node.getMaxChildren();
+
+    if (_rawCompactionEnabled) {
+        // find the longest run of zero bytes
+        auto it = buf.begin();
+
+        while (it != buf.end()) {
+            auto runBegin = std::find(it, buf.end(), 0);
+            auto runEnd = std::find_if(runBegin, buf.end(),
+                                       [] (std::uint8_t byte) {
+                return byte != 0;
+            });
+            auto runSize = static_cast<std::size_t>(runEnd - runBegin);
+
+            if (runSize > rawEntry.gapSize) {
+                rawEntry.gapOffset = runBegin - buf.begin();
+                rawEntry.gapSize = runSize;
+            }
+
+            it = runEnd;
+        }
+    }
+
+    auto gapBegin = buf.begin() + rawEntry.gapOffset;
+    rawEntry.image.reserve(buf.size() - rawEntry.gapSize);
+    rawEntry.image.insert(rawEntry.image.end(), buf.begin(), gapBegin);
+    rawEntry.image.insert(rawEntry.image.end(), gapBegin + rawEntry.gapSize,
+                          buf.end());
+
+    auto rawMemorySize = getRawMemorySize(rawEntry);
+
+    if (rawMemorySize > _rawByteBudget) {
+        return;
+    }
+
+    // drop least recently used images until there's room for this one
+    while (_rawMemorySize + rawMemorySize > _rawByteBudget) {
+        this->dropRaw(std::prev(_rawList.end()));
+    }
+
+    _rawList.push_front(std::move(rawEntry));
+    _rawMap[entry.seqNumber] = _rawList.begin();
+    _rawMemorySize += rawMemorySize;
+}
+
+Node::SP TwoTierNodeCache::promote(RawEntryList::iterator it)
+{
+    auto node = decodeRaw(*it);
+
+    this->dropRaw(it);
+    _promotions++;
+
+    return node;
+}
+
+Node::SP TwoTierNodeCache::decodeRaw(const RawEntry& rawEntry)
+{
+    // restore the elided zero bytes
+    std::vector<std::uint8_t> buf;
+    auto gapBegin = rawEntry.image.begin() + rawEntry.gapOffset;
+    buf.reserve(rawEntry.image.size() + rawEntry.gapSize);
+    buf.insert(buf.end(), rawEntry.image.begin(), gapBegin);
+    buf.insert(buf.end(), rawEntry.gapSize, 0);
+    buf.insert(buf.end(), gapBegin, rawEntry.image.end());
+
+    return rawEntry.serdes->deserializeNode(buf.data(), buf.size(),
+                                            rawEntry.maxChildren);
+}
+
+void TwoTierNodeCache::dropRaw(RawEntryList::iterator it)
+{
+    _rawMemorySize -= getRawMemorySize(*it);
+    _rawMap.erase(it->seqNumber);
+    _rawList.erase(it);
+}
+
+}
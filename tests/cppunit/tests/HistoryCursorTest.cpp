@@ -0,0 +1,144 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <memory>
+#include <vector>
+#include <random>
+#include <boost/filesystem.hpp>
+
+#include <delorean/HistoryFileSource.hpp>
+#include <delorean/HistoryCursor.hpp>
+#include <delorean/BasicTypes.hpp>
+#include <delorean/interval/AbstractInterval.hpp>
+#include <delorean/interval/IntervalJar.hpp>
+#include <delorean/ex/TimestampOutOfRange.hpp>
+#include <utils.hpp>
+#include "HistoryCursorTest.hpp"
+
+namespace bfs = boost::filesystem;
+using namespace delo;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(HistoryCursorTest);
+
+namespace
+{
+
+void checkCursor(HistoryFileSource& source, const HistoryCursor& cursor)
+{
+    IntervalJar jar;
+    source.findAll(cursor.getTs(), jar);
+
+    const auto& cursorJar = cursor.getIntervals();
+    CPPUNIT_ASSERT_EQUAL(jar.size(), cursorJar.size());
+
+    auto cursorIt = cursorJar.begin();
+    for (const auto& entry : jar) {
+        CPPUNIT_ASSERT_EQUAL(entry.first, cursorIt->first);
+        CPPUNIT_ASSERT_EQUAL(entry.second->getBegin(),
+                             cursorIt->second->getBegin());
+        CPPUNIT_ASSERT_EQUAL(entry.second->getEnd(),
+                             cursorIt->second->getEnd());
+        ++cursorIt;
+    }
+}
+
+}
+
+void HistoryCursorTest::testOutOfRange()
+{
+    std::vector<AbstractInterval::SP> intervals;
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./history.his",
+                             1024, 16, 15123456, intervals);
+
+    std::unique_ptr<HistoryFileSource> hfSource {new HistoryFileSource};
+    hfSource->open("./history.his");
+
+    HistoryCursor cursor {*hfSource};
+    CPPUNIT_ASSERT(!cursor.isPositioned());
+
+    try {
+        cursor.moveTo(15123455);
+        CPPUNIT_FAIL("Moved a cursor before the beginning of the history");
+    } catch (const ex::TimestampOutOfRange& ex) {
+    }
+
+    CPPUNIT_ASSERT(!cursor.isPositioned());
+
+    cursor.moveTo(15123456);
+    CPPUNIT_ASSERT(cursor.isPositioned());
+    CPPUNIT_ASSERT(cursor.getIntervals().empty());
+
+    try {
+        cursor.moveTo(hfSource->getEnd());
+        CPPUNIT_FAIL("Moved a cursor after the end of the history");
+    } catch (const ex::TimestampOutOfRange& ex) {
+    }
+
+    // still at its previous position
+    CPPUNIT_ASSERT_EQUAL(static_cast<timestamp_t>(15123456), cursor.getTs());
+
+    hfSource->close();
+    bfs::remove("./history.his");
+}
+
+void HistoryCursorTest::testScrub()
+{
+    std::vector<AbstractInterval::SP> intervals;
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./history.his",
+                             1024, 16, 15123456, intervals);
+
+    std::unique_ptr<HistoryFileSource> hfSource {new HistoryFileSource};
+    hfSource->open("./history.his");
+
+    auto begin = hfSource->getBegin();
+    auto end = hfSource->getEnd();
+    HistoryCursor cursor {*hfSource};
+
+    // scrub forward
+    for (timestamp_t ts = begin; ts < end; ts += 7919) {
+        cursor.moveTo(ts);
+        checkCursor(*hfSource, cursor);
+    }
+
+    // scrub backward
+    for (timestamp_t ts = end - 1; ts >= begin + 7907; ts -= 7907) {
+        cursor.moveTo(ts);
+        checkCursor(*hfSource, cursor);
+    }
+
+    // interval boundaries, in both directions
+    for (const auto& interval : intervals) {
+        cursor.moveTo(interval->getBegin());
+        checkCursor(*hfSource, cursor);
+
+        if (interval->getEnd() < end) {
+            cursor.moveTo(interval->getEnd());
+            checkCursor(*hfSource, cursor);
+        }
+    }
+
+    // random jumps
+    std::mt19937 gen {42};
+    std::uniform_int_distribution<timestamp_t> dist {begin, end - 1};
+    for (int x = 0; x < 2000; ++x) {
+        cursor.moveTo(dist(gen));
+        checkCursor(*hfSource, cursor);
+    }
+
+    hfSource->close();
+    bfs::remove("./history.his");
+}
@@ -17,16 +17,32 @@
  */
 #include <memory>
 #include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <tuple>
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <fstream>
+#include <string>
+#include <iterator>
 #include <boost/filesystem.hpp>
 
 #include <delorean/HistoryFileSink.hpp>
 #include <delorean/HistoryFileSource.hpp>
 #include <delorean/BasicTypes.hpp>
 #include <delorean/interval/Int32Interval.hpp>
+#include <delorean/interval/DoubleInterval.hpp>
 #include <delorean/interval/StringInterval.hpp>
+#include <delorean/interval/DictionaryStringInterval.hpp>
 #include <delorean/interval/StandardIntervalType.hpp>
 #include <delorean/interval/IntervalJar.hpp>
+#include <delorean/interval/FlatIntervalJar.hpp>
+#include <delorean/node/NodeCacheType.hpp>
+#include <delorean/node/LruNodeCache.hpp>
 #include <delorean/ex/IO.hpp>
+#include <delorean/ex/CorruptedNode.hpp>
+#include <delorean/ex/NodeFull.hpp>
 #include <delorean/ex/TimestampOutOfRange.hpp>
 #include <utils.hpp>
 #include "HistoryFileTest.hpp"
@@ -36,6 +52,7 @@ using namespace delo;
 
 CPPUNIT_TEST_SUITE_REGISTRATION(HistoryFileTest);
 
+
 void HistoryFileTest::testNonExistingFile()
 {
     // create history file sink
@@ -97,10 +114,11 @@ void HistoryFileTest::testBuildEmpty()
     // close
     hfSink->close();
 
-    /* The file created should have a size of (header size + node size) bytes,
-     * or 12288 bytes. This is because only one node should be created.
+    /* The file created should have a size of (header size + node size +
+     * node directory entry size) bytes, or 12320 bytes. This is because
+     * only one node should be created.
      */
-    CPPUNIT_ASSERT_EQUAL(static_cast<uintmax_t>(12288),
+    CPPUNIT_ASSERT_EQUAL(static_cast<uintmax_t>(12320),
                          bfs::file_size("./history.his"));
 
     // create and open history file source
@@ -230,3 +248,1229 @@ void HistoryFileTest::testAddFindIntervals()
     // close history file source
     hfSource->close();
 }
+
+void HistoryFileTest::testVisitorQueries()
+{
+    std::vector<AbstractInterval::SP> intervals;
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./history.his",
+                             1024, 16, 15123456, intervals);
+
+    // create history file source and open it
+    std::unique_ptr<HistoryFileSource> hfSource {new HistoryFileSource};
+    hfSource->open("./history.his");
+
+    // visitor queries must find exactly what jar queries find
+    for (timestamp_t ts = 15123456; ts < 30000101; ts += 99991) {
+        IntervalJar jar;
+        auto jarRes = hfSource->findAll(ts, jar);
+
+        IntervalJar visited;
+        auto res = hfSource->findAll(ts, [&visited] (const AbstractInterval& interval) {
+            CPPUNIT_ASSERT(visited.find(interval.getKey()) == visited.end());
+            visited[interval.getKey()] = nullptr;
+
+            return true;
+        });
+        CPPUNIT_ASSERT_EQUAL(jarRes, res);
+        CPPUNIT_ASSERT_EQUAL(jar.size(), visited.size());
+
+        for (const auto& keyInterval : jar) {
+            auto key = keyInterval.first;
+            CPPUNIT_ASSERT(visited.find(key) != visited.end());
+
+            // single interval visitor
+            timestamp_t begin = -1;
+            timestamp_t end = -1;
+            res = hfSource->findOne(ts, key, [&begin, &end] (const AbstractInterval& interval) {
+                begin = interval.getBegin();
+                end = interval.getEnd();
+
+                return true;
+            });
+            CPPUNIT_ASSERT(res);
+            CPPUNIT_ASSERT_EQUAL(keyInterval.second->getBegin(), begin);
+            CPPUNIT_ASSERT_EQUAL(keyInterval.second->getEnd(), end);
+        }
+    }
+
+    // early stop
+    std::size_t count = 0;
+    auto res = hfSource->findAll(18200101, [&count] (const AbstractInterval&) {
+        count++;
+
+        return false;
+    });
+    CPPUNIT_ASSERT(res);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(1), count);
+
+    // nothing before the first interval
+    res = hfSource->findOne(17210403, 4, [] (const AbstractInterval&) {
+        CPPUNIT_FAIL("Visited a non-existing interval");
+
+        return true;
+    });
+    CPPUNIT_ASSERT(!res);
+
+    // range queries must find what a linear search finds
+    const std::vector<std::pair<timestamp_t, timestamp_t>> ranges {
+        {15123456, 15123457},
+        {17210403, 17210405},
+        {18000101, 18500101},
+        {19391231, 19450101},
+        {15123456, 30000101},
+        {29990101, 30000101},
+    };
+    for (const auto& range : ranges) {
+        std::size_t expected = 0;
+        for (const auto& interval : intervals) {
+            if (interval->getBegin() < range.second &&
+                    interval->getEnd() > range.first) {
+                expected++;
+            }
+        }
+
+        count = 0;
+        res = hfSource->findAllInRange(range.first, range.second,
+                                       [&count, &range] (const AbstractInterval& interval) {
+            CPPUNIT_ASSERT(interval.getBegin() < range.second);
+            CPPUNIT_ASSERT(interval.getEnd() > range.first);
+            count++;
+
+            return true;
+        });
+        CPPUNIT_ASSERT_EQUAL(expected > 0, res);
+        CPPUNIT_ASSERT_EQUAL(expected, count);
+    }
+
+    // invalid ranges
+    auto nop = [] (const AbstractInterval&) {
+        return true;
+    };
+    CPPUNIT_ASSERT_THROW(hfSource->findAllInRange(18000101, 18000101, nop),
+                         ex::TimestampOutOfRange);
+    CPPUNIT_ASSERT_THROW(hfSource->findAllInRange(18000101, 30000102, nop),
+                         ex::TimestampOutOfRange);
+    CPPUNIT_ASSERT_THROW(hfSource->findAllInRange(15123455, 18000101, nop),
+                         ex::TimestampOutOfRange);
+
+    // close history file source
+    hfSource->close();
+}
+
+void HistoryFileTest::testFlatJarQueries()
+{
+    std::vector<AbstractInterval::SP> intervals;
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./history.his",
+                             1024, 16, 15123456, intervals);
+
+    // create history file source and open it
+    std::unique_ptr<HistoryFileSource> hfSource {new HistoryFileSource};
+    hfSource->open("./history.his");
+
+    // nothing before the first interval
+    FlatIntervalJar flatJar;
+    CPPUNIT_ASSERT(!hfSource->findAll(17210403, flatJar));
+    CPPUNIT_ASSERT(flatJar.empty());
+
+    // reuse the same flat jar: must match a regular jar
+    std::size_t capacity = 0;
+    for (timestamp_t ts = 15123456; ts < 30000101; ts += 99991) {
+        IntervalJar jar;
+        auto jarRes = hfSource->findAll(ts, jar);
+
+        flatJar.clear();
+        auto res = hfSource->findAll(ts, flatJar);
+        CPPUNIT_ASSERT_EQUAL(jarRes, res);
+        CPPUNIT_ASSERT_EQUAL(jar.size(), flatJar.size());
+
+        auto jarIt = jar.begin();
+        for (const auto& entry : flatJar) {
+            CPPUNIT_ASSERT_EQUAL(jarIt->first, entry.first);
+            CPPUNIT_ASSERT_EQUAL(jarIt->second->getBegin(),
+                                 entry.second->getBegin());
+            CPPUNIT_ASSERT_EQUAL(jarIt->second->getEnd(),
+                                 entry.second->getEnd());
+            ++jarIt;
+        }
+
+        // capacity only grows with the largest state
+        CPPUNIT_ASSERT(flatJar.capacity() >= capacity);
+        capacity = flatJar.capacity();
+    }
+
+    // add to a non-empty flat jar
+    flatJar.clear();
+    CPPUNIT_ASSERT(hfSource->findAll(18200101, flatJar));
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(2), flatJar.size());
+    CPPUNIT_ASSERT(hfSource->findAll(19400101, flatJar));
+    CPPUNIT_ASSERT_EQUAL(static_cast<timestamp_t>(18170304),
+                         flatJar.at(1)->getBegin());
+
+    // close history file source
+    hfSource->close();
+}
+
+namespace
+{
+
+typedef std::tuple<timestamp_t, timestamp_t, interval_key_t> IntervalTuple;
+
+IntervalTuple intervalTuple(const AbstractInterval& interval)
+{
+    return IntervalTuple {
+        interval.getBegin(), interval.getEnd(), interval.getKey()
+    };
+}
+
+}
+
+void HistoryFileTest::testScan()
+{
+    std::vector<AbstractInterval::SP> intervals;
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./history.his",
+                             1024, 16, 15123456, intervals);
+
+    std::vector<IntervalTuple> expected;
+    for (const auto& interval : intervals) {
+        expected.push_back(intervalTuple(*interval));
+    }
+    std::sort(expected.begin(), expected.end());
+
+    // create history file source
+    std::unique_ptr<HistoryFileSource> hfSource {new HistoryFileSource};
+
+    // try scanning when closed
+    try {
+        hfSource->scan([] (std::size_t, const AbstractInterval::SP&) {});
+        CPPUNIT_FAIL("Scanned a closed history file source");
+    } catch (const ex::IO& ex) {
+    }
+
+    hfSource->open("./history.his");
+
+    // single worker, small chunks: on-disk order
+    std::vector<IntervalTuple> scanned;
+    hfSource->scan([&scanned] (std::size_t index,
+                               const AbstractInterval::SP& interval) {
+        CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(0), index);
+        scanned.push_back(intervalTuple(*interval));
+    }, 1, 3000);
+    std::sort(scanned.begin(), scanned.end());
+    CPPUNIT_ASSERT(scanned == expected);
+
+    // many workers: per-worker results
+    const std::size_t workerCount = 4;
+    std::vector<std::vector<IntervalTuple>> perWorker(workerCount);
+    hfSource->scan([&perWorker] (std::size_t index,
+                                 const AbstractInterval::SP& interval) {
+        perWorker[index].push_back(intervalTuple(*interval));
+    }, workerCount, 4096);
+
+    scanned.clear();
+    for (const auto& workerScanned : perWorker) {
+        scanned.insert(scanned.end(), workerScanned.begin(),
+                       workerScanned.end());
+    }
+    std::sort(scanned.begin(), scanned.end());
+    CPPUNIT_ASSERT(scanned == expected);
+
+    // callback exception is rethrown
+    try {
+        hfSource->scan([] (std::size_t, const AbstractInterval::SP&) {
+            throw std::runtime_error {"stop"};
+        }, workerCount);
+        CPPUNIT_FAIL("Callback exception was not rethrown");
+    } catch (const std::runtime_error& ex) {
+    }
+
+    // still usable for queries afterwards
+    IntervalJar jar;
+    CPPUNIT_ASSERT(hfSource->findAll(18200101, jar));
+
+    // close history file source
+    hfSource->close();
+    bfs::remove("./history.his");
+}
+
+void HistoryFileTest::testNodeCacheTypes()
+{
+    std::vector<AbstractInterval::SP> intervals;
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./history.his",
+                             1024, 16, 15123456, intervals);
+
+    // reference source: no cache
+    std::unique_ptr<HistoryFileSource> refSource {new HistoryFileSource};
+    refSource->open("./history.his");
+
+    const NodeCacheType types[] = {
+        NodeCacheType::PASS_THROUGH,
+        NodeCacheType::DIRECT_MAPPED,
+        NodeCacheType::LRU,
+        NodeCacheType::TWO_QUEUE,
+        NodeCacheType::ARC,
+    };
+
+    for (auto type : types) {
+        std::unique_ptr<HistoryFileSource> hfSource {new HistoryFileSource};
+        hfSource->open("./history.his", type, 16);
+
+        for (timestamp_t ts = 15123456; ts < 30000101; ts += 99991) {
+            IntervalJar refJar;
+            IntervalJar jar;
+            refSource->findAll(ts, refJar);
+            hfSource->findAll(ts, jar);
+            CPPUNIT_ASSERT_EQUAL(refJar.size(), jar.size());
+        }
+
+        hfSource->close();
+    }
+
+    // direct mapped cache size must be a power of two
+    try {
+        std::unique_ptr<HistoryFileSource> hfSource {new HistoryFileSource};
+        hfSource->open("./history.his", NodeCacheType::DIRECT_MAPPED, 12);
+        CPPUNIT_FAIL("Opened with a direct mapped cache of invalid size");
+    } catch (const std::invalid_argument& ex) {
+    }
+
+    // only LRU and 2Q caches support a byte budget
+    for (auto type : {NodeCacheType::DIRECT_MAPPED, NodeCacheType::ARC}) {
+        std::unique_ptr<HistoryFileSource> hfSource {new HistoryFileSource};
+        CPPUNIT_ASSERT_THROW(hfSource->open("./history.his", type, 16, 65536),
+                             std::invalid_argument);
+        CPPUNIT_ASSERT(!hfSource->isOpened());
+    }
+
+    std::unique_ptr<HistoryFileSource> budgetSource {new HistoryFileSource};
+    budgetSource->open("./history.his", NodeCacheType::LRU, 16, 65536);
+    budgetSource->close();
+
+    refSource->close();
+    bfs::remove("./history.his");
+}
+
+void HistoryFileTest::testPinnedLevels()
+{
+    std::vector<AbstractInterval::SP> intervals;
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./history.his",
+                             1024, 4, 15123456, intervals);
+
+    // reference source: nothing pinned
+    std::unique_ptr<HistoryFileSource> refSource {new HistoryFileSource};
+    refSource->open("./history.his");
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(0),
+                         refSource->getPinnedNodeCount());
+
+    // pin two levels: root and its children
+    std::shared_ptr<AbstractNodeCache> cache {new LruNodeCache {8}};
+    cache->setLevelStatsEnabled(true);
+    std::unique_ptr<HistoryFileSource> hfSource {new HistoryFileSource};
+    hfSource->setPinnedLevels(2);
+    hfSource->open("./history.his", cache);
+    CPPUNIT_ASSERT(hfSource->getPinnedNodeCount() > 1);
+    CPPUNIT_ASSERT(hfSource->getPinnedNodeCount() <= 5);
+    CPPUNIT_ASSERT(hfSource->getPinnedMemorySize() > 0);
+
+    for (timestamp_t ts = 15123456; ts < 30000101; ts += 99991) {
+        IntervalJar refJar;
+        IntervalJar jar;
+        CPPUNIT_ASSERT_EQUAL(refSource->findAll(ts, refJar),
+                             hfSource->findAll(ts, jar));
+        CPPUNIT_ASSERT_EQUAL(refJar.size(), jar.size());
+    }
+
+    // pinned levels never go through the cache
+    const auto& levelStats = cache->getLevelStats();
+    CPPUNIT_ASSERT(levelStats.size() > 2);
+    for (std::size_t level = 0; level < 2; ++level) {
+        CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(0),
+                             levelStats[level].hits +
+                             levelStats[level].misses);
+    }
+
+    // byte budget reached within the second level: partially pinned
+    auto pinnedNodeCount = hfSource->getPinnedNodeCount();
+    auto pinnedMemorySize = hfSource->getPinnedMemorySize();
+    hfSource->close();
+    hfSource->setPinnedLevels(2, pinnedMemorySize - 1);
+    hfSource->open("./history.his");
+    CPPUNIT_ASSERT(hfSource->getPinnedNodeCount() >= 1);
+    CPPUNIT_ASSERT(hfSource->getPinnedNodeCount() < pinnedNodeCount);
+    CPPUNIT_ASSERT(hfSource->getPinnedMemorySize() < pinnedMemorySize);
+
+    // tiny byte budget: nothing fits
+    hfSource->close();
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(0),
+                         hfSource->getPinnedNodeCount());
+    hfSource->setPinnedLevels(3, 1);
+    hfSource->open("./history.his");
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(0),
+                         hfSource->getPinnedNodeCount());
+
+    hfSource->close();
+    refSource->close();
+    bfs::remove("./history.his");
+}
+
+void HistoryFileTest::testWarmUp()
+{
+    std::vector<AbstractInterval::SP> intervals;
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./history.his",
+                             1024, 4, 15123456, intervals);
+
+    // all nodes follow the 4 kiB header
+    std::size_t nodeCount = (bfs::file_size("./history.his") - 4096) / 1024;
+
+    std::unique_ptr<HistoryFileSource> refSource {new HistoryFileSource};
+    refSource->open("./history.his");
+
+    // warm up all levels: every query hits the cache afterwards
+    std::shared_ptr<AbstractNodeCache> cache {new LruNodeCache {4096}};
+    std::unique_ptr<HistoryFileSource> hfSource {new HistoryFileSource};
+    hfSource->setWarmUpLevels(64, 3);
+    hfSource->open("./history.his", cache);
+    hfSource->waitForWarmUp();
+    CPPUNIT_ASSERT(!hfSource->isWarmingUp());
+    CPPUNIT_ASSERT_EQUAL(nodeCount, cache->getStats().nodeCount);
+    cache->resetStats();
+
+    for (timestamp_t ts = 15123456; ts < 30000101; ts += 99991) {
+        IntervalJar refJar;
+        IntervalJar jar;
+        CPPUNIT_ASSERT_EQUAL(refSource->findAll(ts, refJar),
+                             hfSource->findAll(ts, jar));
+        CPPUNIT_ASSERT_EQUAL(refJar.size(), jar.size());
+    }
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(0),
+                         cache->getStats().misses);
+
+    // warm up a time range while querying
+    const timestamp_t begin = 19000101;
+    const timestamp_t end = 19500101;
+
+    hfSource->close();
+    cache.reset(new LruNodeCache {4096});
+    hfSource->setWarmUpRange(begin, end, 2);
+    hfSource->open("./history.his", cache);
+
+    for (timestamp_t ts = 15123456; ts < 30000101; ts += 199999) {
+        IntervalJar refJar;
+        IntervalJar jar;
+        CPPUNIT_ASSERT_EQUAL(refSource->findAll(ts, refJar),
+                             hfSource->findAll(ts, jar));
+        CPPUNIT_ASSERT_EQUAL(refJar.size(), jar.size());
+    }
+
+    hfSource->waitForWarmUp();
+    CPPUNIT_ASSERT(cache->getStats().nodeCount < nodeCount);
+    cache->resetStats();
+
+    for (timestamp_t ts = begin; ts < end; ts += 9973) {
+        IntervalJar jar;
+        hfSource->findAll(ts, jar);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(0),
+                         cache->getStats().misses);
+
+    // closing while warming up
+    hfSource->close();
+    cache.reset(new LruNodeCache {4096});
+    hfSource->setWarmUpLevels(64);
+    hfSource->open("./history.his", cache);
+    hfSource->close();
+    CPPUNIT_ASSERT(!hfSource->isWarmingUp());
+
+    refSource->close();
+    bfs::remove("./history.his");
+}
+
+void HistoryFileTest::testAccessLog()
+{
+    std::vector<AbstractInterval::SP> intervals;
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./history.his",
+                             1024, 4, 15123456, intervals);
+
+    const bfs::path logPath {"./history.his.access"};
+    bfs::remove(logPath);
+
+    // the daily workload: a few queries within a time range
+    auto runWorkload = [] (HistoryFileSource& source) {
+        for (timestamp_t ts = 19400101; ts < 19600101; ts += 3001) {
+            IntervalJar jar;
+            source.findAll(ts, jar);
+        }
+    };
+
+    // record with a small cache
+    std::unique_ptr<HistoryFileSource> hfSource {new HistoryFileSource};
+    hfSource->setAccessLog(logPath, true, false);
+    hfSource->open("./history.his",
+                   std::shared_ptr<AbstractNodeCache> {new LruNodeCache {4}});
+    runWorkload(*hfSource);
+    hfSource->close();
+    CPPUNIT_ASSERT(bfs::exists(logPath));
+
+    // preload: the workload only hits the cache
+    std::shared_ptr<AbstractNodeCache> cache {new LruNodeCache {4096}};
+    hfSource->setAccessLog(logPath, true, true);
+    hfSource->open("./history.his", cache);
+    hfSource->waitForWarmUp();
+    auto preloadedNodeCount = cache->getStats().nodeCount;
+    CPPUNIT_ASSERT(preloadedNodeCount > 1);
+    cache->resetStats();
+    runWorkload(*hfSource);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(0),
+                         cache->getStats().misses);
+    hfSource->close();
+
+    // merged log: same hot set
+    cache.reset(new LruNodeCache {4096});
+    hfSource->open("./history.his", cache);
+    hfSource->waitForWarmUp();
+    CPPUNIT_ASSERT_EQUAL(preloadedNodeCount, cache->getStats().nodeCount);
+
+    // hottest nodes only, up to the cache size
+    hfSource->close();
+    cache.reset(new LruNodeCache {2});
+    hfSource->setAccessLog(logPath, false, true);
+    hfSource->open("./history.his", cache);
+    hfSource->waitForWarmUp();
+    CPPUNIT_ASSERT(cache->getStats().nodeCount <= 2);
+    hfSource->close();
+
+    // not recording
+    CPPUNIT_ASSERT_THROW(hfSource->saveAccessLog(), ex::IO);
+
+    // saving again, or when closing, doesn't count accesses twice
+    auto readLog = [&logPath] () {
+        std::ifstream file {logPath.string(), std::ios::binary};
+
+        return std::string {std::istreambuf_iterator<char> {file},
+                            std::istreambuf_iterator<char> {}};
+    };
+
+    hfSource->setAccessLog(logPath, true, false);
+    hfSource->open("./history.his");
+    runWorkload(*hfSource);
+    hfSource->saveAccessLog();
+    auto savedLog = readLog();
+    hfSource->saveAccessLog();
+    CPPUNIT_ASSERT(savedLog == readLog());
+    hfSource->close();
+    CPPUNIT_ASSERT(savedLog == readLog());
+
+    // log of another history (different file size): not preloaded
+    {
+        std::fstream file {logPath.string(),
+                           std::ios::in | std::ios::out | std::ios::binary};
+        std::uint64_t fileSize;
+        file.seekg(24);
+        file.read(reinterpret_cast<char*>(&fileSize), sizeof(fileSize));
+        CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(bfs::file_size("./history.his")),
+                             fileSize);
+        fileSize++;
+        file.seekp(24);
+        file.write(reinterpret_cast<char*>(&fileSize), sizeof(fileSize));
+    }
+
+    cache.reset(new LruNodeCache {4096});
+    hfSource->setAccessLog(logPath, false, true);
+    hfSource->open("./history.his", cache);
+    hfSource->waitForWarmUp();
+    CPPUNIT_ASSERT(cache->getStats().nodeCount <= 1);
+    hfSource->close();
+
+    bfs::remove(logPath);
+    bfs::remove("./history.his");
+}
+
+void HistoryFileTest::testCompactNodeSerDes()
+{
+    std::vector<AbstractInterval::SP> intervals;
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./aligned.his",
+                             1024, 4, 15123456, intervals);
+    intervals.clear();
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./compact.his",
+                             1024, 4, 15123456, intervals,
+                             NodeSerDesType::COMPACT);
+
+    // fewer nodes
+    CPPUNIT_ASSERT(bfs::file_size("./compact.his") <
+                   bfs::file_size("./aligned.his"));
+
+    // same answers
+    HistoryFileSource alignedSource;
+    HistoryFileSource compactSource;
+    alignedSource.open("./aligned.his");
+    compactSource.open("./compact.his");
+    CPPUNIT_ASSERT_EQUAL(alignedSource.getBegin(), compactSource.getBegin());
+    CPPUNIT_ASSERT_EQUAL(alignedSource.getEnd(), compactSource.getEnd());
+
+    for (timestamp_t ts = 15123456; ts < 30000101; ts += 49999) {
+        IntervalJar alignedJar;
+        IntervalJar compactJar;
+        alignedSource.findAll(ts, alignedJar);
+        compactSource.findAll(ts, compactJar);
+        CPPUNIT_ASSERT_EQUAL(alignedJar.size(), compactJar.size());
+
+        for (const auto& entry : alignedJar) {
+            auto it = compactJar.find(entry.first);
+            CPPUNIT_ASSERT(it != compactJar.end());
+            CPPUNIT_ASSERT_EQUAL(entry.second->getBegin(),
+                                 it->second->getBegin());
+            CPPUNIT_ASSERT_EQUAL(entry.second->getEnd(), it->second->getEnd());
+            CPPUNIT_ASSERT_EQUAL(
+                static_cast<const StringInterval&>(*entry.second).getValue(),
+                static_cast<const StringInterval&>(*it->second).getValue());
+        }
+    }
+
+    alignedSource.close();
+    compactSource.close();
+    bfs::remove("./aligned.his");
+    bfs::remove("./compact.his");
+}
+
+void HistoryFileTest::testCompressedNodeSerDes()
+{
+    std::vector<AbstractInterval::SP> intervals;
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./aligned.his",
+                             4096, 4, 15123456, intervals);
+    intervals.clear();
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./compact.his",
+                             4096, 4, 15123456, intervals,
+                             NodeSerDesType::COMPACT);
+    intervals.clear();
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./compressed.his",
+                             4096, 4, 15123456, intervals,
+                             NodeSerDesType::COMPRESSED);
+
+    // smaller than both aligned and compact histories
+    CPPUNIT_ASSERT(bfs::file_size("./compressed.his") <
+                   bfs::file_size("./compact.his"));
+    CPPUNIT_ASSERT(bfs::file_size("./compressed.his") <
+                   bfs::file_size("./aligned.his"));
+
+    // same answers, from a warmed up cache
+    HistoryFileSource alignedSource;
+    HistoryFileSource compressedSource;
+    HistoryFileSource uncachedSource;
+    std::shared_ptr<AbstractNodeCache> cache {new LruNodeCache {4096}};
+    alignedSource.open("./aligned.his");
+    uncachedSource.open("./compressed.his");
+    compressedSource.setWarmUpLevels(64, 2);
+    compressedSource.open("./compressed.his", cache);
+    compressedSource.waitForWarmUp();
+
+    // bytes read, not the node size
+    auto stats = cache->getStats();
+    CPPUNIT_ASSERT(stats.bytesLoaded > 0);
+    CPPUNIT_ASSERT(stats.bytesLoaded < bfs::file_size("./compressed.his"));
+    CPPUNIT_ASSERT(stats.bytesLoaded < stats.nodeCount * 4096);
+    cache->resetStats();
+    CPPUNIT_ASSERT_EQUAL(alignedSource.getBegin(), compressedSource.getBegin());
+    CPPUNIT_ASSERT_EQUAL(alignedSource.getEnd(), compressedSource.getEnd());
+
+    for (timestamp_t ts = 15123456; ts < 30000101; ts += 49999) {
+        IntervalJar alignedJar;
+        IntervalJar compressedJar;
+        IntervalJar uncachedJar;
+        alignedSource.findAll(ts, alignedJar);
+        compressedSource.findAll(ts, compressedJar);
+        uncachedSource.findAll(ts, uncachedJar);
+        CPPUNIT_ASSERT_EQUAL(alignedJar.size(), compressedJar.size());
+        CPPUNIT_ASSERT_EQUAL(alignedJar.size(), uncachedJar.size());
+
+        for (const auto& entry : alignedJar) {
+            auto it = compressedJar.find(entry.first);
+            CPPUNIT_ASSERT(it != compressedJar.end());
+            CPPUNIT_ASSERT_EQUAL(entry.second->getBegin(),
+                                 it->second->getBegin());
+            CPPUNIT_ASSERT_EQUAL(entry.second->getEnd(), it->second->getEnd());
+            CPPUNIT_ASSERT_EQUAL(
+                static_cast<const StringInterval&>(*entry.second).getValue(),
+                static_cast<const StringInterval&>(*it->second).getValue());
+        }
+    }
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(0),
+                         cache->getStats().misses);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(0),
+                         cache->getStats().bytesLoaded);
+
+    // on misses too
+    std::shared_ptr<AbstractNodeCache> missCache {new LruNodeCache {4096}};
+    HistoryFileSource missSource;
+    missSource.open("./compressed.his", missCache);
+    IntervalJar missJar;
+    missSource.findAll(20000101, missJar);
+    stats = missCache->getStats();
+    CPPUNIT_ASSERT(stats.misses > 0);
+    CPPUNIT_ASSERT(stats.bytesLoaded > 0);
+    CPPUNIT_ASSERT(stats.bytesLoaded < stats.misses * 4096);
+    CPPUNIT_ASSERT(stats.bytesLoaded < stats.decodedBytesLoaded);
+    missSource.close();
+
+    // scanning finds every interval
+    std::atomic<std::size_t> alignedCount {0};
+    std::atomic<std::size_t> compressedCount {0};
+    alignedSource.scan([&alignedCount] (std::size_t,
+                                        const AbstractInterval::SP&) {
+        alignedCount++;
+    });
+    compressedSource.scan([&compressedCount] (std::size_t,
+                                              const AbstractInterval::SP&) {
+        compressedCount++;
+    }, 3, 2000);
+    CPPUNIT_ASSERT_EQUAL(alignedCount.load(), compressedCount.load());
+
+    alignedSource.close();
+    compressedSource.close();
+    uncachedSource.close();
+    bfs::remove("./aligned.his");
+    bfs::remove("./compact.his");
+    bfs::remove("./compressed.his");
+}
+
+void HistoryFileTest::testColumnarNodeSerDes()
+{
+    std::vector<AbstractInterval::SP> intervals;
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./aligned.his",
+                             1024, 4, 15123456, intervals);
+    intervals.clear();
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./columnar.his",
+                             1024, 4, 15123456, intervals,
+                             NodeSerDesType::COLUMNAR);
+
+    // same answers
+    HistoryFileSource alignedSource;
+    HistoryFileSource columnarSource;
+    alignedSource.open("./aligned.his");
+    columnarSource.open("./columnar.his");
+    CPPUNIT_ASSERT_EQUAL(alignedSource.getBegin(), columnarSource.getBegin());
+    CPPUNIT_ASSERT_EQUAL(alignedSource.getEnd(), columnarSource.getEnd());
+
+    for (timestamp_t ts = 15123456; ts < 30000101; ts += 49999) {
+        IntervalJar alignedJar;
+        IntervalJar columnarJar;
+        alignedSource.findAll(ts, alignedJar);
+        columnarSource.findAll(ts, columnarJar);
+        CPPUNIT_ASSERT_EQUAL(alignedJar.size(), columnarJar.size());
+
+        for (const auto& entry : alignedJar) {
+            auto it = columnarJar.find(entry.first);
+            CPPUNIT_ASSERT(it != columnarJar.end());
+            CPPUNIT_ASSERT_EQUAL(entry.second->getBegin(),
+                                 it->second->getBegin());
+            CPPUNIT_ASSERT_EQUAL(entry.second->getEnd(), it->second->getEnd());
+            CPPUNIT_ASSERT_EQUAL(
+                static_cast<const StringInterval&>(*entry.second).getValue(),
+                static_cast<const StringInterval&>(*it->second).getValue());
+        }
+    }
+
+    alignedSource.close();
+    columnarSource.close();
+    bfs::remove("./aligned.his");
+    bfs::remove("./columnar.his");
+}
+
+void HistoryFileTest::testRelativeTimestamps()
+{
+    // nanosecond timestamps with a few long gaps
+    const timestamp_t begin = 1500000000000000000LL;
+
+    for (int relative = 0; relative < 2; ++relative) {
+        HistoryFileSink sink;
+        sink.open(relative ? "./relative.his" : "./history.his", 1024, 4,
+                  begin, relative ? NodeSerDesType::ALIGNED_RELATIVE :
+                                    NodeSerDesType::ALIGNED);
+        timestamp_t ts = begin;
+
+        for (int x = 0; x < 3000; ++x) {
+            auto duration = (x % 700 == 699) ? (1LL << 33) : 1000;
+            Int32Interval::SP interval {
+                new Int32Interval {ts, ts + duration, static_cast<interval_key_t>(x % 5)}
+            };
+            interval->setValue(x);
+            sink.addInterval(interval);
+            ts += duration;
+        }
+
+        sink.close();
+    }
+
+    // fewer nodes
+    CPPUNIT_ASSERT(bfs::file_size("./relative.his") <
+                   bfs::file_size("./history.his"));
+
+    // same answers
+    HistoryFileSource refSource;
+    HistoryFileSource hfSource;
+    refSource.open("./history.his");
+    hfSource.open("./relative.his");
+    CPPUNIT_ASSERT_EQUAL(refSource.getEnd(), hfSource.getEnd());
+
+    for (timestamp_t ts = begin; ts < hfSource.getEnd();
+            ts += (hfSource.getEnd() - begin) / 4999) {
+        IntervalJar refJar;
+        IntervalJar jar;
+        refSource.findAll(ts, refJar);
+        hfSource.findAll(ts, jar);
+        CPPUNIT_ASSERT_EQUAL(refJar.size(), jar.size());
+
+        for (const auto& entry : refJar) {
+            const auto& interval = *jar[entry.first];
+            CPPUNIT_ASSERT_EQUAL(entry.second->getBegin(), interval.getBegin());
+            CPPUNIT_ASSERT_EQUAL(entry.second->getEnd(), interval.getEnd());
+            CPPUNIT_ASSERT_EQUAL(entry.second->getFixedValue(),
+                                 interval.getFixedValue());
+        }
+    }
+
+    refSource.close();
+    hfSource.close();
+    bfs::remove("./history.his");
+    bfs::remove("./relative.his");
+}
+
+void HistoryFileTest::testWideValues()
+{
+    const NodeSerDesType types[] = {
+        NodeSerDesType::ALIGNED,
+        NodeSerDesType::ALIGNED_WIDE,
+        NodeSerDesType::ALIGNED_WIDE_RELATIVE,
+    };
+    const char* paths[] = {"./history.his", "./wide.his", "./widerel.his"};
+
+    // doubles: almost never inline with 32-bit value fields
+    for (int x = 0; x < 3; ++x) {
+        HistoryFileSink sink;
+        sink.open(paths[x], 1024, 4, 0, types[x]);
+
+        for (timestamp_t ts = 0; ts < 20000; ts += 10) {
+            DoubleInterval::SP interval {
+                new DoubleInterval {ts, ts + 10, static_cast<interval_key_t>(ts % 7)}
+            };
+            interval->setValue(static_cast<double>(ts) / 3);
+            sink.addInterval(interval);
+        }
+
+        sink.close();
+    }
+
+    // fewer nodes
+    CPPUNIT_ASSERT(bfs::file_size("./wide.his") <
+                   bfs::file_size("./history.his"));
+    CPPUNIT_ASSERT(bfs::file_size("./widerel.his") <
+                   bfs::file_size("./wide.his"));
+
+    // same answers
+    HistoryFileSource refSource;
+    refSource.open(paths[0]);
+
+    for (int x = 1; x < 3; ++x) {
+        HistoryFileSource hfSource;
+        hfSource.open(paths[x]);
+
+        for (timestamp_t ts = 0; ts < 20000; ts += 7) {
+            IntervalJar refJar;
+            IntervalJar jar;
+            refSource.findAll(ts, refJar);
+            hfSource.findAll(ts, jar);
+            CPPUNIT_ASSERT_EQUAL(refJar.size(), jar.size());
+
+            for (const auto& entry : refJar) {
+                const auto& interval = *jar[entry.first];
+                CPPUNIT_ASSERT_EQUAL(entry.second->getBegin(),
+                                     interval.getBegin());
+                CPPUNIT_ASSERT_EQUAL(
+                    static_cast<const DoubleInterval&>(*entry.second).getValue(),
+                    static_cast<const DoubleInterval&>(interval).getValue());
+            }
+        }
+
+        hfSource.close();
+    }
+
+    refSource.close();
+
+    for (auto path : paths) {
+        bfs::remove(path);
+    }
+}
+
+void HistoryFileTest::testStringDictionary()
+{
+    // few distinct states, many times
+    const char* states[] = {"RUNNING", "WAIT_BLOCKED", "WAIT_CPU", "SYSCALL"};
+    std::vector<StringInterval::SP> intervals;
+
+    for (timestamp_t ts = 0; ts < 20000; ts += 10) {
+        StringInterval::SP interval {
+            new StringInterval {ts, ts + 10, static_cast<interval_key_t>(ts % 3)}
+        };
+        interval->setValue(states[(ts / 10) % 4]);
+        intervals.push_back(interval);
+    }
+
+    for (int encoded = 0; encoded < 2; ++encoded) {
+        HistoryFileSink sink;
+        sink.setStringDictionaryEnabled(encoded);
+        sink.open(encoded ? "./dict.his" : "./history.his", 1024, 8);
+
+        for (const auto& interval : intervals) {
+            sink.addInterval(interval);
+        }
+
+        sink.close();
+    }
+
+    // smaller nodes, thus a smaller file
+    CPPUNIT_ASSERT(bfs::file_size("./dict.his") <
+                   bfs::file_size("./history.his"));
+
+    HistoryFileSource refSource;
+    HistoryFileSource hfSource;
+    refSource.open("./history.his");
+    hfSource.open("./dict.his");
+    CPPUNIT_ASSERT(!refSource.getStringDictionary());
+
+    auto dictionary = hfSource.getStringDictionary();
+    CPPUNIT_ASSERT(dictionary);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(4), dictionary->getSize());
+
+    interval_value_t runningId;
+    CPPUNIT_ASSERT(dictionary->findId("RUNNING", runningId));
+
+    for (timestamp_t ts = 0; ts < 20000; ts += 7) {
+        IntervalJar refJar;
+        IntervalJar jar;
+        refSource.findAll(ts, refJar);
+        hfSource.findAll(ts, jar);
+        CPPUNIT_ASSERT_EQUAL(refJar.size(), jar.size());
+
+        for (const auto& entry : refJar) {
+            const auto& refInterval = static_cast<const StringInterval&>(*entry.second);
+            const auto& interval =
+                static_cast<const DictionaryStringInterval&>(*jar[entry.first]);
+            CPPUNIT_ASSERT_EQUAL(refInterval.getValue(), interval.getValue());
+            CPPUNIT_ASSERT(interval.getDictionary() == dictionary);
+            CPPUNIT_ASSERT_EQUAL(refInterval.getValue() == "RUNNING",
+                                 interval.getFixedValue() == runningId);
+        }
+    }
+
+    refSource.close();
+    hfSource.close();
+
+    // readers unaware of the dictionary don't recognize the magic number
+    {
+        std::fstream file {"./dict.his",
+                           std::ios::in | std::ios::out | std::ios::binary};
+        std::uint32_t magic;
+        file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+        CPPUNIT_ASSERT_EQUAL(static_cast<std::uint32_t>(0x21b6a980), magic);
+
+        // dictionary no longer announced
+        magic = 0x21b4a980;
+        file.seekp(0);
+        file.write(reinterpret_cast<char*>(&magic), sizeof(magic));
+    }
+
+    CPPUNIT_ASSERT_THROW(hfSource.open("./dict.his"), ex::IO);
+
+    // string interval subclasses with their own type are left alone
+    class TaggedStringInterval :
+        public StringInterval
+    {
+    public:
+        TaggedStringInterval(timestamp_t begin, timestamp_t end) :
+            StringInterval {begin, end, 0, 200}
+        {
+        }
+    };
+
+    HistoryFileSink sink;
+    sink.setStringDictionaryEnabled(true);
+    sink.open("./dict.his", 1024, 8);
+
+    StringInterval::SP interval {new TaggedStringInterval {0, 10}};
+    interval->setValue("TAGGED");
+    sink.addInterval(interval);
+
+    // more leaves: the root node has no tagged interval to decode
+    for (timestamp_t ts = 0; ts < 2000; ts += 10) {
+        interval.reset(new StringInterval {ts, ts + 10, 1});
+        interval->setValue("RUNNING");
+        sink.addInterval(interval);
+    }
+
+    sink.close();
+
+    hfSource.open("./dict.his");
+    dictionary = hfSource.getStringDictionary();
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(1), dictionary->getSize());
+    CPPUNIT_ASSERT(!dictionary->findId("TAGGED", runningId));
+    hfSource.close();
+
+    bfs::remove("./history.his");
+    bfs::remove("./dict.his");
+}
+
+void HistoryFileTest::testNodeChecksums()
+{
+    for (int compressed = 0; compressed < 2; ++compressed) {
+        HistoryFileSink sink;
+        sink.setNodeChecksumsEnabled(true);
+        sink.open(compressed ? "./compressed.his" : "./history.his", 1024, 4,
+                  0, compressed ? NodeSerDesType::COMPRESSED :
+                                  NodeSerDesType::ALIGNED);
+
+        for (timestamp_t ts = 0; ts < 5000; ts += 10) {
+            Int32Interval::SP interval {
+                new Int32Interval {ts, ts + 10, static_cast<interval_key_t>(ts % 7)}
+            };
+            interval->setValue(static_cast<std::int32_t>(ts));
+            sink.addInterval(interval);
+        }
+
+        sink.close();
+    }
+
+    // intact nodes: same answers
+    HistoryFileSource refSource;
+    HistoryFileSource compressedSource;
+    refSource.open("./history.his");
+    compressedSource.open("./compressed.his");
+
+    for (timestamp_t ts = 0; ts < 5000; ts += 13) {
+        IntervalJar refJar;
+        IntervalJar jar;
+        refSource.findAll(ts, refJar);
+        compressedSource.findAll(ts, jar);
+        CPPUNIT_ASSERT_EQUAL(refJar.size(), jar.size());
+    }
+
+    std::size_t count = 0;
+    compressedSource.scan([&count] (std::size_t, const AbstractInterval::SP&) {
+        count++;
+    });
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(500), count);
+    refSource.close();
+    compressedSource.close();
+
+    // cache the first leaf node, then corrupt it
+    std::shared_ptr<AbstractNodeCache> cache {new LruNodeCache {64}};
+    HistoryFileSource cachedSource;
+    HistoryFileSource hfSource;
+    IntervalJar jar;
+    cachedSource.open("./history.his", cache);
+    CPPUNIT_ASSERT(cachedSource.findAll(0, jar));
+
+    {
+        std::fstream file {"./history.his",
+                           std::ios::in | std::ios::out | std::ios::binary};
+        file.seekg(4096 + 100);
+        auto byte = file.get();
+        file.seekp(4096 + 100);
+        file.put(static_cast<char>(byte ^ 0x20));
+    }
+
+    // cached nodes are not verified again
+    jar.clear();
+    CPPUNIT_ASSERT(cachedSource.findAll(0, jar));
+
+    hfSource.open("./history.his");
+    CPPUNIT_ASSERT_THROW(hfSource.findAll(0, jar), ex::CorruptedNode);
+    CPPUNIT_ASSERT_THROW(hfSource.scan([] (std::size_t,
+                                           const AbstractInterval::SP&) {
+    }, 2), ex::CorruptedNode);
+
+    // other nodes are still fine
+    jar.clear();
+    CPPUNIT_ASSERT(hfSource.findAll(4990, jar));
+
+    cachedSource.close();
+    hfSource.close();
+    bfs::remove("./history.his");
+    bfs::remove("./compressed.his");
+}
+
+void HistoryFileTest::testNodeDirectory()
+{
+    std::vector<AbstractInterval::SP> intervals;
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./history.his",
+                             1024, 4, 15123456, intervals);
+
+    HistoryFileSource hfSource;
+    hfSource.open("./history.his");
+    CPPUNIT_ASSERT(hfSource.hasNodeDirectory());
+    CPPUNIT_ASSERT(hfSource.getLevelCount() > 2);
+
+    // every node but the root is one level below its parent
+    HistoryFileSource::NodeInfo info;
+    std::size_t intervalCount = 0;
+    std::size_t rootCount = 0;
+    node_seq_t seq = 0;
+
+    for (; hfSource.getNodeInfo(seq, info); ++seq) {
+        intervalCount += info.intervalCount;
+
+        if (info.level == 0) {
+            CPPUNIT_ASSERT_EQUAL(Node::ROOT_PARENT_SEQ_NUMBER(),
+                                 info.parentSeqNumber);
+            CPPUNIT_ASSERT_EQUAL(hfSource.getBegin(), info.begin);
+            CPPUNIT_ASSERT_EQUAL(hfSource.getEnd(), info.end);
+            rootCount++;
+            continue;
+        }
+
+        HistoryFileSource::NodeInfo parentInfo;
+        CPPUNIT_ASSERT(hfSource.getNodeInfo(info.parentSeqNumber, parentInfo));
+        CPPUNIT_ASSERT_EQUAL(parentInfo.level + 1, info.level);
+        CPPUNIT_ASSERT(info.begin >= parentInfo.begin);
+        CPPUNIT_ASSERT(info.end <= parentInfo.end);
+    }
+
+    CPPUNIT_ASSERT(seq > 1);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(1), rootCount);
+    CPPUNIT_ASSERT_EQUAL(intervals.size(), intervalCount);
+
+    // leaves covering a window, one after the other
+    for (timestamp_t begin = 15123456; begin < 30000000; begin += 999983) {
+        auto end = std::min(begin + 3000000, hfSource.getEnd());
+        std::vector<node_seq_t> seqs;
+        hfSource.findLeavesInRange(begin, end, seqs);
+        CPPUNIT_ASSERT(!seqs.empty());
+
+        HistoryFileSource::NodeInfo prevInfo;
+
+        for (std::size_t x = 0; x < seqs.size(); ++x) {
+            CPPUNIT_ASSERT(hfSource.getNodeInfo(seqs[x], info));
+            CPPUNIT_ASSERT_EQUAL(hfSource.getLevelCount() - 1, info.level);
+            CPPUNIT_ASSERT(info.begin < end);
+            CPPUNIT_ASSERT(info.end > begin);
+
+            if (x == 0) {
+                CPPUNIT_ASSERT(info.begin <= begin);
+            } else {
+                CPPUNIT_ASSERT_EQUAL(prevInfo.end, info.begin);
+            }
+
+            prevInfo = info;
+        }
+
+        CPPUNIT_ASSERT(prevInfo.end >= end);
+    }
+
+    hfSource.close();
+
+    // without node directory
+    HistoryFileSink hfSink;
+    hfSink.setNodeDirectoryEnabled(false);
+    hfSink.open("./history.his", 1024, 4);
+    hfSink.close();
+    hfSource.open("./history.his");
+    CPPUNIT_ASSERT(!hfSource.hasNodeDirectory());
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(0), hfSource.getLevelCount());
+    CPPUNIT_ASSERT(!hfSource.getNodeInfo(0, info));
+    hfSource.close();
+    bfs::remove("./history.his");
+}
+
+void HistoryFileTest::testExtensionNodes()
+{
+    // every 50th string is much larger than a node
+    auto makeValue = [] (timestamp_t ts) {
+        std::string value = "value " + std::to_string(ts);
+
+        if (ts % 500 == 0) {
+            value.append(5000 + ts, 'x');
+        }
+
+        return value;
+    };
+
+    for (int compressed = 0; compressed < 2; ++compressed) {
+        HistoryFileSink sink;
+        sink.setNodeExtensionEnabled(true);
+        sink.open(compressed ? "./compressed.his" : "./history.his", 1024, 4,
+                  0, compressed ? NodeSerDesType::COMPRESSED :
+                                  NodeSerDesType::ALIGNED);
+
+        for (timestamp_t ts = 0; ts < 5000; ts += 10) {
+            StringInterval::SP interval {
+                new StringInterval {ts, ts + 10, static_cast<interval_key_t>(ts % 7)}
+            };
+            interval->setValue(makeValue(ts));
+            sink.addInterval(interval);
+        }
+
+        sink.close();
+    }
+
+    for (int compressed = 0; compressed < 2; ++compressed) {
+        std::shared_ptr<AbstractNodeCache> cache {new LruNodeCache {4096}};
+        HistoryFileSource hfSource;
+        HistoryFileSource cachedSource;
+        auto path = compressed ? "./compressed.his" : "./history.his";
+        hfSource.open(path);
+        cachedSource.setWarmUpLevels(64, 2);
+        cachedSource.open(path, cache);
+        cachedSource.waitForWarmUp();
+
+        for (timestamp_t ts = 0; ts < 5000; ts += 10) {
+            auto interval = hfSource.findOne(ts + 5,
+                static_cast<interval_key_t>(ts % 7));
+            CPPUNIT_ASSERT(interval);
+            CPPUNIT_ASSERT_EQUAL(ts, interval->getBegin());
+            CPPUNIT_ASSERT_EQUAL(makeValue(ts),
+                static_cast<const StringInterval&>(*interval).getValue());
+
+            interval = cachedSource.findOne(ts + 5,
+                static_cast<interval_key_t>(ts % 7));
+            CPPUNIT_ASSERT(interval);
+            CPPUNIT_ASSERT_EQUAL(makeValue(ts),
+                static_cast<const StringInterval&>(*interval).getValue());
+        }
+
+        std::atomic<std::size_t> count {0};
+        hfSource.scan([&count] (std::size_t, const AbstractInterval::SP&) {
+            count++;
+        }, 3, 2000);
+        CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(500), count.load());
+        hfSource.close();
+        cachedSource.close();
+    }
+
+    // readers unaware of extension nodes don't recognize the magic number
+    {
+        std::fstream file {"./history.his",
+                           std::ios::in | std::ios::out | std::ios::binary};
+        std::uint32_t magic;
+        file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+        CPPUNIT_ASSERT_EQUAL(static_cast<std::uint32_t>(0x21b5a980), magic);
+
+        // unknown major version
+        std::uint16_t major = 2;
+        file.seekp(sizeof(magic));
+        file.write(reinterpret_cast<char*>(&major), sizeof(major));
+    }
+
+    HistoryFileSource hfSource;
+    CPPUNIT_ASSERT_THROW(hfSource.open("./history.his"), ex::IO);
+
+    // without extension nodes, such an interval cannot be added
+    HistoryFileSink sink;
+    sink.open("./history.his", 1024, 4);
+    StringInterval::SP interval {new StringInterval {0, 10, 0}};
+    interval->setValue(makeValue(0));
+    CPPUNIT_ASSERT_THROW(sink.addInterval(interval), ex::NodeFull);
+    sink.close();
+
+    bfs::remove("./history.his");
+    bfs::remove("./compressed.his");
+}
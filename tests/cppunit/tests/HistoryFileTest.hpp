@@ -29,6 +29,22 @@ class HistoryFileTest :
         CPPUNIT_TEST(testQueryWhenClosed);
         CPPUNIT_TEST(testBuildEmpty);
         CPPUNIT_TEST(testAddFindIntervals);
+        CPPUNIT_TEST(testVisitorQueries);
+        CPPUNIT_TEST(testFlatJarQueries);
+        CPPUNIT_TEST(testScan);
+        CPPUNIT_TEST(testNodeCacheTypes);
+        CPPUNIT_TEST(testPinnedLevels);
+        CPPUNIT_TEST(testWarmUp);
+        CPPUNIT_TEST(testAccessLog);
+        CPPUNIT_TEST(testCompactNodeSerDes);
+        CPPUNIT_TEST(testCompressedNodeSerDes);
+        CPPUNIT_TEST(testColumnarNodeSerDes);
+        CPPUNIT_TEST(testRelativeTimestamps);
+        CPPUNIT_TEST(testWideValues);
+        CPPUNIT_TEST(testStringDictionary);
+        CPPUNIT_TEST(testNodeChecksums);
+        CPPUNIT_TEST(testNodeDirectory);
+        CPPUNIT_TEST(testExtensionNodes);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -37,6 +53,22 @@ public:
     void testQueryWhenClosed();
     void testBuildEmpty();
     void testAddFindIntervals();
+    void testVisitorQueries();
+    void testFlatJarQueries();
+    void testScan();
+    void testNodeCacheTypes();
+    void testPinnedLevels();
+    void testWarmUp();
+    void testAccessLog();
+    void testCompactNodeSerDes();
+    void testCompressedNodeSerDes();
+    void testColumnarNodeSerDes();
+    void testRelativeTimestamps();
+    void testWideValues();
+    void testStringDictionary();
+    void testNodeChecksums();
+    void testNodeDirectory();
+    void testExtensionNodes();
 };
 
 #endif // _HISTORYFILETEST_HPP
@@ -0,0 +1,129 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <memory>
+#include <vector>
+#include <tuple>
+#include <algorithm>
+#include <boost/filesystem.hpp>
+
+#include <delorean/HistoryFileSource.hpp>
+#include <delorean/HistoryReplayIterator.hpp>
+#include <delorean/BasicTypes.hpp>
+#include <delorean/interval/AbstractInterval.hpp>
+#include <delorean/ex/TimestampOutOfRange.hpp>
+#include <utils.hpp>
+#include "HistoryReplayIteratorTest.hpp"
+
+namespace bfs = boost::filesystem;
+using namespace delo;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(HistoryReplayIteratorTest);
+
+namespace
+{
+
+typedef std::tuple<timestamp_t, timestamp_t, interval_key_t> IntervalTuple;
+
+void checkReplay(HistoryFileSource& source,
+                 const std::vector<AbstractInterval::SP>& intervals,
+                 timestamp_t begin, timestamp_t end)
+{
+    // expected: all intervals ending within the window, by end time
+    std::vector<IntervalTuple> expected;
+    for (const auto& interval : intervals) {
+        if (interval->getEnd() >= begin && interval->getEnd() < end) {
+            expected.emplace_back(interval->getEnd(), interval->getBegin(),
+                                  interval->getKey());
+        }
+    }
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<IntervalTuple> replayed;
+    HistoryReplayIterator it {source, begin, end};
+    timestamp_t lastEnd = begin;
+
+    while (auto interval = it.next()) {
+        // globally ordered by end time
+        CPPUNIT_ASSERT(interval->getEnd() >= lastEnd);
+        lastEnd = interval->getEnd();
+        replayed.emplace_back(interval->getEnd(), interval->getBegin(),
+                              interval->getKey());
+    }
+
+    // done for good
+    CPPUNIT_ASSERT(!it.next());
+
+    std::sort(replayed.begin(), replayed.end());
+    CPPUNIT_ASSERT(replayed == expected);
+}
+
+}
+
+void HistoryReplayIteratorTest::testInvalidWindow()
+{
+    std::vector<AbstractInterval::SP> intervals;
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./history.his",
+                             1024, 16, 15123456, intervals);
+
+    std::unique_ptr<HistoryFileSource> hfSource {new HistoryFileSource};
+    hfSource->open("./history.his");
+
+    try {
+        HistoryReplayIterator it {*hfSource, 15123455, 18000101};
+        CPPUNIT_FAIL("Built a replay iterator before the history begin");
+    } catch (const ex::TimestampOutOfRange& ex) {
+    }
+
+    try {
+        HistoryReplayIterator it {*hfSource, 18000101, 18000101};
+        CPPUNIT_FAIL("Built a replay iterator with an empty window");
+    } catch (const ex::TimestampOutOfRange& ex) {
+    }
+
+    hfSource->close();
+    bfs::remove("./history.his");
+}
+
+void HistoryReplayIteratorTest::testReplay()
+{
+    std::vector<AbstractInterval::SP> intervals;
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./history.his",
+                             1024, 16, 15123456, intervals);
+
+    std::unique_ptr<HistoryFileSource> hfSource {new HistoryFileSource};
+    hfSource->open("./history.his");
+
+    auto begin = hfSource->getBegin();
+    auto end = hfSource->getEnd();
+
+    // whole history, including intervals ending at the history end
+    checkReplay(*hfSource, intervals, begin, end + 1);
+
+    // windows of various sizes
+    checkReplay(*hfSource, intervals, 18000101, 18000102);
+    checkReplay(*hfSource, intervals, 18170304, 18170305);
+    checkReplay(*hfSource, intervals, 18500101, 19000101);
+    checkReplay(*hfSource, intervals, 19450101, 19450501);
+
+    for (timestamp_t ts = begin; ts < end; ts += 1234567) {
+        checkReplay(*hfSource, intervals, ts, ts + 2345678);
+    }
+
+    hfSource->close();
+    bfs::remove("./history.his");
+}
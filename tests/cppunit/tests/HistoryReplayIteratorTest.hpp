@@ -0,0 +1,36 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _HISTORYREPLAYITERATORTEST_HPP
+#define _HISTORYREPLAYITERATORTEST_HPP
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class HistoryReplayIteratorTest :
+    public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(HistoryReplayIteratorTest);
+        CPPUNIT_TEST(testInvalidWindow);
+        CPPUNIT_TEST(testReplay);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testInvalidWindow();
+    void testReplay();
+};
+
+#endif // _HISTORYREPLAYITERATORTEST_HPP
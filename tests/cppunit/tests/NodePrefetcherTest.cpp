@@ -0,0 +1,127 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <boost/filesystem.hpp>
+
+#include <delorean/HistoryFileSource.hpp>
+#include <delorean/HistoryCursor.hpp>
+#include <delorean/NodePrefetcher.hpp>
+#include <delorean/BasicTypes.hpp>
+#include <delorean/node/LruNodeCache.hpp>
+#include <delorean/interval/AbstractInterval.hpp>
+#include <delorean/interval/IntervalJar.hpp>
+#include <utils.hpp>
+#include "NodePrefetcherTest.hpp"
+
+namespace bfs = boost::filesystem;
+using namespace delo;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(NodePrefetcherTest);
+
+void NodePrefetcherTest::testBranches()
+{
+    std::vector<AbstractInterval::SP> intervals;
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./history.his",
+                             1024, 4, 15123456, intervals);
+
+    std::shared_ptr<AbstractNodeCache> cache {new LruNodeCache {4096}};
+    HistoryFileSource source;
+    source.open("./history.his", cache);
+
+    std::vector<timestamp_t> tss;
+    for (timestamp_t ts = 15123456; ts < 30000101; ts += 99991) {
+        tss.push_back(ts);
+    }
+
+    // out of range: ignored
+    tss.push_back(40000000);
+
+    // prefetched branches are all cached
+    NodePrefetcher prefetcher {source, 2};
+    prefetcher.prefetchBranches(tss);
+    prefetcher.wait();
+    auto readNodeCount = prefetcher.getReadNodeCount();
+    CPPUNIT_ASSERT(readNodeCount > 0);
+    cache->resetStats();
+
+    for (std::size_t x = 0; x < tss.size() - 1; ++x) {
+        IntervalJar jar;
+        source.findAll(tss[x], jar);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(0),
+                         cache->getStats().misses);
+
+    // cached nodes are not read again
+    prefetcher.prefetchBranches(tss);
+    prefetcher.prefetchNode(0);
+    prefetcher.wait();
+    CPPUNIT_ASSERT_EQUAL(readNodeCount, prefetcher.getReadNodeCount());
+
+    source.close();
+    bfs::remove("./history.his");
+}
+
+void NodePrefetcherTest::testCursor()
+{
+    std::vector<AbstractInterval::SP> intervals;
+    buildHistoryFromTextFile("../data/headsofstates.txt", "./history.his",
+                             1024, 4, 15123456, intervals);
+
+    HistoryFileSource refSource;
+    refSource.open("./history.his");
+
+    // scrubs forward, then backward, returning the number of misses
+    auto scrub = [&refSource] (bool prefetch) {
+        std::shared_ptr<AbstractNodeCache> cache {new LruNodeCache {4096}};
+        HistoryFileSource source;
+        source.open("./history.his", cache);
+
+        NodePrefetcher prefetcher {source};
+        HistoryCursor cursor {source};
+        if (prefetch) {
+            cursor.setPrefetcher(&prefetcher);
+        }
+
+        std::vector<timestamp_t> tss;
+        for (timestamp_t ts = 15123463; ts < 30000101; ts += 49999) {
+            tss.push_back(ts);
+        }
+        for (auto x = tss.size(); x > 0; --x) {
+            tss.push_back(tss[x - 1] - 7);
+        }
+
+        for (auto ts : tss) {
+            cursor.moveTo(ts);
+            prefetcher.wait();
+
+            IntervalJar jar;
+            refSource.findAll(ts, jar);
+            CPPUNIT_ASSERT_EQUAL(jar.size(), cursor.getIntervals().size());
+        }
+
+        return cache->getStats().misses;
+    };
+
+    CPPUNIT_ASSERT(scrub(true) < scrub(false));
+
+    refSource.close();
+    bfs::remove("./history.his");
+}
@@ -0,0 +1,36 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _NODEPREFETCHERTEST_HPP
+#define _NODEPREFETCHERTEST_HPP
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class NodePrefetcherTest :
+    public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(NodePrefetcherTest);
+        CPPUNIT_TEST(testBranches);
+        CPPUNIT_TEST(testCursor);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testBranches();
+    void testCursor();
+};
+
+#endif // _NODEPREFETCHERTEST_HPP
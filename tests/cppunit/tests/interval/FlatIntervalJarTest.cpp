@@ -0,0 +1,128 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <memory>
+#include <cstddef>
+#include <stdexcept>
+
+#include <delorean/interval/FlatIntervalJar.hpp>
+#include <delorean/interval/Int32Interval.hpp>
+#include <delorean/BasicTypes.hpp>
+#include "FlatIntervalJarTest.hpp"
+
+using namespace delo;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FlatIntervalJarTest);
+
+void FlatIntervalJarTest::testInsertFind()
+{
+    Int32Interval::SP interval1 {new Int32Interval(1534, 1608, 5)};
+    Int32Interval::SP interval2 {new Int32Interval(1602, 1777, 2)};
+    Int32Interval::SP interval3 {new Int32Interval(1540, 1867, 9)};
+    Int32Interval::SP interval4 {new Int32Interval(1541, 1914, 2)};
+
+    FlatIntervalJar jar;
+    CPPUNIT_ASSERT(jar.empty());
+
+    // insert
+    CPPUNIT_ASSERT(jar.insert(interval1));
+    CPPUNIT_ASSERT(jar.insert(interval2));
+    CPPUNIT_ASSERT(jar.insert(interval3));
+
+    // same key: not inserted
+    CPPUNIT_ASSERT(!jar.insert(interval4));
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(3), jar.size());
+
+    // sorted by key
+    auto it = jar.begin();
+    CPPUNIT_ASSERT_EQUAL(static_cast<interval_key_t>(2), it->first);
+    CPPUNIT_ASSERT(it->second == interval2);
+    ++it;
+    CPPUNIT_ASSERT_EQUAL(static_cast<interval_key_t>(5), it->first);
+    ++it;
+    CPPUNIT_ASSERT_EQUAL(static_cast<interval_key_t>(9), it->first);
+    ++it;
+    CPPUNIT_ASSERT(it == jar.end());
+
+    // find
+    CPPUNIT_ASSERT(jar.find(5)->second == interval1);
+    CPPUNIT_ASSERT(jar.find(9)->second == interval3);
+    CPPUNIT_ASSERT(jar.find(1) == jar.end());
+    CPPUNIT_ASSERT(jar.find(7) == jar.end());
+    CPPUNIT_ASSERT(jar.find(10) == jar.end());
+    CPPUNIT_ASSERT(jar.at(2) == interval2);
+    CPPUNIT_ASSERT_THROW(jar.at(3), std::out_of_range);
+}
+
+void FlatIntervalJarTest::testAppendNormalize()
+{
+    Int32Interval::SP interval1 {new Int32Interval(1534, 1608, 5)};
+    Int32Interval::SP interval2 {new Int32Interval(1602, 1777, 2)};
+    Int32Interval::SP interval3 {new Int32Interval(1540, 1867, 9)};
+    Int32Interval::SP interval4 {new Int32Interval(1541, 1914, 2)};
+    Int32Interval::SP interval5 {new Int32Interval(1541, 1914, 7)};
+
+    FlatIntervalJar jar;
+
+    // append to an empty jar
+    jar.append(interval1);
+    jar.append(interval3);
+    jar.append(interval2);
+    jar.normalize(0);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(3), jar.size());
+    CPPUNIT_ASSERT_EQUAL(static_cast<interval_key_t>(2), jar.begin()->first);
+    CPPUNIT_ASSERT_EQUAL(static_cast<interval_key_t>(9),
+                         (jar.end() - 1)->first);
+
+    // append to a non-empty jar: existing keys are kept
+    auto initSize = jar.size();
+    jar.append(interval5);
+    jar.append(interval4);
+    jar.normalize(initSize);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(4), jar.size());
+    CPPUNIT_ASSERT(jar.at(2) == interval2);
+    CPPUNIT_ASSERT(jar.at(5) == interval1);
+    CPPUNIT_ASSERT(jar.at(7) == interval5);
+    CPPUNIT_ASSERT(jar.at(9) == interval3);
+
+    interval_key_t lastKey = 0;
+    for (const auto& entry : jar) {
+        CPPUNIT_ASSERT(entry.first > lastKey);
+        CPPUNIT_ASSERT_EQUAL(entry.first, entry.second->getKey());
+        lastKey = entry.first;
+    }
+}
+
+void FlatIntervalJarTest::testClearKeepsCapacity()
+{
+    FlatIntervalJar jar;
+    jar.reserve(64);
+    auto capacity = jar.capacity();
+    CPPUNIT_ASSERT(capacity >= 64);
+
+    for (auto round = 0; round < 4; ++round) {
+        for (interval_key_t key = 0; key < 64; ++key) {
+            Int32Interval::SP interval {new Int32Interval(0, 10, 63 - key)};
+            jar.append(interval);
+        }
+        jar.normalize(0);
+        CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(64), jar.size());
+        jar.clear();
+        CPPUNIT_ASSERT(jar.empty());
+        CPPUNIT_ASSERT_EQUAL(capacity, jar.capacity());
+    }
+}
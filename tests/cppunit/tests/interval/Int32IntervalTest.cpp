@@ -132,7 +132,7 @@ void Int32IntervalTest::testFixedValue()
     // set native, get fixed
     uint32_t u = 0xfffffffe;
     interval->setValue(static_cast<int>(u));
-    CPPUNIT_ASSERT_EQUAL(u, interval->getFixedValue());
+    CPPUNIT_ASSERT_EQUAL(u, static_cast<uint32_t>(interval->getFixedValue()));
 }
 
 void Int32IntervalTest::testVariableDataSize()
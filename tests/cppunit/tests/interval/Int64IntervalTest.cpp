@@ -48,16 +48,12 @@ void Int64IntervalTest::testValueSerDes()
     int64_t value = -0x1234abcd9876fedcLL;
     interval->setValue(value);
 
-    // make sure the variable data size is 8
-    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(8), interval->getVariableDataSize());
+    // value is inline: no variable data
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(0), interval->getVariableDataSize());
 
-    // serialize value in buffer
-    std::uint8_t buf[8];
-    interval->serializeVariableData(buf);
-
-    // deserialize value in other interval
+    // copy fixed value to other interval
     Int64Interval::UP deserInterval {new Int64Interval(1939, 1945, 666)};
-    deserInterval->deserializeVariableData(buf);
+    deserInterval->setFixedValue(interval->getFixedValue());
 
     // make sure both values are the same
     CPPUNIT_ASSERT_EQUAL(value, deserInterval->getValue());
@@ -19,8 +19,12 @@
 #include <cstddef>
 #include <cstring>
 #include <string>
+#include <vector>
 
 #include <delorean/interval/StringInterval.hpp>
+#include <delorean/interval/DictionaryStringInterval.hpp>
+#include <delorean/interval/StringDictionary.hpp>
+#include <delorean/ex/IndexOutOfRange.hpp>
 #include <delorean/BasicTypes.hpp>
 #include "StringIntervalTest.hpp"
 
@@ -111,3 +115,74 @@ void StringIntervalTest::testVariableDataDeserialization()
     // check deserialized value
     CPPUNIT_ASSERT_EQUAL(value, interval->getValue());
 }
+
+void StringIntervalTest::testMemorySize()
+{
+    StringInterval::UP interval {new StringInterval(1, 2, 3)};
+
+    // at least the object itself
+    interval->setValue("hi");
+    auto shortSize = interval->getMemorySize();
+    CPPUNIT_ASSERT(shortSize >= sizeof(StringInterval));
+
+    // long strings are on the heap
+    std::string value(1000, 'x');
+    interval->setValue(value);
+    CPPUNIT_ASSERT(interval->getMemorySize() >= shortSize + value.size());
+}
+
+void StringIntervalTest::testDictionary()
+{
+    StringDictionary::SP dictionary {new StringDictionary};
+    DictionaryStringInterval::UP interval1 {
+        new DictionaryStringInterval(1, 2, 3, dictionary)
+    };
+    DictionaryStringInterval::UP interval2 {
+        new DictionaryStringInterval(2, 3, 3, dictionary)
+    };
+    DictionaryStringInterval::UP interval3 {
+        new DictionaryStringInterval(3, 4, 3, dictionary)
+    };
+
+    // same strings share their ID and storage
+    interval1->setValue("RUNNING");
+    interval2->setValue("WAIT_BLOCKED");
+    interval3->setValue("RUNNING");
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(2), dictionary->getSize());
+    CPPUNIT_ASSERT_EQUAL(interval1->getFixedValue(), interval3->getFixedValue());
+    CPPUNIT_ASSERT(interval1->getFixedValue() != interval2->getFixedValue());
+    CPPUNIT_ASSERT_EQUAL(&interval1->getValue(), &interval3->getValue());
+    CPPUNIT_ASSERT_EQUAL(std::string {"WAIT_BLOCKED"}, interval2->getValue());
+
+    // no variable data
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(0),
+                         interval1->getVariableDataSize());
+
+    // deserializing resolves the ID
+    DictionaryStringInterval::UP interval4 {
+        new DictionaryStringInterval(4, 5, 3, dictionary)
+    };
+    interval4->setFixedValue(interval2->getFixedValue());
+    interval4->deserializeVariableData(nullptr);
+    CPPUNIT_ASSERT_EQUAL(std::string {"WAIT_BLOCKED"}, interval4->getValue());
+
+    interval4->setFixedValue(17);
+    try {
+        interval4->deserializeVariableData(nullptr);
+        CPPUNIT_FAIL("Resolved an unknown string ID");
+    } catch (const ex::IndexOutOfRange& ex) {
+    }
+
+    // round trip
+    std::vector<std::uint8_t> buf;
+    dictionary->serialize(buf);
+    StringDictionary copy;
+    CPPUNIT_ASSERT(copy.deserialize(buf.data(), buf.size()));
+    CPPUNIT_ASSERT_EQUAL(dictionary->getSize(), copy.getSize());
+
+    interval_value_t id;
+    CPPUNIT_ASSERT(copy.findId("WAIT_BLOCKED", id));
+    CPPUNIT_ASSERT_EQUAL(interval2->getFixedValue(), id);
+    CPPUNIT_ASSERT(!copy.findId("ZOMBIE", id));
+    CPPUNIT_ASSERT(!copy.deserialize(buf.data(), buf.size() - 1));
+}
@@ -28,6 +28,8 @@ class StringIntervalTest :
         CPPUNIT_TEST(testVariableDataSize);
         CPPUNIT_TEST(testVariableDataSerialization);
         CPPUNIT_TEST(testVariableDataDeserialization);
+        CPPUNIT_TEST(testMemorySize);
+        CPPUNIT_TEST(testDictionary);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -35,6 +37,8 @@ public:
     void testVariableDataSize();
     void testVariableDataSerialization();
     void testVariableDataDeserialization();
+    void testMemorySize();
+    void testDictionary();
 };
 
 #endif // _STRINGINTERVALTEST_HPP
@@ -17,9 +17,17 @@
  */
 #include <memory>
 #include <cstddef>
+#include <string>
+#include <vector>
+#include <cstring>
 
 #include <delorean/node/AlignedNodeSerDes.hpp>
 #include <delorean/interval/StringInterval.hpp>
+#include <delorean/interval/Int32Interval.hpp>
+#include <delorean/interval/Uint32Interval.hpp>
+#include <delorean/interval/Int64Interval.hpp>
+#include <delorean/interval/Uint64Interval.hpp>
+#include <delorean/interval/DoubleInterval.hpp>
 #include <delorean/interval/IntervalJar.hpp>
 #include <delorean/BasicTypes.hpp>
 #include "AlignedNodeSerDesTest.hpp"
@@ -138,3 +146,342 @@ void AlignedNodeSerDesTest::testSerializeDeserialize()
         CPPUNIT_ASSERT_EQUAL(origInterval.getValue(), deserStrInterval.getValue());
     }
 }
+
+void AlignedNodeSerDesTest::testLargeKeys()
+{
+    AlignedNodeSerDes serdes;
+    Node node {1024, 2, 0, Node::ROOT_PARENT_SEQ_NUMBER(), 0, &serdes};
+
+    // small, boundary and large keys, with and without variable data
+    const interval_key_t keys[] = {
+        0xfffffe, 0xffffff, 0x1000000, 0xffffffff, 0x123456789abcdefULL,
+    };
+    std::vector<AbstractInterval::SP> jar;
+    timestamp_t ts = 0;
+
+    for (auto key : keys) {
+        Int32Interval::SP intInterval {new Int32Interval {ts, ts + 1, key}};
+        intInterval->setValue(-static_cast<std::int32_t>(ts));
+        jar.push_back(intInterval);
+
+        StringInterval::SP strInterval {new StringInterval {ts, ts + 2, key}};
+        strInterval->setValue("key " + std::to_string(key));
+        jar.push_back(strInterval);
+        ts += 2;
+    }
+
+    for (const auto& interval : jar) {
+        node.addInterval(interval);
+    }
+
+    // only intervals with large keys are larger
+    CPPUNIT_ASSERT_EQUAL(serdes.getIntervalSize(*jar[0]) + 16,
+                         serdes.getIntervalSize(*jar[2]));
+    CPPUNIT_ASSERT_EQUAL(serdes.getIntervalSize(*jar[2]),
+                         serdes.getIntervalSize(*jar[8]));
+
+    std::vector<std::uint8_t> buf(1024);
+    serdes.serializeNode(node, buf.data());
+    auto deserNode = serdes.deserializeNode(buf.data(), 1024, 2);
+    const auto& intervals = deserNode->getIntervals();
+    CPPUNIT_ASSERT_EQUAL(jar.size(), intervals.size());
+
+    for (std::size_t x = 0; x < jar.size(); x += 2) {
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getKey(), intervals[x]->getKey());
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getEnd(), intervals[x]->getEnd());
+        CPPUNIT_ASSERT_EQUAL(
+            static_cast<const Int32Interval&>(*jar[x]).getValue(),
+            static_cast<const Int32Interval&>(*intervals[x]).getValue());
+        CPPUNIT_ASSERT_EQUAL(jar[x + 1]->getKey(), intervals[x + 1]->getKey());
+        CPPUNIT_ASSERT_EQUAL(
+            static_cast<const StringInterval&>(*jar[x + 1]).getValue(),
+            static_cast<const StringInterval&>(*intervals[x + 1]).getValue());
+    }
+
+    // node without extended intervals, its key patched to KEY_EXTENDED
+    Node smallNode {1024, 2, 0, Node::ROOT_PARENT_SEQ_NUMBER(), 0, &serdes};
+    Int32Interval::SP interval {new Int32Interval {0, 1, 0xfffffe}};
+    interval->setValue(-17);
+    smallNode.addInterval(interval);
+    serdes.serializeNode(smallNode, buf.data());
+
+    // node header (32 bytes), no children, then begin and end
+    auto keyPtr = &buf[32 + 16];
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint8_t>(0xfe), keyPtr[0]);
+    keyPtr[0] = 0xff;
+
+    // read as is, like before extended intervals existed
+    deserNode = serdes.deserializeNode(buf.data(), 1024, 2);
+    const auto& deserInterval = *deserNode->getIntervals().front();
+    CPPUNIT_ASSERT_EQUAL(static_cast<interval_key_t>(0xffffff),
+                         deserInterval.getKey());
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::int32_t>(-17),
+        static_cast<const Int32Interval&>(deserInterval).getValue());
+}
+
+void AlignedNodeSerDesTest::testLargeValues()
+{
+    AlignedNodeSerDes serdes;
+    Node node {1024, 2, 0, Node::ROOT_PARENT_SEQ_NUMBER(), 0, &serdes};
+
+    Uint32Interval::SP uint32Interval {new Uint32Interval {0, 1, 1}};
+    uint32Interval->setValue(0xffffffff);
+    Int64Interval::SP smallInt64Interval {new Int64Interval {0, 2, 2}};
+    smallInt64Interval->setValue(-5);
+    Int64Interval::SP largeInt64Interval {new Int64Interval {0, 3, 3}};
+    largeInt64Interval->setValue(-0x1234abcd9876fedcLL);
+    DoubleInterval::SP doubleInterval {new DoubleInterval {0, 4, 4}};
+    doubleInterval->setValue(-2.718281828);
+
+    std::vector<AbstractInterval::SP> jar {
+        uint32Interval, smallInt64Interval, largeInt64Interval, doubleInterval
+    };
+
+    for (const auto& interval : jar) {
+        node.addInterval(interval);
+    }
+
+    // 32-bit values and small 64-bit values are inline
+    CPPUNIT_ASSERT_EQUAL(serdes.getIntervalSize(*uint32Interval),
+                         serdes.getIntervalSize(*smallInt64Interval));
+    CPPUNIT_ASSERT_EQUAL(serdes.getIntervalSize(*uint32Interval) + 16,
+                         serdes.getIntervalSize(*largeInt64Interval));
+
+    std::vector<std::uint8_t> buf(1024);
+    serdes.serializeNode(node, buf.data());
+    auto deserNode = serdes.deserializeNode(buf.data(), 1024, 2);
+    const auto& intervals = deserNode->getIntervals();
+    CPPUNIT_ASSERT_EQUAL(jar.size(), intervals.size());
+
+    for (std::size_t x = 0; x < jar.size(); ++x) {
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getKey(), intervals[x]->getKey());
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getFixedValue(),
+                             intervals[x]->getFixedValue());
+    }
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint32_t>(0xffffffff),
+                         static_cast<const Uint32Interval&>(*intervals[0]).getValue());
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::int64_t>(-5),
+                         static_cast<const Int64Interval&>(*intervals[1]).getValue());
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::int64_t>(-0x1234abcd9876fedcLL),
+                         static_cast<const Int64Interval&>(*intervals[2]).getValue());
+    CPPUNIT_ASSERT_EQUAL(-2.718281828,
+                         static_cast<const DoubleInterval&>(*intervals[3]).getValue());
+}
+
+void AlignedNodeSerDesTest::testLegacyValues()
+{
+    AlignedNodeSerDes serdes;
+
+    // node written before inline values: header without the flag
+    std::vector<std::uint8_t> buf(1024);
+    const std::uint64_t nodeFields[] = {10, 40};
+    const std::uint32_t nodeFlagsFields[] = {1, 0, 0xffffffff, 3};
+    auto ptr = buf.data();
+    std::memcpy(ptr, nodeFields, sizeof(nodeFields));
+    ptr += sizeof(nodeFields);
+    std::memcpy(ptr, nodeFlagsFields, sizeof(nodeFlagsFields));
+    ptr += sizeof(nodeFlagsFields);
+
+    /* Int32 (type 0) with an inline value, then Int64 (type 5) and
+     * Uint64 (type 6) with the offset of their variable data.
+     */
+    const std::int64_t int64Value = -0x1234abcd9876fedcLL;
+    const std::uint64_t uint64Value = 0xfedcba9876543210ULL;
+    std::memcpy(&buf[1024 - 8], &int64Value, sizeof(int64Value));
+    std::memcpy(&buf[1024 - 16], &uint64Value, sizeof(uint64Value));
+
+    const std::uint32_t typeKeyValues[][2] = {
+        {(0u << 24) | 1, static_cast<std::uint32_t>(-17)},
+        {(5u << 24) | 2, 8},
+        {(6u << 24) | 3, 16},
+    };
+
+    for (std::size_t x = 0; x < 3; ++x) {
+        const std::uint64_t timestamps[] = {10 + x, 20 + x};
+        std::memcpy(ptr, timestamps, sizeof(timestamps));
+        ptr += sizeof(timestamps);
+        std::memcpy(ptr, typeKeyValues[x], sizeof(typeKeyValues[x]));
+        ptr += sizeof(typeKeyValues[x]);
+    }
+
+    auto node = serdes.deserializeNode(buf.data(), 1024, 2);
+    const auto& intervals = node->getIntervals();
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(3), intervals.size());
+    CPPUNIT_ASSERT_EQUAL(static_cast<timestamp_t>(40), node->getEnd());
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::int32_t>(-17),
+        static_cast<const Int32Interval&>(*intervals[0]).getValue());
+    CPPUNIT_ASSERT_EQUAL(int64Value,
+        static_cast<const Int64Interval&>(*intervals[1]).getValue());
+    CPPUNIT_ASSERT_EQUAL(uint64Value,
+        static_cast<const Uint64Interval&>(*intervals[2]).getValue());
+    CPPUNIT_ASSERT_EQUAL(static_cast<interval_key_t>(3),
+                         intervals[2]->getKey());
+
+    // serializing it again uses inline values
+    serdes.serializeNode(*node, buf.data());
+    auto newNode = serdes.deserializeNode(buf.data(), 1024, 2);
+    CPPUNIT_ASSERT_EQUAL(int64Value,
+        static_cast<const Int64Interval&>(*newNode->getIntervals()[1]).getValue());
+    CPPUNIT_ASSERT_EQUAL(uint64Value,
+        static_cast<const Uint64Interval&>(*newNode->getIntervals()[2]).getValue());
+}
+
+void AlignedNodeSerDesTest::testWideValues()
+{
+    AlignedNodeSerDes narrowSerdes;
+
+    for (int relative = 0; relative < 2; ++relative) {
+        AlignedNodeSerDes serdes {relative == 1, true};
+        Node node {1024, 2, 0, Node::ROOT_PARENT_SEQ_NUMBER(), 0, &serdes};
+
+        Int32Interval::SP int32Interval {new Int32Interval {0, 1, 1}};
+        int32Interval->setValue(-17);
+        Int64Interval::SP int64Interval {new Int64Interval {0, 2, 2}};
+        int64Interval->setValue(-0x1234abcd9876fedcLL);
+        DoubleInterval::SP doubleInterval {new DoubleInterval {0, 3, 3}};
+        doubleInterval->setValue(-2.718281828);
+        DoubleInterval::SP largeKeyInterval {
+            new DoubleInterval {0, 4, 0x123456789abcdefULL}
+        };
+        largeKeyInterval->setValue(6.02214076e23);
+        StringInterval::SP strInterval {
+            new StringInterval {0, 5, 0x1000000}
+        };
+        strInterval->setValue("wide");
+
+        std::vector<AbstractInterval::SP> jar {
+            int32Interval, int64Interval, doubleInterval, largeKeyInterval,
+            strInterval
+        };
+
+        for (const auto& interval : jar) {
+            node.addInterval(interval);
+        }
+
+        // fixed values are always inline: only large keys are extended
+        CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(32),
+                             serdes.getIntervalSize(*doubleInterval));
+        CPPUNIT_ASSERT_EQUAL(serdes.getIntervalSize(*int32Interval),
+                             serdes.getIntervalSize(*int64Interval));
+        CPPUNIT_ASSERT_EQUAL(serdes.getIntervalSize(*doubleInterval) + 8,
+                             serdes.getIntervalSize(*largeKeyInterval));
+        CPPUNIT_ASSERT(serdes.getIntervalSize(*doubleInterval) <
+                       narrowSerdes.getIntervalSize(*doubleInterval));
+
+        std::vector<std::uint8_t> buf(1024);
+        serdes.serializeNode(node, buf.data());
+        auto deserNode = serdes.deserializeNode(buf.data(), 1024, 2);
+        const auto& intervals = deserNode->getIntervals();
+        CPPUNIT_ASSERT_EQUAL(jar.size(), intervals.size());
+
+        for (std::size_t x = 0; x < jar.size(); ++x) {
+            CPPUNIT_ASSERT_EQUAL(jar[x]->getKey(), intervals[x]->getKey());
+            CPPUNIT_ASSERT_EQUAL(jar[x]->getEnd(), intervals[x]->getEnd());
+        }
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<std::int32_t>(-17),
+            static_cast<const Int32Interval&>(*intervals[0]).getValue());
+        CPPUNIT_ASSERT_EQUAL(static_cast<std::int64_t>(-0x1234abcd9876fedcLL),
+            static_cast<const Int64Interval&>(*intervals[1]).getValue());
+        CPPUNIT_ASSERT_EQUAL(-2.718281828,
+            static_cast<const DoubleInterval&>(*intervals[2]).getValue());
+        CPPUNIT_ASSERT_EQUAL(6.02214076e23,
+            static_cast<const DoubleInterval&>(*intervals[3]).getValue());
+        CPPUNIT_ASSERT_EQUAL(std::string {"wide"},
+            static_cast<const StringInterval&>(*intervals[4]).getValue());
+    }
+}
+
+void AlignedNodeSerDesTest::testRelativeTimestamps()
+{
+    // nanosecond timestamps, far from 0
+    const timestamp_t begin = 1500000000000000000LL;
+    AlignedNodeSerDes serdes;
+    AlignedNodeSerDes relSerdes {true};
+    Node node {4096, 2, 0, Node::ROOT_PARENT_SEQ_NUMBER(), begin, &serdes};
+    Node relNode {4096, 2, 0, Node::ROOT_PARENT_SEQ_NUMBER(), begin,
+                  &relSerdes};
+    std::vector<AbstractInterval::SP> jar;
+
+    for (timestamp_t ts = begin; ; ts += 1000) {
+        AbstractInterval::SP interval;
+
+        if (jar.size() % 5 == 0) {
+            StringInterval::SP strInterval {new StringInterval {ts, ts + 1000, 1}};
+            strInterval->setValue("state");
+            interval = strInterval;
+        } else {
+            Int32Interval::SP intInterval {new Int32Interval {ts, ts + 1000, 2}};
+            intInterval->setValue(static_cast<std::int32_t>(jar.size()));
+            interval = intInterval;
+        }
+
+        if (!relNode.intervalFits(*interval)) {
+            break;
+        }
+
+        if (node.intervalFits(*interval)) {
+            node.addInterval(interval);
+        }
+
+        relNode.addInterval(interval);
+        jar.push_back(interval);
+    }
+
+    // interval headers are a third smaller
+    CPPUNIT_ASSERT(jar.size() > node.getIntervalCount() * 5 / 4);
+    CPPUNIT_ASSERT_EQUAL(serdes.getIntervalSize(node, *jar[1]) - 8,
+                         relSerdes.getIntervalSize(relNode, *jar[1]));
+
+    std::vector<std::uint8_t> buf(4096);
+    relSerdes.serializeNode(relNode, buf.data());
+    auto deserNode = relSerdes.deserializeNode(buf.data(), 4096, 2);
+    const auto& intervals = deserNode->getIntervals();
+    CPPUNIT_ASSERT_EQUAL(jar.size(), intervals.size());
+
+    for (std::size_t x = 0; x < jar.size(); ++x) {
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getBegin(), intervals[x]->getBegin());
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getEnd(), intervals[x]->getEnd());
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getType(), intervals[x]->getType());
+    }
+
+    CPPUNIT_ASSERT_EQUAL(std::string {"state"},
+                         static_cast<const StringInterval&>(*intervals[0]).getValue());
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::int32_t>(3),
+                         static_cast<const Int32Interval&>(*intervals[3]).getValue());
+
+    // a node spanning more than 2^32 falls back to absolute timestamps
+    Node wideNode {1024, 2, 0, Node::ROOT_PARENT_SEQ_NUMBER(), begin,
+                   &relSerdes};
+    std::vector<AbstractInterval::SP> wideJar;
+
+    for (timestamp_t ts = begin; ts < begin + 5; ++ts) {
+        Int32Interval::SP interval {new Int32Interval {ts, ts + 1, 3}};
+        interval->setValue(-7);
+        wideJar.push_back(interval);
+        wideNode.addInterval(interval);
+    }
+
+    Int32Interval::SP farInterval {new Int32Interval {begin + 6,
+                                                      begin + (1LL << 33), 4}};
+    farInterval->setValue(-8);
+    CPPUNIT_ASSERT_EQUAL(serdes.getIntervalSize(*farInterval) + 5 * 8,
+                         relSerdes.getIntervalSize(wideNode, *farInterval));
+    wideJar.push_back(farInterval);
+    wideNode.addInterval(farInterval);
+    CPPUNIT_ASSERT_EQUAL(serdes.getIntervalSize(*farInterval),
+                         relSerdes.getIntervalSize(wideNode, *farInterval));
+
+    relSerdes.serializeNode(wideNode, buf.data());
+    deserNode = relSerdes.deserializeNode(buf.data(), 1024, 2);
+    CPPUNIT_ASSERT_EQUAL(wideJar.size(), deserNode->getIntervalCount());
+
+    for (std::size_t x = 0; x < wideJar.size(); ++x) {
+        const auto& interval = *deserNode->getIntervals()[x];
+        CPPUNIT_ASSERT_EQUAL(wideJar[x]->getBegin(), interval.getBegin());
+        CPPUNIT_ASSERT_EQUAL(wideJar[x]->getEnd(), interval.getEnd());
+        CPPUNIT_ASSERT_EQUAL(wideJar[x]->getFixedValue(),
+                             interval.getFixedValue());
+    }
+}
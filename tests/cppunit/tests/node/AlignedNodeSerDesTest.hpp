@@ -25,10 +25,20 @@ class AlignedNodeSerDesTest :
 {
     CPPUNIT_TEST_SUITE(AlignedNodeSerDesTest);
         CPPUNIT_TEST(testSerializeDeserialize);
+        CPPUNIT_TEST(testLargeKeys);
+        CPPUNIT_TEST(testLargeValues);
+        CPPUNIT_TEST(testLegacyValues);
+        CPPUNIT_TEST(testWideValues);
+        CPPUNIT_TEST(testRelativeTimestamps);
     CPPUNIT_TEST_SUITE_END();
 
 public:
     void testSerializeDeserialize();
+    void testLargeKeys();
+    void testLargeValues();
+    void testLegacyValues();
+    void testWideValues();
+    void testRelativeTimestamps();
 };
 
 #endif // _ALIGNEDNODESERDESTEST_HPP
@@ -0,0 +1,128 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <memory>
+#include <cstddef>
+#include <random>
+
+#include <delorean/node/Node.hpp>
+#include <delorean/node/ArcNodeCache.hpp>
+#include <delorean/BasicTypes.hpp>
+#include <utils.hpp>
+#include "ArcNodeCacheTest.hpp"
+
+using namespace delo;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ArcNodeCacheTest);
+
+void ArcNodeCacheTest::testConstructorAndAttributes()
+{
+    // test creation
+    ArcNodeCache cache {10};
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(10), cache.getSize());
+}
+
+void ArcNodeCacheTest::testGetNode()
+{
+    ArcNodeCache cache {32};
+    NodeOwner owner {cache};
+
+    std::mt19937 gen {4321};
+    std::uniform_int_distribution<node_seq_t> smallDist {4990, 5020};
+    std::uniform_int_distribution<node_seq_t> largeDist {4000, 6000};
+
+    for (int x = 0; x < 20000; ++x) {
+        auto seq = (x % 3 == 0) ? largeDist(gen) : smallDist(gen);
+        auto wasCached = cache.nodeIsCached(seq);
+        auto calls = owner.getCalls();
+        auto node = cache.getNode(seq);
+
+        // cached nodes don't need the owner
+        CPPUNIT_ASSERT_EQUAL(wasCached, calls == owner.getCalls());
+        CPPUNIT_ASSERT_EQUAL(owner.getNode(seq), node);
+
+        // non existing nodes are never cached
+        if (!node) {
+            CPPUNIT_ASSERT(!cache.nodeIsCached(seq));
+        }
+    }
+
+    // never more cached nodes than the cache size
+    std::size_t cachedCount = 0;
+    for (node_seq_t seq = 4000; seq <= 6000; ++seq) {
+        if (cache.nodeIsCached(seq)) {
+            cachedCount++;
+        }
+    }
+    CPPUNIT_ASSERT(cachedCount <= cache.getSize());
+
+    cache.invalidate();
+    for (node_seq_t seq = 4000; seq <= 6000; ++seq) {
+        CPPUNIT_ASSERT(!cache.nodeIsCached(seq));
+    }
+}
+
+void ArcNodeCacheTest::testScanResistance()
+{
+    ArcNodeCache cache {64};
+    NodeOwner owner {cache};
+
+    // hot nodes: accessed twice
+    accessNodes(cache, 0, 8);
+    accessNodes(cache, 0, 8);
+    for (node_seq_t seq = 0; seq < 8; ++seq) {
+        CPPUNIT_ASSERT(cache.nodeIsCached(seq));
+    }
+
+    // long scan
+    accessNodes(cache, 1000, 3000);
+
+    // hot nodes are still cached
+    for (node_seq_t seq = 0; seq < 8; ++seq) {
+        CPPUNIT_ASSERT(cache.nodeIsCached(seq));
+    }
+}
+
+void ArcNodeCacheTest::testPeekNode()
+{
+    ArcNodeCache cache {64};
+    NodeOwner owner {cache};
+
+    // accessed once, then probed many times
+    accessNodes(cache, 0, 8);
+    auto stats = cache.getStats();
+    auto calls = owner.getCalls();
+
+    for (int x = 0; x < 4; ++x) {
+        for (node_seq_t seq = 0; seq < 8; ++seq) {
+            CPPUNIT_ASSERT_EQUAL(owner.getNode(seq), cache.peekNode(seq));
+        }
+    }
+
+    CPPUNIT_ASSERT(!cache.peekNode(8));
+    CPPUNIT_ASSERT_EQUAL(calls, owner.getCalls());
+    CPPUNIT_ASSERT_EQUAL(stats.hits, cache.getStats().hits);
+    CPPUNIT_ASSERT_EQUAL(stats.misses, cache.getStats().misses);
+
+    // probing isn't an access: a long scan still evicts them
+    accessNodes(cache, 1000, 3000);
+
+    for (node_seq_t seq = 0; seq < 8; ++seq) {
+        CPPUNIT_ASSERT(!cache.nodeIsCached(seq));
+    }
+}
@@ -0,0 +1,172 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <delorean/node/ColumnarNodeSerDes.hpp>
+#include <delorean/interval/StringInterval.hpp>
+#include <delorean/interval/Int32Interval.hpp>
+#include <delorean/interval/Int64Interval.hpp>
+#include <delorean/interval/FlatIntervalJar.hpp>
+#include <delorean/BasicTypes.hpp>
+#include "ColumnarNodeSerDesTest.hpp"
+
+using namespace delo;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ColumnarNodeSerDesTest);
+
+namespace
+{
+
+void fillNode(Node& node, std::vector<AbstractInterval::SP>& jar)
+{
+    timestamp_t ts = -500;
+
+    for (int x = 0; x < 30; ++x) {
+        interval_key_t key = x % 3;
+
+        if (x % 7 == 0) {
+            key = 0x123456789abcdefULL + x;
+        }
+
+        if (x % 2 == 0) {
+            StringInterval::SP interval {new StringInterval {ts, ts + 40, key}};
+            interval->setValue("state " + std::to_string(x));
+            jar.push_back(interval);
+        } else if (x % 5 == 0) {
+            Int64Interval::SP interval {new Int64Interval {ts - 20, ts + 40, key}};
+            interval->setValue(-0x123456789LL * x);
+            jar.push_back(interval);
+        } else {
+            Int32Interval::SP interval {new Int32Interval {ts + 5, ts + 40, key}};
+            interval->setValue(-x);
+            jar.push_back(interval);
+        }
+
+        node.addInterval(jar.back());
+        ts += 10;
+    }
+}
+
+}
+
+void ColumnarNodeSerDesTest::testSerializeDeserialize()
+{
+    ColumnarNodeSerDes serdes;
+    Node node {4096, 4, 5, Node::ROOT_PARENT_SEQ_NUMBER(), -500, &serdes};
+    std::vector<AbstractInterval::SP> jar;
+    fillNode(node, jar);
+    node.close(1000);
+    node.addChild(-500, 8);
+    node.addChild(-300, 17);
+    node.addChild(152, 3);
+
+    std::vector<std::uint8_t> buf(4096);
+    serdes.serializeNode(node, buf.data());
+    auto deserNode = serdes.deserializeNode(buf.data(), 4096, 4);
+
+    // verify node attributes
+    CPPUNIT_ASSERT_EQUAL(static_cast<timestamp_t>(-500), deserNode->getBegin());
+    CPPUNIT_ASSERT_EQUAL(static_cast<timestamp_t>(1000), deserNode->getEnd());
+    CPPUNIT_ASSERT_EQUAL(static_cast<node_seq_t>(5), deserNode->getSeqNumber());
+    CPPUNIT_ASSERT_EQUAL(Node::ROOT_PARENT_SEQ_NUMBER(), deserNode->getParentSeqNumber());
+    CPPUNIT_ASSERT(deserNode->isClosed());
+
+    // verify children
+    const auto& children = deserNode->getChildren();
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(3), children.size());
+    CPPUNIT_ASSERT_EQUAL(static_cast<timestamp_t>(-300), children[1].getBegin());
+    CPPUNIT_ASSERT_EQUAL(static_cast<node_seq_t>(17), children[1].getSeqNumber());
+    CPPUNIT_ASSERT_EQUAL(static_cast<timestamp_t>(152), children[2].getBegin());
+    CPPUNIT_ASSERT_EQUAL(static_cast<node_seq_t>(3), children[2].getSeqNumber());
+
+    // verify intervals
+    const auto& intervals = deserNode->getIntervals();
+    CPPUNIT_ASSERT_EQUAL(jar.size(), intervals.size());
+
+    for (std::size_t x = 0; x < jar.size(); ++x) {
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getType(), intervals[x]->getType());
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getBegin(), intervals[x]->getBegin());
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getEnd(), intervals[x]->getEnd());
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getKey(), intervals[x]->getKey());
+
+        if (jar[x]->getVariableDataSize() > 0) {
+            CPPUNIT_ASSERT_EQUAL(
+                static_cast<const StringInterval&>(*jar[x]).getValue(),
+                static_cast<const StringInterval&>(*intervals[x]).getValue());
+        } else {
+            CPPUNIT_ASSERT_EQUAL(jar[x]->getFixedValue(),
+                                 intervals[x]->getFixedValue());
+        }
+    }
+}
+
+void ColumnarNodeSerDesTest::testColumns()
+{
+    ColumnarNodeSerDes serdes;
+    Node node {4096, 4, 0, Node::ROOT_PARENT_SEQ_NUMBER(), -500, &serdes};
+    std::vector<AbstractInterval::SP> jar;
+    fillNode(node, jar);
+    node.close(1000);
+
+    std::vector<std::uint8_t> buf(4096);
+    serdes.serializeNode(node, buf.data());
+
+    auto columns = ColumnarNodeSerDes::getColumns(buf.data());
+    CPPUNIT_ASSERT_EQUAL(jar.size(), columns.getIntervalCount());
+
+    for (std::size_t x = 0; x < jar.size(); ++x) {
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getBegin(), columns.getBegin(x));
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getEnd(), columns.getEnd(x));
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getKey(), columns.getKey(x));
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getType(), columns.getType(x));
+    }
+
+    // same answers as the node itself
+    for (timestamp_t ts = -520; ts < 1000; ts += 3) {
+        FlatIntervalJar nodeJar;
+        std::vector<std::size_t> indexes;
+        auto found = node.findAll(ts, nodeJar);
+        CPPUNIT_ASSERT_EQUAL(found, ColumnarNodeSerDes::findAll(columns, ts,
+                                                                indexes));
+        CPPUNIT_ASSERT_EQUAL(nodeJar.size(), indexes.size());
+
+        auto it = nodeJar.begin();
+
+        for (auto index : indexes) {
+            CPPUNIT_ASSERT(jar[index]->intersects(ts));
+            CPPUNIT_ASSERT(it->second == jar[index]);
+            ++it;
+        }
+
+        for (interval_key_t key = 0; key < 3; ++key) {
+            auto interval = node.findOne(ts, key);
+            std::size_t index;
+            CPPUNIT_ASSERT_EQUAL(static_cast<bool>(interval),
+                                 ColumnarNodeSerDes::findOne(columns, ts, key,
+                                                             index));
+
+            if (interval) {
+                CPPUNIT_ASSERT(jar[index] == interval);
+            }
+        }
+    }
+}
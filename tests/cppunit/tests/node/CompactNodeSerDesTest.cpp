@@ -0,0 +1,172 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <delorean/node/CompactNodeSerDes.hpp>
+#include <delorean/node/AlignedNodeSerDes.hpp>
+#include <delorean/interval/StringInterval.hpp>
+#include <delorean/interval/Int32Interval.hpp>
+#include <delorean/interval/Int64Interval.hpp>
+#include <delorean/BasicTypes.hpp>
+#include "CompactNodeSerDesTest.hpp"
+
+using namespace delo;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CompactNodeSerDesTest);
+
+void CompactNodeSerDesTest::testSerializeDeserialize()
+{
+    std::unique_ptr<CompactNodeSerDes> serdes {new CompactNodeSerDes};
+
+    // create node
+    Node::UP node {new Node {
+        1024,
+        4,
+        5,
+        Node::ROOT_PARENT_SEQ_NUMBER(),
+        -3000,
+        serdes.get()
+    }};
+
+    // mixed intervals: strings, negative and large values, large keys
+    std::vector<AbstractInterval::SP> jar;
+
+    StringInterval::SP strInterval1 {new StringInterval {-3000, -2000, 1}};
+    strInterval1->setValue("Old Kingdom");
+    jar.push_back(strInterval1);
+
+    Int32Interval::SP intInterval1 {new Int32Interval {-2500, -1300, 0xffffff}};
+    intInterval1->setValue(-17);
+    jar.push_back(intInterval1);
+
+    Int32Interval::SP intInterval2 {new Int32Interval {-1299, -1299, 3}};
+    intInterval2->setValue(2000000000);
+    jar.push_back(intInterval2);
+
+    Int64Interval::SP int64Interval {new Int64Interval {-1200, 390, 4}};
+    int64Interval->setValue(-1234567890123);
+    jar.push_back(int64Interval);
+
+    StringInterval::SP strInterval2 {new StringInterval {391, 1914, 0xfffffffff0ULL}};
+    strInterval2->setValue("");
+    jar.push_back(strInterval2);
+
+    for (const auto& interval : jar) {
+        CPPUNIT_ASSERT(node->intervalFits(*interval));
+        node->addInterval(interval);
+    }
+    node->close(1939);
+
+    // add some children
+    node->addChild(-3000, 8);
+    node->addChild(-2700, 17);
+    node->addChild(152, 123456);
+
+    // serialize, then deserialize node
+    std::vector<std::uint8_t> buf(1024);
+    serdes->serializeNode(*node, buf.data());
+    auto deserNode = serdes->deserializeNode(buf.data(), 1024, 4);
+
+    // verify node attributes
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(1024), deserNode->getSize());
+    CPPUNIT_ASSERT_EQUAL(static_cast<timestamp_t>(-3000), deserNode->getBegin());
+    CPPUNIT_ASSERT_EQUAL(static_cast<timestamp_t>(1939), deserNode->getEnd());
+    CPPUNIT_ASSERT_EQUAL(static_cast<node_seq_t>(5), deserNode->getSeqNumber());
+    CPPUNIT_ASSERT_EQUAL(Node::ROOT_PARENT_SEQ_NUMBER(), deserNode->getParentSeqNumber());
+    CPPUNIT_ASSERT(deserNode->isClosed());
+
+    // verify children
+    auto& children = deserNode->getChildren();
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(3), children.size());
+    CPPUNIT_ASSERT_EQUAL(static_cast<timestamp_t>(-3000), children[0].getBegin());
+    CPPUNIT_ASSERT_EQUAL(static_cast<node_seq_t>(8), children[0].getSeqNumber());
+    CPPUNIT_ASSERT_EQUAL(static_cast<timestamp_t>(-2700), children[1].getBegin());
+    CPPUNIT_ASSERT_EQUAL(static_cast<node_seq_t>(17), children[1].getSeqNumber());
+    CPPUNIT_ASSERT_EQUAL(static_cast<timestamp_t>(152), children[2].getBegin());
+    CPPUNIT_ASSERT_EQUAL(static_cast<node_seq_t>(123456), children[2].getSeqNumber());
+
+    // verify intervals
+    auto& intervals = deserNode->getIntervals();
+    CPPUNIT_ASSERT_EQUAL(jar.size(), intervals.size());
+
+    for (std::size_t x = 0; x < jar.size(); ++x) {
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getType(), intervals[x]->getType());
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getBegin(), intervals[x]->getBegin());
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getEnd(), intervals[x]->getEnd());
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getKey(), intervals[x]->getKey());
+    }
+
+    CPPUNIT_ASSERT_EQUAL(std::string {"Old Kingdom"},
+                         static_cast<const StringInterval&>(*intervals[0]).getValue());
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::int32_t>(-17),
+                         static_cast<const Int32Interval&>(*intervals[1]).getValue());
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::int32_t>(2000000000),
+                         static_cast<const Int32Interval&>(*intervals[2]).getValue());
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::int64_t>(-1234567890123),
+                         static_cast<const Int64Interval&>(*intervals[3]).getValue());
+    CPPUNIT_ASSERT_EQUAL(std::string {},
+                         static_cast<const StringInterval&>(*intervals[4]).getValue());
+}
+
+void CompactNodeSerDesTest::testDensity()
+{
+    CompactNodeSerDes compactSerdes;
+    AlignedNodeSerDes alignedSerdes;
+
+    // fills a node with small integer states, returning the count
+    auto fill = [] (const AbstractNodeSerDes& serdes) {
+        Node node {4096, 8, 0, Node::ROOT_PARENT_SEQ_NUMBER(), 1000000,
+                   &serdes};
+        std::size_t count = 0;
+        timestamp_t ts = 1000000;
+
+        while (true) {
+            Int32Interval::SP interval {
+                new Int32Interval {ts, ts + 37, static_cast<interval_key_t>(count % 200)}
+            };
+            interval->setValue(static_cast<std::int32_t>(count % 10));
+
+            if (!node.intervalFits(*interval)) {
+                break;
+            }
+
+            node.addInterval(interval);
+            ts += 3;
+            count++;
+        }
+
+        // serialized node must fit with its maximum number of children
+        for (node_seq_t seq = 0; seq < 8; ++seq) {
+            node.addChild(1000000 + seq * 1000000000000LL, seq + 100000);
+        }
+
+        std::vector<std::uint8_t> buf(4096);
+        serdes.serializeNode(node, buf.data());
+        auto deserNode = serdes.deserializeNode(buf.data(), 4096, 8);
+        CPPUNIT_ASSERT_EQUAL(count, deserNode->getIntervalCount());
+        CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(8),
+                             deserNode->getChildrenCount());
+
+        return count;
+    };
+
+    CPPUNIT_ASSERT(fill(compactSerdes) > 3 * fill(alignedSerdes));
+}
@@ -0,0 +1,210 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <memory>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <delorean/node/CompressedNodeSerDes.hpp>
+#include <delorean/node/LzCodec.hpp>
+#include <delorean/interval/StringInterval.hpp>
+#include <delorean/BasicTypes.hpp>
+#include "CompressedNodeSerDesTest.hpp"
+
+using namespace delo;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CompressedNodeSerDesTest);
+
+namespace
+{
+
+// pseudo-random bytes, not compressible
+std::string randomString(std::size_t size, std::uint32_t& state)
+{
+    std::string str;
+
+    for (std::size_t x = 0; x < size; ++x) {
+        state = state * 1103515245 + 12345;
+        str.push_back(static_cast<char>('!' + (state >> 16) % 90));
+    }
+
+    return str;
+}
+
+}
+
+void CompressedNodeSerDesTest::testCodec()
+{
+    std::uint32_t state = 1;
+    std::vector<std::string> inputs {
+        "",
+        "a",
+        "abc",
+        std::string(10000, '\0'),
+        randomString(3000, state),
+    };
+
+    std::string repetitive;
+    for (int x = 0; x < 300; ++x) {
+        repetitive += "Louis " + std::to_string(x % 19);
+    }
+    inputs.push_back(repetitive);
+
+    for (const auto& input : inputs) {
+        auto src = reinterpret_cast<const std::uint8_t*>(input.data());
+        std::vector<std::uint8_t> compressed(input.size() * 2 + 16);
+        auto size = LzCodec::compress(src, input.size(), compressed.data(),
+                                      compressed.size());
+        CPPUNIT_ASSERT(size > 0);
+
+        std::vector<std::uint8_t> output(input.size());
+        CPPUNIT_ASSERT(LzCodec::decompress(compressed.data(), size,
+                                           output.data(), output.size()));
+        CPPUNIT_ASSERT(std::equal(output.begin(), output.end(), src));
+
+        // wrong expected size or truncated input
+        std::vector<std::uint8_t> larger(input.size() + 1);
+        CPPUNIT_ASSERT(!LzCodec::decompress(compressed.data(), size,
+                                            larger.data(), larger.size()));
+
+        if (input.size() > 0) {
+            CPPUNIT_ASSERT(!LzCodec::decompress(compressed.data(), size - 1,
+                                                output.data(), output.size()));
+        }
+    }
+
+    // repetitive data compresses well
+    std::vector<std::uint8_t> compressed(repetitive.size());
+    auto size = LzCodec::compress(
+        reinterpret_cast<const std::uint8_t*>(repetitive.data()),
+        repetitive.size(), compressed.data(), compressed.size());
+    CPPUNIT_ASSERT(size > 0 && size < repetitive.size() / 8);
+
+    // not enough room
+    auto random = randomString(3000, state);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(0), LzCodec::compress(
+        reinterpret_cast<const std::uint8_t*>(random.data()), random.size(),
+        compressed.data(), random.size() - 1));
+}
+
+void CompressedNodeSerDesTest::testSerializeDeserialize()
+{
+    CompressedNodeSerDes serdes;
+
+    // node full of similar string states
+    Node node {4096, 4, 5, Node::ROOT_PARENT_SEQ_NUMBER(), 1000, &serdes};
+    std::vector<AbstractInterval::SP> jar;
+    timestamp_t ts = 1000;
+
+    while (true) {
+        StringInterval::SP interval {
+            new StringInterval {ts, ts + 50, static_cast<interval_key_t>(jar.size() % 7)}
+        };
+        interval->setValue("King Louis " + std::to_string(jar.size() % 18));
+
+        if (!node.intervalFits(*interval)) {
+            break;
+        }
+
+        node.addInterval(interval);
+        jar.push_back(interval);
+        ts += 10;
+    }
+    node.close(ts + 50);
+    node.addChild(1000, 6);
+    node.addChild(2000, 7);
+
+    std::vector<std::uint8_t> buf(4096);
+    serdes.serializeNode(node, buf.data());
+
+    // much smaller once compressed
+    auto size = serdes.getSerializedSize(buf.data(), 4096);
+    CPPUNIT_ASSERT(size < 4096 / 2);
+
+    // only the serialized bytes are needed to deserialize
+    std::vector<std::uint8_t> stored {buf.begin(), buf.begin() + size};
+    auto deserNode = serdes.deserializeNode(stored.data(), 4096, 4);
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(4096), deserNode->getSize());
+    CPPUNIT_ASSERT_EQUAL(static_cast<node_seq_t>(5), deserNode->getSeqNumber());
+    CPPUNIT_ASSERT_EQUAL(node.getEnd(), deserNode->getEnd());
+    CPPUNIT_ASSERT(deserNode->isClosed());
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(2),
+                         deserNode->getChildrenCount());
+    CPPUNIT_ASSERT_EQUAL(static_cast<node_seq_t>(7),
+                         deserNode->getChildren()[1].getSeqNumber());
+
+    auto& intervals = deserNode->getIntervals();
+    CPPUNIT_ASSERT_EQUAL(jar.size(), intervals.size());
+
+    for (std::size_t x = 0; x < jar.size(); ++x) {
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getBegin(), intervals[x]->getBegin());
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getEnd(), intervals[x]->getEnd());
+        CPPUNIT_ASSERT_EQUAL(jar[x]->getKey(), intervals[x]->getKey());
+        CPPUNIT_ASSERT_EQUAL(
+            static_cast<const StringInterval&>(*jar[x]).getValue(),
+            static_cast<const StringInterval&>(*intervals[x]).getValue());
+    }
+}
+
+void CompressedNodeSerDesTest::testIncompressible()
+{
+    CompressedNodeSerDes serdes;
+    std::uint32_t state = 7;
+
+    // node full of random strings: stored as is, still within node size
+    Node node {1024, 2, 0, Node::ROOT_PARENT_SEQ_NUMBER(), 0, &serdes};
+    std::vector<std::string> values;
+    timestamp_t ts = 0;
+
+    while (true) {
+        StringInterval::SP interval {new StringInterval {ts, ts + 1, 1}};
+        interval->setValue(randomString(60, state));
+
+        if (!node.intervalFits(*interval)) {
+            break;
+        }
+
+        node.addInterval(interval);
+        values.push_back(interval->getValue());
+        ts += 2;
+    }
+
+    std::vector<std::uint8_t> buf(1024);
+    serdes.serializeNode(node, buf.data());
+    CPPUNIT_ASSERT(serdes.getSerializedSize(buf.data(), 1024) <= 1024);
+
+    auto deserNode = serdes.deserializeNode(buf.data(), 1024, 2);
+    CPPUNIT_ASSERT_EQUAL(values.size(), deserNode->getIntervalCount());
+
+    for (std::size_t x = 0; x < values.size(); ++x) {
+        const auto& interval = *deserNode->getIntervals()[x];
+        CPPUNIT_ASSERT_EQUAL(values[x],
+                             static_cast<const StringInterval&>(interval).getValue());
+    }
+
+    // corrupted length field
+    buf[0] ^= 0x55;
+    try {
+        serdes.deserializeNode(buf.data(), 1024, 2);
+        CPPUNIT_FAIL("Deserialized a corrupted node");
+    } catch (const std::exception& ex) {
+    }
+}
@@ -0,0 +1,74 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <delorean/node/Crc32c.hpp>
+#include "Crc32cTest.hpp"
+
+using namespace delo;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(Crc32cTest);
+
+void Crc32cTest::testKnownValues()
+{
+    std::string check {"123456789"};
+    auto data = reinterpret_cast<const std::uint8_t*>(check.data());
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint32_t>(0),
+                         Crc32c::compute(data, 0));
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint32_t>(0xe3069283),
+                         Crc32c::compute(data, check.size()));
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint32_t>(0xe3069283),
+                         Crc32c::computeSoftware(data, check.size()));
+
+    // 32 zero bytes (RFC 3720)
+    std::vector<std::uint8_t> zeros(32, 0);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint32_t>(0x8a9136aa),
+                         Crc32c::compute(zeros.data(), zeros.size()));
+
+    // continued checksum
+    auto crc = Crc32c::compute(data, 4);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint32_t>(0xe3069283),
+                         Crc32c::compute(data + 4, check.size() - 4, crc));
+}
+
+void Crc32cTest::testSoftwareMatches()
+{
+    std::vector<std::uint8_t> buf(4099);
+    std::uint32_t state = 7;
+
+    for (auto& byte : buf) {
+        state = state * 1103515245 + 12345;
+        byte = static_cast<std::uint8_t>(state >> 16);
+    }
+
+    // every alignment and tail size
+    for (std::size_t first = 0; first < 9; ++first) {
+        for (std::size_t size = 0; size < 40; ++size) {
+            CPPUNIT_ASSERT_EQUAL(Crc32c::computeSoftware(&buf[first], size),
+                                 Crc32c::compute(&buf[first], size));
+        }
+
+        auto size = buf.size() - first;
+        CPPUNIT_ASSERT_EQUAL(Crc32c::computeSoftware(&buf[first], size),
+                             Crc32c::compute(&buf[first], size));
+    }
+}
@@ -17,6 +17,7 @@
  */
 #include <memory>
 #include <cstddef>
+#include <cstdint>
 #include <stdexcept>
 
 #include <delorean/node/Node.hpp>
@@ -105,3 +106,45 @@ void DirectMappedNodeCacheTest::testGetNode()
     CPPUNIT_ASSERT(!node);
     CPPUNIT_ASSERT(!cache->nodeIsCached(4));
 }
+
+void DirectMappedNodeCacheTest::testStats()
+{
+    std::unique_ptr<AlignedNodeSerDes> serdes {new AlignedNodeSerDes};
+    std::map<node_seq_t, Node::SP> nodes;
+
+    for (node_seq_t seq = 0; seq < 16; ++seq) {
+        nodes[seq] = Node::SP {new Node {1024, 4, seq, 0, 0, serdes.get()}};
+    }
+
+    DirectMappedNodeCache cache {4};
+    cache.setGetNodeFromOwnerCb([&] (node_seq_t seqNumber) -> Node::SP {
+        return nodes[seqNumber];
+    });
+
+    cache.getNode(1);
+    cache.getNode(1);
+    cache.getNode(2);
+
+    // 5 maps to the same entry as 1
+    cache.getNode(5);
+    cache.getNode(1);
+
+    const auto& stats = cache.getStats();
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(1), stats.hits);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(4), stats.misses);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(2), stats.evictions);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(2), stats.collisions);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(2), stats.nodeCount);
+    CPPUNIT_ASSERT_EQUAL(nodes[1]->getMemorySize() + nodes[2]->getMemorySize(),
+                         stats.memorySize);
+    CPPUNIT_ASSERT(stats.decodedBytesLoaded >= 4 * nodes[1]->getMemorySize());
+
+    // reset counters: occupancy stays
+    cache.resetStats();
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(0), stats.misses);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(2), stats.nodeCount);
+
+    cache.invalidate();
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(0), stats.nodeCount);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(0), stats.memorySize);
+}
@@ -26,11 +26,13 @@ class DirectMappedNodeCacheTest :
     CPPUNIT_TEST_SUITE(DirectMappedNodeCacheTest);
         CPPUNIT_TEST(testConstructorAndAttributes);
         CPPUNIT_TEST(testGetNode);
+        CPPUNIT_TEST(testStats);
     CPPUNIT_TEST_SUITE_END();
 
 public:
     void testConstructorAndAttributes();
     void testGetNode();
+    void testStats();
 };
 
 #endif // _DIRECTMAPPEDNODECACHETEST_HPP
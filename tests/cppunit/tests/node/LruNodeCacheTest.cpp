@@ -19,10 +19,16 @@
 #include <memory>
 #include <cstddef>
 #include <stdexcept>
+#include <list>
+#include <map>
+#include <vector>
+#include <random>
+#include <algorithm>
 
 #include <delorean/node/Node.hpp>
 #include <delorean/node/AlignedNodeSerDes.hpp>
 #include <delorean/node/LruNodeCache.hpp>
+#include <delorean/interval/StringInterval.hpp>
 #include <delorean/BasicTypes.hpp>
 #include "LruNodeCacheTest.hpp"
 
@@ -126,3 +132,239 @@ void LruNodeCacheTest::testGetNode()
     getAndCheckNode(cache, 1, nodes);
     checkCached(cache, {false, true, false, false, true, false, false, false, true, true});
 }
+
+void LruNodeCacheTest::testManyNodes()
+{
+    AlignedNodeSerDes serdes;
+    std::map<node_seq_t, Node::SP> nodes;
+
+    for (node_seq_t seq = 0; seq < 1000; ++seq) {
+        nodes[seq] = Node::SP {new Node {1024, 4, seq, 0, 0, &serdes}};
+    }
+
+    // build cache
+    LruNodeCache cache {37};
+    std::size_t ownerCalls = 0;
+    cache.setGetNodeFromOwnerCb([&] (node_seq_t seqNumber) -> Node::SP {
+        ownerCalls++;
+
+        return nodes[seqNumber];
+    });
+
+    // reference LRU model: most recently used first
+    std::list<node_seq_t> model;
+
+    std::mt19937 gen {1234};
+    std::uniform_int_distribution<node_seq_t> smallDist {0, 50};
+    std::uniform_int_distribution<node_seq_t> largeDist {0, 999};
+
+    for (int x = 0; x < 20000; ++x) {
+        // mostly a small working set, sometimes anything
+        auto seq = (x % 5 == 0) ? largeDist(gen) : smallDist(gen);
+        auto it = std::find(model.begin(), model.end(), seq);
+        auto expectedHit = it != model.end();
+        auto prevOwnerCalls = ownerCalls;
+
+        CPPUNIT_ASSERT_EQUAL(expectedHit, cache.nodeIsCached(seq));
+        CPPUNIT_ASSERT_EQUAL(nodes[seq], cache.getNode(seq));
+        CPPUNIT_ASSERT_EQUAL(expectedHit, ownerCalls == prevOwnerCalls);
+
+        if (expectedHit) {
+            model.erase(it);
+        }
+
+        model.push_front(seq);
+
+        if (model.size() > cache.getSize()) {
+            CPPUNIT_ASSERT(!cache.nodeIsCached(model.back()) ||
+                           model.back() == seq);
+            model.pop_back();
+        }
+    }
+
+    // everything in the model is cached
+    for (auto seq : model) {
+        CPPUNIT_ASSERT(cache.nodeIsCached(seq));
+    }
+}
+
+void LruNodeCacheTest::testInvalidate()
+{
+    AlignedNodeSerDes serdes;
+    Node::SP node {new Node {1024, 4, 3, 0, 0, &serdes}};
+
+    LruNodeCache cache {4};
+    cache.setGetNodeFromOwnerCb([&] (node_seq_t seqNumber) -> Node::SP {
+        return seqNumber == 3 ? node : nullptr;
+    });
+
+    CPPUNIT_ASSERT_EQUAL(node, cache.getNode(3));
+    CPPUNIT_ASSERT(cache.nodeIsCached(3));
+    cache.invalidate();
+    CPPUNIT_ASSERT(!cache.nodeIsCached(3));
+    CPPUNIT_ASSERT_EQUAL(node, cache.getNode(3));
+    CPPUNIT_ASSERT(cache.nodeIsCached(3));
+}
+
+void LruNodeCacheTest::testByteBudget()
+{
+    AlignedNodeSerDes serdes;
+    std::vector<Node::SP> nodes;
+
+    // nodes of various memory sizes
+    for (node_seq_t seq = 0; seq < 200; ++seq) {
+        Node::SP node {new Node {4096, 4, seq, 0, 0, &serdes}};
+        StringInterval::SP interval {new StringInterval {0, 1, seq}};
+        interval->setValue(std::string((seq % 7) * 300, 'x'));
+        node->addInterval(interval);
+        nodes.push_back(node);
+    }
+
+    const std::size_t budget = 4 * nodes[6]->getMemorySize();
+    LruNodeCache cache {100, budget};
+    cache.setGetNodeFromOwnerCb([&] (node_seq_t seqNumber) -> Node::SP {
+        return nodes[seqNumber];
+    });
+    CPPUNIT_ASSERT_EQUAL(budget, cache.getByteBudget());
+
+    std::mt19937 gen {99};
+    std::uniform_int_distribution<node_seq_t> dist {0, 199};
+
+    for (int x = 0; x < 5000; ++x) {
+        auto seq = dist(gen);
+        CPPUNIT_ASSERT_EQUAL(nodes[seq], cache.getNode(seq));
+
+        // memory size is the sum of the cached nodes' memory sizes
+        std::size_t memorySize = 0;
+        std::size_t count = 0;
+        for (const auto& node : nodes) {
+            if (cache.nodeIsCached(node->getSeqNumber())) {
+                memorySize += node->getMemorySize();
+                count++;
+            }
+        }
+
+        CPPUNIT_ASSERT_EQUAL(memorySize, cache.getMemorySize());
+        CPPUNIT_ASSERT(cache.getMemorySize() <= budget);
+
+        // at least four nodes fit within the budget
+        if (x > 1000) {
+            CPPUNIT_ASSERT(count >= 4);
+        }
+    }
+
+    // a node larger than the whole budget doesn't evict anything
+    Node::SP hugeNode {new Node {16384, 4, 200, 0, 0, &serdes}};
+    StringInterval::SP hugeInterval {new StringInterval {0, 1, 200}};
+    hugeInterval->setValue(std::string(10000, 'x'));
+    hugeNode->addInterval(hugeInterval);
+    nodes.push_back(hugeNode);
+    CPPUNIT_ASSERT(hugeNode->getMemorySize() > budget);
+
+    std::vector<node_seq_t> cachedSeqs;
+    for (node_seq_t seq = 0; seq < 200; ++seq) {
+        if (cache.nodeIsCached(seq)) {
+            cachedSeqs.push_back(seq);
+        }
+    }
+
+    auto memorySize = cache.getMemorySize();
+    CPPUNIT_ASSERT_EQUAL(hugeNode, cache.getNode(200));
+    CPPUNIT_ASSERT(!cache.nodeIsCached(200));
+    CPPUNIT_ASSERT(!cache.putNode(200, hugeNode));
+    CPPUNIT_ASSERT_EQUAL(memorySize, cache.getMemorySize());
+
+    for (auto seq : cachedSeqs) {
+        CPPUNIT_ASSERT(cache.nodeIsCached(seq));
+    }
+
+    cache.invalidate();
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(0), cache.getMemorySize());
+}
+
+void LruNodeCacheTest::testStats()
+{
+    AlignedNodeSerDes serdes;
+    std::map<node_seq_t, Node::SP> nodes;
+
+    for (node_seq_t seq = 0; seq < 16; ++seq) {
+        nodes[seq] = Node::SP {new Node {1024, 4, seq, 0, 0, &serdes}};
+    }
+
+    LruNodeCache cache {3};
+    cache.setGetNodeFromOwnerCb([&] (node_seq_t seqNumber) -> Node::SP {
+        return nodes[seqNumber];
+    });
+    cache.setLevelStatsEnabled(true);
+
+    // level 0: 1 miss, 2 hits
+    cache.getNode(0, 0);
+    cache.getNode(0, 0);
+    cache.getNode(0, 0);
+
+    // level 1: 4 misses (evicts 0 and 1), no level
+    for (node_seq_t seq = 1; seq < 5; ++seq) {
+        cache.getNode(seq, 1);
+    }
+    cache.getNode(4);
+
+    const auto& stats = cache.getStats();
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(3), stats.hits);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(5), stats.misses);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(2), stats.evictions);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(0), stats.collisions);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(3), stats.nodeCount);
+
+    const auto& levelStats = cache.getLevelStats();
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(2), levelStats.size());
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(2), levelStats[0].hits);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(1), levelStats[0].misses);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(0), levelStats[1].hits);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(4), levelStats[1].misses);
+    CPPUNIT_ASSERT_EQUAL(nodes[0]->getMemorySize(),
+                         static_cast<std::size_t>(
+                             levelStats[0].decodedBytesLoaded));
+}
+
+void LruNodeCacheTest::testPutNode()
+{
+    AlignedNodeSerDes serdes;
+    std::vector<Node::SP> nodes;
+
+    for (node_seq_t seq = 0; seq < 8; ++seq) {
+        nodes.emplace_back(new Node {1024, 4, seq, 0, 0, &serdes});
+    }
+
+    LruNodeCache cache {4};
+    cache.setGetNodeFromOwnerCb([&] (node_seq_t seqNumber) -> Node::SP {
+        return nodes[seqNumber];
+    });
+
+    // put nodes are cached without asking the owner
+    for (node_seq_t seq = 0; seq < 4; ++seq) {
+        CPPUNIT_ASSERT(cache.putNode(seq, nodes[seq]));
+    }
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(4),
+                         cache.getStats().nodeCount);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(0),
+                         cache.getStats().misses);
+    CPPUNIT_ASSERT_EQUAL(nodes[2], cache.getNode(2));
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(0),
+                         cache.getStats().misses);
+
+    // putting a cached node again changes nothing
+    CPPUNIT_ASSERT(cache.putNode(2, nodes[2]));
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(4),
+                         cache.getStats().nodeCount);
+
+    // putting a new node evicts the least recently used one
+    CPPUNIT_ASSERT(cache.putNode(4, nodes[4]));
+    CPPUNIT_ASSERT(!cache.nodeIsCached(0));
+    CPPUNIT_ASSERT(cache.nodeIsCached(2));
+    CPPUNIT_ASSERT(cache.nodeIsCached(4));
+
+    // a cache of size 0 caches nothing
+    LruNodeCache emptyCache {0};
+    CPPUNIT_ASSERT(!emptyCache.putNode(0, nodes[0]));
+}
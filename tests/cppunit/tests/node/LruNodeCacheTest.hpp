@@ -27,11 +27,21 @@ class LruNodeCacheTest :
     CPPUNIT_TEST_SUITE(LruNodeCacheTest);
         CPPUNIT_TEST(testConstructorAndAttributes);
         CPPUNIT_TEST(testGetNode);
+        CPPUNIT_TEST(testManyNodes);
+        CPPUNIT_TEST(testInvalidate);
+        CPPUNIT_TEST(testByteBudget);
+        CPPUNIT_TEST(testStats);
+        CPPUNIT_TEST(testPutNode);
     CPPUNIT_TEST_SUITE_END();
 
 public:
     void testConstructorAndAttributes();
     void testGetNode();
+    void testManyNodes();
+    void testInvalidate();
+    void testByteBudget();
+    void testStats();
+    void testPutNode();
 };
 
 #endif // _LRUNODECACHETEST_HPP
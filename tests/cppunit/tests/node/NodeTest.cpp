@@ -189,6 +189,44 @@ void NodeTest::testIntervalFits()
     CPPUNIT_ASSERT(!node->intervalFits(*interval));
 }
 
+void NodeTest::testExtend()
+{
+    // same small node: 5 intervals fit
+    std::unique_ptr<MyNodeSerDes> serdes {new MyNodeSerDes()};
+    Node::UP node {new Node {
+        32,
+        16,
+        57,
+        Node::ROOT_PARENT_SEQ_NUMBER(),
+        1534,
+        serdes.get()
+    }};
+    Int32Interval::SP interval {new Int32Interval(1602, 2000, 1)};
+
+    for (int x = 0; x < 5; ++x) {
+        node->addInterval(interval);
+    }
+
+    CPPUNIT_ASSERT(!node->isExtended());
+    CPPUNIT_ASSERT(!node->intervalFits(*interval));
+
+    // one extension page: 8 more intervals fit
+    node->extend(64);
+    CPPUNIT_ASSERT(node->isExtended());
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(64), node->getSize());
+
+    for (int x = 0; x < 8; ++x) {
+        CPPUNIT_ASSERT(node->intervalFits(*interval));
+        node->addInterval(interval);
+    }
+
+    CPPUNIT_ASSERT(!node->intervalFits(*interval));
+
+    // never shrinks
+    node->extend(32);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(64), node->getSize());
+}
+
 void NodeTest::testFindOne()
 {
     // build node
@@ -27,6 +27,7 @@ class NodeTest :
         CPPUNIT_TEST(testConstructorAndAttributes);
         CPPUNIT_TEST(testAddInterval);
         CPPUNIT_TEST(testIntervalFits);
+        CPPUNIT_TEST(testExtend);
         CPPUNIT_TEST(testFindOne);
         CPPUNIT_TEST(testFindAll);
         CPPUNIT_TEST(testChildren);
@@ -36,6 +37,7 @@ public:
     void testConstructorAndAttributes();
     void testAddInterval();
     void testIntervalFits();
+    void testExtend();
     void testFindOne();
     void testFindAll();
     void testChildren();
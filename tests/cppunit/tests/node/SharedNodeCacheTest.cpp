@@ -0,0 +1,288 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <random>
+#include <fstream>
+#include <boost/filesystem.hpp>
+
+#include <delorean/node/Node.hpp>
+#include <delorean/node/AlignedNodeSerDes.hpp>
+#include <delorean/node/SharedNodeCache.hpp>
+#include <delorean/interval/StringInterval.hpp>
+#include <delorean/BasicTypes.hpp>
+#include "SharedNodeCacheTest.hpp"
+
+using namespace delo;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SharedNodeCacheTest);
+
+namespace
+{
+
+std::vector<Node::SP> buildNodes(AlignedNodeSerDes& serdes, std::size_t count,
+                                 std::size_t stringSize = 0)
+{
+    std::vector<Node::SP> nodes;
+
+    for (node_seq_t seq = 0; seq < count; ++seq) {
+        Node::SP node {new Node {4096, 4, seq, 0, 0, &serdes}};
+
+        if (stringSize > 0) {
+            StringInterval::SP interval {new StringInterval {0, 1, seq}};
+            interval->setValue(std::string(stringSize, 'x'));
+            node->addInterval(interval);
+        }
+
+        nodes.push_back(node);
+    }
+
+    return nodes;
+}
+
+void setOwner(AbstractNodeCache& view, const std::vector<Node::SP>& nodes)
+{
+    view.setGetNodeFromOwnerCb([&nodes] (node_seq_t seqNumber) -> Node::SP {
+        if (seqNumber >= nodes.size()) {
+            return nullptr;
+        }
+
+        return nodes[seqNumber];
+    });
+}
+
+}
+
+void SharedNodeCacheTest::testViews()
+{
+    AlignedNodeSerDes serdes;
+    auto nodesA = buildNodes(serdes, 10);
+    auto nodesB = buildNodes(serdes, 10);
+
+    SharedNodeCache::SP cache {new SharedNodeCache {100}};
+    auto viewA = cache->createView();
+    auto viewB = cache->createView();
+    setOwner(*viewA, nodesA);
+    setOwner(*viewB, nodesB);
+
+    // same sequence numbers, different owners
+    CPPUNIT_ASSERT_EQUAL(nodesA[3], viewA->getNode(3));
+    CPPUNIT_ASSERT_EQUAL(nodesB[3], viewB->getNode(3));
+    CPPUNIT_ASSERT_EQUAL(nodesA[3], viewA->getNode(3));
+    CPPUNIT_ASSERT(viewA->nodeIsCached(3));
+    CPPUNIT_ASSERT(!viewA->nodeIsCached(4));
+    CPPUNIT_ASSERT(!viewA->getNode(20));
+
+    // per-view and global statistics
+    viewA->addBytesLoaded(100);
+    viewB->addBytesLoaded(20);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(100),
+                         viewA->getStats().bytesLoaded);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(120),
+                         cache->getStats().bytesLoaded);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(1),
+                         viewA->getStats().hits);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(2),
+                         viewA->getStats().misses);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(1),
+                         viewB->getStats().misses);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(2),
+                         cache->getStats().nodeCount);
+
+    // invalidating a view only drops its own nodes
+    viewA->invalidate();
+    CPPUNIT_ASSERT(!viewA->nodeIsCached(3));
+    CPPUNIT_ASSERT(viewB->nodeIsCached(3));
+
+    // so does destroying it
+    viewB = nullptr;
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(0),
+                         cache->getStats().nodeCount);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(0),
+                         cache->getStats().memorySize);
+}
+
+void SharedNodeCacheTest::testFileViews()
+{
+    AlignedNodeSerDes serdes;
+    auto nodesA = buildNodes(serdes, 10);
+    auto nodesB = buildNodes(serdes, 10);
+    std::ofstream {"./shared-a.his"};
+    std::ofstream {"./shared-b.his"};
+
+    SharedNodeCache::SP cache {new SharedNodeCache {100}};
+    auto viewA1 = cache->createView("./shared-a.his");
+    auto viewA2 = cache->createView(boost::filesystem::current_path() /
+                                    "shared-a.his");
+    auto viewB = cache->createView("./shared-b.his");
+    setOwner(*viewA1, nodesA);
+    setOwner(*viewA2, nodesA);
+    setOwner(*viewB, nodesB);
+
+    // same file: a node loaded by one view is a hit for the other
+    CPPUNIT_ASSERT_EQUAL(nodesA[3], viewA1->getNode(3));
+    CPPUNIT_ASSERT(viewA2->nodeIsCached(3));
+    CPPUNIT_ASSERT(!viewB->nodeIsCached(3));
+    CPPUNIT_ASSERT_EQUAL(nodesA[3], viewA2->getNode(3));
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(1),
+                         viewA2->getStats().hits);
+    CPPUNIT_ASSERT_EQUAL(nodesB[3], viewB->getNode(3));
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(2),
+                         cache->getStats().nodeCount);
+
+    // the file's nodes stay cached while it has a view
+    viewA1 = nullptr;
+    CPPUNIT_ASSERT(viewA2->nodeIsCached(3));
+
+    // invalidating a view drops the nodes of its file only
+    viewA2->invalidate();
+    CPPUNIT_ASSERT(!viewA2->nodeIsCached(3));
+    CPPUNIT_ASSERT(viewB->nodeIsCached(3));
+
+    viewA2->getNode(4);
+    viewA2 = nullptr;
+    viewB = nullptr;
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(0),
+                         cache->getStats().nodeCount);
+
+    boost::filesystem::remove("./shared-a.his");
+    boost::filesystem::remove("./shared-b.his");
+}
+
+void SharedNodeCacheTest::testCrossOwnerEviction()
+{
+    AlignedNodeSerDes serdes;
+    auto nodesA = buildNodes(serdes, 100);
+    auto nodesB = buildNodes(serdes, 100);
+
+    SharedNodeCache::SP cache {new SharedNodeCache {10}};
+    auto viewA = cache->createView();
+    auto viewB = cache->createView();
+    setOwner(*viewA, nodesA);
+    setOwner(*viewB, nodesB);
+
+    // A fills the cache
+    for (node_seq_t seq = 0; seq < 10; ++seq) {
+        viewA->getNode(seq);
+    }
+
+    // B is hot: A's least recently used nodes go away
+    for (node_seq_t seq = 0; seq < 8; ++seq) {
+        viewB->getNode(seq);
+    }
+
+    for (node_seq_t seq = 0; seq < 8; ++seq) {
+        CPPUNIT_ASSERT(!viewA->nodeIsCached(seq));
+        CPPUNIT_ASSERT(viewB->nodeIsCached(seq));
+    }
+
+    CPPUNIT_ASSERT(viewA->nodeIsCached(8));
+    CPPUNIT_ASSERT(viewA->nodeIsCached(9));
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(8),
+                         cache->getStats().evictions);
+}
+
+void SharedNodeCacheTest::testByteBudget()
+{
+    AlignedNodeSerDes serdes;
+    auto nodesA = buildNodes(serdes, 50, 2000);
+    auto nodesB = buildNodes(serdes, 50, 100);
+
+    auto budget = 5 * nodesA[0]->getMemorySize();
+    SharedNodeCache::SP cache {new SharedNodeCache {1000, budget}};
+    auto viewA = cache->createView();
+    auto viewB = cache->createView();
+    setOwner(*viewA, nodesA);
+    setOwner(*viewB, nodesB);
+
+    for (node_seq_t seq = 0; seq < 50; ++seq) {
+        viewA->getNode(seq);
+        viewB->getNode(seq);
+
+        auto stats = cache->getStats();
+        CPPUNIT_ASSERT(stats.memorySize <= budget);
+    }
+
+    // a node larger than the whole budget doesn't evict other owners' nodes
+    std::vector<Node::SP> nodesC {Node::SP {new Node {65536, 4, 0, 0, 0, &serdes}}};
+    StringInterval::SP interval {new StringInterval {0, 1, 0}};
+    interval->setValue(std::string(40000, 'x'));
+    nodesC[0]->addInterval(interval);
+    CPPUNIT_ASSERT(nodesC[0]->getMemorySize() > budget);
+
+    auto viewC = cache->createView();
+    setOwner(*viewC, nodesC);
+
+    auto stats = cache->getStats();
+    CPPUNIT_ASSERT(viewB->nodeIsCached(49));
+    CPPUNIT_ASSERT_EQUAL(nodesC[0], viewC->getNode(0));
+    CPPUNIT_ASSERT(!viewC->nodeIsCached(0));
+    CPPUNIT_ASSERT(viewB->nodeIsCached(49));
+    CPPUNIT_ASSERT_EQUAL(stats.nodeCount, cache->getStats().nodeCount);
+    CPPUNIT_ASSERT_EQUAL(stats.memorySize, cache->getStats().memorySize);
+}
+
+void SharedNodeCacheTest::testThreads()
+{
+    AlignedNodeSerDes serdes;
+    const std::size_t threadCount = 4;
+    std::vector<std::vector<Node::SP>> nodes;
+
+    for (std::size_t x = 0; x < threadCount; ++x) {
+        nodes.push_back(buildNodes(serdes, 200));
+    }
+
+    SharedNodeCache::SP cache {new SharedNodeCache {150}};
+    std::vector<std::shared_ptr<AbstractNodeCache>> views;
+
+    for (std::size_t x = 0; x < threadCount; ++x) {
+        views.push_back(cache->createView());
+        setOwner(*views[x], nodes[x]);
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<int> ok(threadCount, 1);
+
+    for (std::size_t x = 0; x < threadCount; ++x) {
+        threads.emplace_back([&, x] () {
+            std::mt19937 gen {static_cast<unsigned int>(x)};
+            std::uniform_int_distribution<node_seq_t> dist {0, 199};
+
+            for (int y = 0; y < 20000; ++y) {
+                auto seq = dist(gen);
+
+                if (views[x]->getNode(seq) != nodes[x][seq]) {
+                    ok[x] = 0;
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (std::size_t x = 0; x < threadCount; ++x) {
+        CPPUNIT_ASSERT(ok[x]);
+    }
+
+    CPPUNIT_ASSERT(cache->getStats().nodeCount <= cache->getSize());
+}
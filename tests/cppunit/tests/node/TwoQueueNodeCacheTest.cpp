@@ -0,0 +1,181 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <memory>
+#include <cstddef>
+#include <vector>
+#include <random>
+
+#include <delorean/node/Node.hpp>
+#include <delorean/node/AlignedNodeSerDes.hpp>
+#include <delorean/node/TwoQueueNodeCache.hpp>
+#include <delorean/interval/StringInterval.hpp>
+#include <delorean/BasicTypes.hpp>
+#include <utils.hpp>
+#include "TwoQueueNodeCacheTest.hpp"
+
+using namespace delo;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TwoQueueNodeCacheTest);
+
+void TwoQueueNodeCacheTest::testConstructorAndAttributes()
+{
+    // test creation
+    TwoQueueNodeCache cache {10};
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(10), cache.getSize());
+}
+
+void TwoQueueNodeCacheTest::testGetNode()
+{
+    TwoQueueNodeCache cache {32};
+    NodeOwner owner {cache};
+
+    std::mt19937 gen {4321};
+    std::uniform_int_distribution<node_seq_t> smallDist {4990, 5020};
+    std::uniform_int_distribution<node_seq_t> largeDist {4000, 6000};
+
+    for (int x = 0; x < 20000; ++x) {
+        auto seq = (x % 3 == 0) ? largeDist(gen) : smallDist(gen);
+        auto wasCached = cache.nodeIsCached(seq);
+        auto calls = owner.getCalls();
+        auto node = cache.getNode(seq);
+
+        // cached nodes don't need the owner
+        CPPUNIT_ASSERT_EQUAL(wasCached, calls == owner.getCalls());
+        CPPUNIT_ASSERT_EQUAL(owner.getNode(seq), node);
+
+        // non existing nodes are never cached
+        if (!node) {
+            CPPUNIT_ASSERT(!cache.nodeIsCached(seq));
+        }
+    }
+
+    // never more cached nodes than the cache size
+    std::size_t cachedCount = 0;
+    for (node_seq_t seq = 4000; seq <= 6000; ++seq) {
+        if (cache.nodeIsCached(seq)) {
+            cachedCount++;
+        }
+    }
+    CPPUNIT_ASSERT(cachedCount <= cache.getSize());
+
+    cache.invalidate();
+    for (node_seq_t seq = 4000; seq <= 6000; ++seq) {
+        CPPUNIT_ASSERT(!cache.nodeIsCached(seq));
+    }
+}
+
+void TwoQueueNodeCacheTest::testScanResistance()
+{
+    TwoQueueNodeCache cache {64};
+    NodeOwner owner {cache};
+
+    /* Hot nodes: accessed once, evicted from A1in by other nodes while
+     * remembered in A1out, and accessed again.
+     */
+    accessNodes(cache, 0, 8);
+    accessNodes(cache, 100, 170);
+    accessNodes(cache, 0, 8);
+    for (node_seq_t seq = 0; seq < 8; ++seq) {
+        CPPUNIT_ASSERT(cache.nodeIsCached(seq));
+    }
+
+    // long scan
+    accessNodes(cache, 1000, 3000);
+
+    // hot nodes are still cached
+    for (node_seq_t seq = 0; seq < 8; ++seq) {
+        CPPUNIT_ASSERT(cache.nodeIsCached(seq));
+    }
+}
+
+void TwoQueueNodeCacheTest::testByteBudget()
+{
+    AlignedNodeSerDes serdes;
+    std::vector<Node::SP> nodes;
+
+    // nodes of various memory sizes
+    for (node_seq_t seq = 0; seq < 200; ++seq) {
+        Node::SP node {new Node {4096, 4, seq, 0, 0, &serdes}};
+        StringInterval::SP interval {new StringInterval {0, 1, seq}};
+        interval->setValue(std::string((seq % 7) * 300, 'x'));
+        node->addInterval(interval);
+        nodes.push_back(node);
+    }
+
+    const std::size_t budget = 4 * nodes[6]->getMemorySize();
+    TwoQueueNodeCache cache {100, budget};
+    cache.setGetNodeFromOwnerCb([&] (node_seq_t seqNumber) -> Node::SP {
+        return nodes[seqNumber];
+    });
+    CPPUNIT_ASSERT_EQUAL(budget, cache.getByteBudget());
+
+    std::mt19937 gen {99};
+    std::uniform_int_distribution<node_seq_t> dist {0, 199};
+
+    for (int x = 0; x < 5000; ++x) {
+        auto seq = dist(gen);
+        CPPUNIT_ASSERT_EQUAL(nodes[seq], cache.getNode(seq));
+
+        // memory size is the sum of the cached nodes' memory sizes
+        std::size_t memorySize = 0;
+        std::size_t count = 0;
+        for (const auto& node : nodes) {
+            if (cache.nodeIsCached(node->getSeqNumber())) {
+                memorySize += node->getMemorySize();
+                count++;
+            }
+        }
+
+        CPPUNIT_ASSERT_EQUAL(memorySize, cache.getMemorySize());
+        CPPUNIT_ASSERT(cache.getMemorySize() <= budget);
+
+        // at least four nodes fit within the budget
+        if (x > 1000) {
+            CPPUNIT_ASSERT(count >= 4);
+        }
+    }
+
+    // a node larger than the whole budget doesn't evict anything
+    Node::SP hugeNode {new Node {16384, 4, 200, 0, 0, &serdes}};
+    StringInterval::SP hugeInterval {new StringInterval {0, 1, 200}};
+    hugeInterval->setValue(std::string(10000, 'x'));
+    hugeNode->addInterval(hugeInterval);
+    nodes.push_back(hugeNode);
+    CPPUNIT_ASSERT(hugeNode->getMemorySize() > budget);
+
+    std::vector<node_seq_t> cachedSeqs;
+    for (node_seq_t seq = 0; seq < 200; ++seq) {
+        if (cache.nodeIsCached(seq)) {
+            cachedSeqs.push_back(seq);
+        }
+    }
+
+    auto memorySize = cache.getMemorySize();
+    CPPUNIT_ASSERT_EQUAL(hugeNode, cache.getNode(200));
+    CPPUNIT_ASSERT(!cache.nodeIsCached(200));
+    CPPUNIT_ASSERT(!cache.putNode(200, hugeNode));
+    CPPUNIT_ASSERT_EQUAL(memorySize, cache.getMemorySize());
+
+    for (auto seq : cachedSeqs) {
+        CPPUNIT_ASSERT(cache.nodeIsCached(seq));
+    }
+
+    cache.invalidate();
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(0), cache.getMemorySize());
+}
@@ -0,0 +1,240 @@
+/* Copyright (c) 2014 Philippe Proulx <eepp.ca>
+ *
+ * This file is part of libdelorean.
+ *
+ * libdelorean is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libdelorean is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <delorean/node/Node.hpp>
+#include <delorean/node/AlignedNodeSerDes.hpp>
+#include <delorean/node/TwoTierNodeCache.hpp>
+#include <delorean/interval/StringInterval.hpp>
+#include <delorean/BasicTypes.hpp>
+#include "TwoTierNodeCacheTest.hpp"
+
+using namespace delo;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TwoTierNodeCacheTest);
+
+namespace
+{
+
+class NodeOwner
+{
+public:
+    NodeOwner(TwoTierNodeCache& cache, std::size_t nodeCount) :
+        _calls {0}
+    {
+        // closed nodes with a few string intervals each
+        for (node_seq_t seq = 0; seq < nodeCount; ++seq) {
+            Node::SP node {new Node {4096, 4, seq, 0, seq * 10, &_serdes}};
+
+            for (interval_key_t key = 0; key < 3; ++key) {
+                StringInterval::SP interval {
+                    new StringInterval {seq * 10, seq * 10 + 5 + static_cast<timestamp_t>(key), key}
+                };
+                interval->setValue(std::string(seq % 5 + key, 'a' + key));
+                node->addInterval(interval);
+            }
+
+            node->close(seq * 10 + 10);
+            _nodes.push_back(node);
+        }
+
+        cache.setGetNodeFromOwnerCb([this] (node_seq_t seqNumber) -> Node::SP {
+            _calls++;
+
+            if (seqNumber >= _nodes.size()) {
+                return nullptr;
+            }
+
+            return _nodes[seqNumber];
+        });
+    }
+
+    const Node& getNode(node_seq_t seqNumber) const
+    {
+        return *_nodes[seqNumber];
+    }
+
+    std::size_t getCalls() const
+    {
+        return _calls;
+    }
+
+private:
+    AlignedNodeSerDes _serdes;
+    std::vector<Node::SP> _nodes;
+    std::size_t _calls;
+};
+
+void checkNode(const Node& expected, const Node& node)
+{
+    CPPUNIT_ASSERT_EQUAL(expected.getSeqNumber(), node.getSeqNumber());
+    CPPUNIT_ASSERT_EQUAL(expected.getBegin(), node.getBegin());
+    CPPUNIT_ASSERT_EQUAL(expected.getEnd(), node.getEnd());
+
+    const auto& expectedIntervals = expected.getIntervals();
+    const auto& intervals = node.getIntervals();
+    CPPUNIT_ASSERT_EQUAL(expectedIntervals.size(), intervals.size());
+
+    for (std::size_t x = 0; x < intervals.size(); ++x) {
+        auto& expectedInterval =
+            static_cast<const StringInterval&>(*expectedIntervals[x]);
+        auto& interval = static_cast<const StringInterval&>(*intervals[x]);
+
+        CPPUNIT_ASSERT_EQUAL(expectedInterval.getEnd(), interval.getEnd());
+        CPPUNIT_ASSERT_EQUAL(expectedInterval.getKey(), interval.getKey());
+        CPPUNIT_ASSERT(expectedInterval.getValue() == interval.getValue());
+    }
+}
+
+}
+
+void TwoTierNodeCacheTest::testConstructorAndAttributes()
+{
+    TwoTierNodeCache cache {8, 1 << 20, 1 << 16};
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(8), cache.getSize());
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(1 << 20),
+                         cache.getRawByteBudget());
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(1 << 16),
+                         cache.getByteBudget());
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(0),
+                         cache.getRawMemorySize());
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(0),
+                         cache.getRawNodeCount());
+}
+
+void TwoTierNodeCacheTest::testPromotion()
+{
+    TwoTierNodeCache cache {4, 1 << 20};
+    NodeOwner owner {cache, 64};
+
+    for (node_seq_t seq = 0; seq < 64; ++seq) {
+        checkNode(owner.getNode(seq), *cache.getNode(seq));
+    }
+
+    // evicted nodes are demoted, compacted, to the raw tier
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(64), owner.getCalls());
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(4),
+                         cache.getStats().nodeCount);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(60),
+                         cache.getRawNodeCount());
+    CPPUNIT_ASSERT(cache.getRawMemorySize() < 60 * 4096 / 4);
+
+    for (node_seq_t seq = 0; seq < 64; ++seq) {
+        CPPUNIT_ASSERT(cache.nodeIsCached(seq));
+    }
+
+    // getting them again: promotions, no owner calls
+    for (node_seq_t seq = 0; seq < 64; ++seq) {
+        checkNode(owner.getNode(seq), *cache.getNode(seq));
+    }
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(64), owner.getCalls());
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(64),
+                         cache.getPromotionCount());
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(64),
+                         cache.getStats().misses);
+
+    // without compaction, images take the whole node size
+    TwoTierNodeCache fullCache {1, 1 << 20};
+    fullCache.setRawCompactionEnabled(false);
+    NodeOwner fullOwner {fullCache, 2};
+    fullCache.getNode(0);
+    fullCache.getNode(1);
+    CPPUNIT_ASSERT(fullCache.getRawMemorySize() >= 4096);
+    checkNode(fullOwner.getNode(0), *fullCache.getNode(0));
+
+    cache.invalidate();
+    CPPUNIT_ASSERT(!cache.nodeIsCached(0));
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(0),
+                         cache.getRawMemorySize());
+}
+
+void TwoTierNodeCacheTest::testRawByteBudget()
+{
+    const std::size_t rawByteBudget = 2000;
+    TwoTierNodeCache cache {2, rawByteBudget};
+    NodeOwner owner {cache, 100};
+
+    for (node_seq_t seq = 0; seq < 100; ++seq) {
+        cache.getNode(seq);
+        CPPUNIT_ASSERT(cache.getRawMemorySize() <= rawByteBudget);
+    }
+
+    // the most recently demoted images are kept
+    CPPUNIT_ASSERT(cache.getRawNodeCount() > 0);
+    CPPUNIT_ASSERT(cache.nodeIsCached(97));
+    CPPUNIT_ASSERT(!cache.nodeIsCached(0));
+
+    // no raw tier
+    TwoTierNodeCache noRawCache {2, 0};
+    NodeOwner noRawOwner {noRawCache, 4};
+
+    for (node_seq_t seq = 0; seq < 4; ++seq) {
+        noRawCache.getNode(seq);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(0),
+                         noRawCache.getRawNodeCount());
+    CPPUNIT_ASSERT(!noRawCache.nodeIsCached(0));
+}
+
+void TwoTierNodeCacheTest::testDecodedByteBudget()
+{
+    TwoTierNodeCache probeCache {1, 0};
+    NodeOwner probeOwner {probeCache, 5};
+    auto budget = 4 * probeOwner.getNode(4).getMemorySize();
+
+    TwoTierNodeCache cache {8, 1 << 20, budget};
+    NodeOwner owner {cache, 3};
+
+    for (node_seq_t seq = 0; seq < 3; ++seq) {
+        cache.getNode(seq);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(3),
+                         cache.getStats().nodeCount);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(0),
+                         cache.getRawNodeCount());
+
+    // a node larger than the whole decoded budget: only its image is kept
+    AlignedNodeSerDes serdes;
+    Node::SP hugeNode {new Node {65536, 4, 3, 0, 30, &serdes}};
+    StringInterval::SP interval {new StringInterval {30, 35, 0}};
+    interval->setValue(std::string(40000, 'x'));
+    hugeNode->addInterval(interval);
+    CPPUNIT_ASSERT(hugeNode->getMemorySize() > budget);
+
+    CPPUNIT_ASSERT(cache.putNode(3, hugeNode));
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(3),
+                         cache.getStats().nodeCount);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(0),
+                         cache.getStats().evictions);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(1),
+                         cache.getRawNodeCount());
+
+    for (node_seq_t seq = 0; seq < 3; ++seq) {
+        checkNode(owner.getNode(seq), *cache.getNode(seq));
+    }
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(3), owner.getCalls());
+}
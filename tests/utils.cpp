@@ -23,9 +23,11 @@
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/algorithm/string/classification.hpp>
 
+#include <delorean/HistoryFileSink.hpp>
 #include <delorean/interval/IntervalJar.hpp>
 #include <delorean/interval/StringInterval.hpp>
 #include <delorean/BasicTypes.hpp>
+#include "utils.hpp"
 
 namespace bfs = boost::filesystem;
 namespace balgo = boost::algorithm;
@@ -69,7 +71,7 @@ void getIntervalsFromTextFile(const bfs::path& path,
         // read range and key
         delo::timestamp_t begin = static_cast<delo::timestamp_t>(std::stoll(parts[0]));
         delo::timestamp_t end = static_cast<delo::timestamp_t>(std::stoll(parts[1]));
-        delo::interval_key_t key = static_cast<delo::interval_key_t>(std::stoul(parts[2]));
+        delo::interval_key_t key = static_cast<delo::interval_key_t>(std::stoull(parts[2]));
 
         // read string value
         std::string value;
@@ -95,3 +97,65 @@ void getIntervalsFromTextFile(const bfs::path& path,
     // close file now
     file.close();
 }
+
+void buildHistoryFromTextFile(const bfs::path& textPath,
+                              const bfs::path& historyPath,
+                              std::size_t nodeSize, std::size_t maxChildren,
+                              delo::timestamp_t begin,
+                              std::vector<delo::AbstractInterval::SP>& intervals,
+                              delo::NodeSerDesType serdesType)
+{
+    // read intervals
+    std::vector<delo::AbstractInterval::UP> intervalsUp;
+    getIntervalsFromTextFile(textPath, intervalsUp);
+
+    // create history file sink and add intervals
+    delo::HistoryFileSink sink;
+    sink.open(historyPath, nodeSize, maxChildren, begin, serdesType);
+    for (auto& intervalUp : intervalsUp) {
+        delo::AbstractInterval::SP interval {std::move(intervalUp)};
+        sink.addInterval(interval);
+        intervals.push_back(interval);
+    }
+    sink.close();
+}
+
+NodeOwner::NodeOwner(delo::AbstractNodeCache& cache) :
+    _calls {0}
+{
+    cache.setGetNodeFromOwnerCb([this] (delo::node_seq_t seqNumber) -> delo::Node::SP {
+        _calls++;
+
+        // odd sequence numbers above 5000 don't exist
+        if (seqNumber > 5000 && seqNumber % 2 == 1) {
+            return nullptr;
+        }
+
+        auto& node = _nodes[seqNumber];
+
+        if (!node) {
+            node.reset(new delo::Node {1024, 4, seqNumber, 0, 0, &_serdes});
+        }
+
+        return node;
+    });
+}
+
+delo::Node::SP NodeOwner::getNode(delo::node_seq_t seqNumber)
+{
+    auto it = _nodes.find(seqNumber);
+
+    if (it == _nodes.end()) {
+        return nullptr;
+    }
+
+    return it->second;
+}
+
+void accessNodes(delo::AbstractNodeCache& cache, delo::node_seq_t begin,
+                 delo::node_seq_t end)
+{
+    for (auto seq = begin; seq < end; ++seq) {
+        cache.getNode(seq);
+    }
+}
@@ -16,9 +16,16 @@
  * along with libdelorean.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <vector>
+#include <map>
+#include <cstddef>
 #include <boost/filesystem.hpp>
 
 #include <delorean/interval/AbstractInterval.hpp>
+#include <delorean/node/Node.hpp>
+#include <delorean/node/AlignedNodeSerDes.hpp>
+#include <delorean/node/AbstractNodeCache.hpp>
+#include <delorean/node/NodeSerDesType.hpp>
+#include <delorean/BasicTypes.hpp>
 
 /**
  * Appends intervals found in text file \p path to jar \p jar.
@@ -28,3 +35,74 @@
  */
 void getIntervalsFromTextFile(const boost::filesystem::path& path,
                               std::vector<delo::AbstractInterval::UP>& intervals);
+
+/**
+ * Builds history file \p historyPath out of the intervals found in text
+ * file \p textPath, and appends those intervals to \p intervals.
+ *
+ * @param textPath    Text file path
+ * @param historyPath History file path
+ * @param nodeSize    Node size of history file
+ * @param maxChildren Maximum number of children of history file nodes
+ * @param begin       Begin timestamp of history file
+ * @param intervals   Vector of intervals to fill
+ * @param serdesType  Type of node serializer/deserializer to use
+ */
+void buildHistoryFromTextFile(const boost::filesystem::path& textPath,
+                              const boost::filesystem::path& historyPath,
+                              std::size_t nodeSize, std::size_t maxChildren,
+                              delo::timestamp_t begin,
+                              std::vector<delo::AbstractInterval::SP>& intervals,
+                              delo::NodeSerDesType serdesType = delo::NodeSerDesType::ALIGNED);
+
+/**
+ * Fake owner of the nodes of a node cache, creating empty nodes on
+ * demand and counting the requests of the cache.
+ *
+ * Odd sequence numbers above 5000 don't exist.
+ */
+class NodeOwner
+{
+public:
+    /**
+     * Builds a node owner and registers it to node cache \p cache.
+     *
+     * @param cache Node cache to serve
+     */
+    NodeOwner(delo::AbstractNodeCache& cache);
+
+    /**
+     * Returns the node having sequence number \p seqNumber if it was
+     * already requested by the cache.
+     *
+     * @param seqNumber Sequence number of node to get
+     * @returns         Node, or \a nullptr if not requested yet
+     */
+    delo::Node::SP getNode(delo::node_seq_t seqNumber);
+
+    /**
+     * Returns the number of requests of the cache so far.
+     *
+     * @returns Number of requests
+     */
+    std::size_t getCalls() const
+    {
+        return _calls;
+    }
+
+private:
+    delo::AlignedNodeSerDes _serdes;
+    std::map<delo::node_seq_t, delo::Node::SP> _nodes;
+    std::size_t _calls;
+};
+
+/**
+ * Gets the nodes from \p begin to \p end (excluded) from node cache
+ * \p cache, in this order.
+ *
+ * @param cache Node cache
+ * @param begin First sequence number
+ * @param end   Sequence number following the last one
+ */
+void accessNodes(delo::AbstractNodeCache& cache, delo::node_seq_t begin,
+                 delo::node_seq_t end);